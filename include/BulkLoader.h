@@ -0,0 +1,72 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "IndexWriter.h"
+#include "StorageEngine.h"
+#include "gqlite.h"
+
+/**
+ * Count of rows that are written in a transaction of bulk loading.
+ */
+#define BULK_COMMIT_ROWS      65536
+/**
+ * Count of rows that are indexed in a step when bulk loading is finished.
+ */
+#define BULK_INDEX_BATCH      (16 * INDEX_BUILD_BATCH)
+
+/**
+ * @brief GBulkLoader writes typed rows of a group without parsing gql.
+ *        Indexes of group are marked as building when loading starts, so rows are written without postings.
+ *        When loading ends, indexes are built by scanning group in key order,
+ *        which merges postings of many rows in one write.
+ *        Like other writes, it should be used in the thread that opens database.
+ */
+class GBulkLoader {
+public:
+  GBulkLoader(GStorageEngine* store, const std::string& group);
+  ~GBulkLoader();
+
+  /**
+   * @return ECode_Group_Not_Exist if group is not created.
+   */
+  int begin();
+  /**
+   * @return ECode_GQL_Type_Not_Match if type of key is not the type of group, or group is an edge group.
+   */
+  int addVertex(const gkey_t& key, const nlohmann::json& row);
+  /**
+   * @param direction if true, edge is from `from` to `to`.
+   */
+  int addEdge(const gkey_t& from, const gkey_t& to, bool direction, const nlohmann::json& row);
+  /**
+   * @param key id of edge that is made by `gql::make_edge_id`
+   */
+  int addEdge(const std::string& key, const nlohmann::json& row);
+  /**
+   * @brief build indexes and commit.
+   */
+  int end();
+
+  /**
+   * @brief convert typed fields to a row.
+   */
+  static nlohmann::json toRow(const gqlite_field* fields, uint32_t count);
+
+private:
+  int commit();
+
+private:
+  GStorageEngine* _store;
+  std::string _group;
+  GIndexWriter _writer;
+  /**
+   * indexes that are built when loading ends.
+   */
+  std::vector<std::string> _indexes;
+  /**
+   * group has no row before loading, so rows are not read before they are written.
+   */
+  bool _empty;
+  size_t _rows;
+  bool _started;
+};
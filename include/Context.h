@@ -16,4 +16,8 @@ struct GContext {
   GDefaultSchedule* _schedule;
   GStorageEngine* _storage;
   GVirtualNetwork* _graph;
+  /**< results of query refer to stored values instead of copies of them. */
+  bool _zeroCopy = false;
+  /**< results of query are returned as pages of columns. */
+  bool _columnar = false;
 };
\ No newline at end of file
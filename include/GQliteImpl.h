@@ -1,6 +1,8 @@
 #pragma once
+#include <string>
 #include "VirtualEngine.h"
 #include "gqlite.h"
+#include "base/LRUCache.h"
 
 enum gqlite_storage_schema {
   gqlite_disk,
@@ -13,6 +15,7 @@ typedef struct _gqlite_open_mode {
 
 class GQueryEngine;
 class GStorageEngine;
+class GStatement;
 
 class GQLiteImpl {
 public:
@@ -23,6 +26,17 @@ public:
 
   void exec(GVirtualEngine& stm);
 
+  /**
+   * @brief parse gql to a statement.
+   * @param cached if true, a prepared statement of same gql is reused without parsing,
+   *        and statement is returned to cache when it is finalized.
+   */
+  int prepare(const char* gql, bool cached, GStatement*& statement);
+  /**
+   * @brief release a statement, or keep it in cache if it is prepared.
+   */
+  void finalize(GStatement* statement);
+
   int close();
   
   GVirtualEngine* engine() { return _ve; }
@@ -31,4 +45,8 @@ private:
 
 private:
   GVirtualEngine* _ve = nullptr;
+  /**
+   * idle prepared statements. Key is normalized gql.
+   */
+  GLRUCache<std::string, GStatement*> _statements;
 };
\ No newline at end of file
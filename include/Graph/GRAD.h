@@ -7,6 +7,7 @@
 
 struct EntityNode;
 struct AttributeNode;
+struct GListNode;
 
 struct EntityEdge {
   EntityNode* _start;
@@ -32,6 +33,10 @@ struct EntityNode {
   EntityEdge* _edges;
   size_t _esize;        /**< size of edges */
   std::vector<attr_node_t> _attrs;
+  /**
+   * conditions of vertex's attributes if endpoint of edge is a filter, such as `[{genres: 'Horror'}, --, *]`
+   */
+  GListNode* _condition = nullptr;
 };
 
 struct AttributeNode {
@@ -44,6 +49,25 @@ enum class LogicalPredicate {
   Max
 };
 
+enum class CompareOperator {
+  Equal,
+  LessThan,
+  LessEqual,
+  GreatThan,
+  GreatEqual,
+  Other,      /**< such as `near` or `*`, it can't be used to seek index */
+};
+
+/**
+ * @brief A simple comparation of attribute, such as `{year: {gte: 2000}}`.
+ *        It is used to choose an index and its scan range.
+ */
+struct AttributeCondition {
+  attr_node_t _attr;
+  CompareOperator _op;
+  attribute_t _value;
+};
+
 /**
  * @brief Describe the graph match pattern.
  *        It come from query condition. For example, if query some vertexes by attributes,
@@ -63,6 +87,17 @@ struct GraphPattern {
    * So they have same size.
    */
   std::vector<predicate_t> _node_predicates;
+
+  /**
+   * Conditions of attribute predicates with same order of them.
+   * Predicate of key such as `id` has no condition.
+   */
+  std::vector<AttributeCondition> _node_conditions;
+
+  /**
+   * Values of key predicates such as `{id: 'v1'}` with same order of them.
+   */
+  std::vector<std::string> _key_values;
 };
 
 struct QueryCondition {
@@ -0,0 +1,98 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "StorageEngine.h"
+
+/**
+ * Size of text that is parsed by a thread in a round of import.
+ */
+#define IMPORT_CHUNK_SIZE   (4 * 1024 * 1024)
+
+class GBulkLoader;
+
+/**
+ * @brief GImporter loads a CSV or NGQL file into a group.
+ *        File is mapped into memory and every round splits it into chunks of lines, which are parsed in parallel.
+ *        Rows of a chunk are sorted by key, then chunks are merged and written by one writer with bulk loading,
+ *        so that rows are written in key order and indexes are built once at the end.
+ *        CSV: columns are named by mapping, or by header line if mapping is empty. Column `id` is id of vertex,
+ *             `from` and `to` are ids of a directed edge, and a column without name is skipped.
+ *             If none of them is named, the first column is renamed to id. A quoted value can't contain line break.
+ *        NGQL: `insert vertex` and `insert edge` statements of group are imported, and other lines are skipped.
+ */
+class GImporter {
+public:
+  GImporter(GStorageEngine* store, const std::string& group, const std::vector<std::string>& mapping = {});
+
+  /**
+   * @brief file whose extension is `.ngql` is parsed as NGQL, others are parsed as CSV.
+   * @return ECode_DISK_OPEN_FAIL if file can't be opened.
+   */
+  int load(const std::string& path);
+
+  /**
+   * @brief size of text that is parsed by a thread in a round. It is IMPORT_CHUNK_SIZE by default.
+   */
+  void setChunkSize(size_t size) { _chunkSize = size ? size : 1; }
+
+  /**
+   * @brief count of imported rows.
+   */
+  size_t rows() const { return _rows; }
+  /**
+   * @brief count of lines that can't be parsed, or whose key is not the type of group.
+   */
+  size_t skipped() const { return _skipped; }
+
+private:
+  struct Row {
+    uint64_t _uid = 0;
+    std::string _key;
+    nlohmann::json _value;
+  };
+  using Chunk = std::vector<Row>;
+
+  enum class Format {
+    CSV,
+    NGQL,
+  };
+
+  /**
+   * @brief name columns of CSV.
+   */
+  void initColumns();
+  /**
+   * @brief parse lines to rows, and sort them by key.
+   */
+  void parse(const char* begin, const char* end, Chunk& chunk, size_t& skipped) const;
+  bool parseLine(const char* begin, const char* end, Row& row) const;
+  bool parseCSV(const char* begin, const char* end, Row& row) const;
+  bool parseNGQL(const char* begin, const char* end, Row& row) const;
+  bool setVertex(const std::string& id, Row& row) const;
+  void setEdge(const std::string& from, const std::string& to, const std::string& direction, Row& row) const;
+  bool less(const Row& left, const Row& right) const;
+  /**
+   * @brief merge sorted chunks and write them in key order.
+   */
+  int write(GBulkLoader& loader, std::vector<Chunk>& chunks);
+
+private:
+  GStorageEngine* _store;
+  std::string _group;
+  std::vector<std::string> _mapping;
+  Format _format;
+  bool _edge;
+  /**
+   * ids of vertexes are integers
+   */
+  bool _integer;
+  /**
+   * index of columns in CSV
+   */
+  int _id;
+  int _from;
+  int _to;
+  size_t _chunkSize;
+  size_t _rows;
+  size_t _skipped;
+};
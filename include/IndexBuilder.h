@@ -0,0 +1,38 @@
+#pragma once
+#include <string>
+#include "IndexWriter.h"
+#include "StorageEngine.h"
+
+#define INDEX_BUILD_BATCH   1024
+
+/**
+ * @brief GIndexBuilder builds an index of exist rows step by step.
+ *        Every step scans at most a batch of rows in key order from the high-water mark,
+ *        then commits. Rows written during building are recorded in side log of index,
+ *        and they are merged when scan is finished. After that index is ready for query.
+ */
+class GIndexBuilder {
+public:
+  GIndexBuilder(GStorageEngine* store, const std::string& index);
+
+  /**
+   * @brief mark index as building. If group is empty, index is ready immediately.
+   */
+  static void start(GStorageEngine* store, const std::string& index);
+
+  /**
+   * @brief index at most `batch` rows.
+   * @return true if index is ready
+   */
+  bool step(size_t batch = INDEX_BUILD_BATCH);
+
+private:
+  void mergeLog();
+  gkey_t toKey(KeyType type, const std::string& key) const;
+
+private:
+  GStorageEngine* _store;
+  std::string _index;
+  std::string _group;
+  GIndexWriter _writer;
+};
@@ -0,0 +1,94 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include "json.hpp"
+#include "Graph/GRAD.h"
+#include "StorageEngine.h"
+
+/**
+ * @brief GIndexWriter maintains word/number indexes, covering entries and time buckets of a group.
+ *        Vector index is not written here because it need a HNSW network.
+ */
+class GIndexWriter {
+public:
+  GIndexWriter(GStorageEngine* store, const std::string& group);
+
+  /**
+   * @brief write all indexes of group with the row's attributes.
+   */
+  int upset(const gkey_t& key, const nlohmann::json& row);
+  /**
+   * @brief write one index with the row's attributes.
+   */
+  int upset(const std::string& index, const gkey_t& key, const nlohmann::json& row);
+
+  /**
+   * @brief update indexes of group from old row to new row.
+   *        Only the postings of changed values are removed or inserted.
+   */
+  int update(const gkey_t& key, const nlohmann::json& oldRow, const nlohmann::json& newRow);
+
+  /**
+   * @brief remove postings of the row from all indexes of group.
+   */
+  int remove(const gkey_t& key, const nlohmann::json& row);
+
+  /**
+   * @brief compare index with group's rows.
+   * @param missing count of postings that should be in index but not
+   * @param stale count of postings that are in index but row's value is not
+   */
+  int verify(const std::string& index, size_t& missing, size_t& stale);
+
+  /**
+   * @brief postings are merged in memory until `flush`, so that every posting is written once in a batch.
+   */
+  void beginBatch();
+  void flush();
+
+  const std::vector<std::string>& indexes() const { return _indexes; }
+  /**
+   * @brief stop maintaining an index, such as a bucket index whose entries are expired as a range.
+   */
+  void exclude(const std::string& index);
+
+  /**
+   * @brief get attribute name of index `group:attr`
+   */
+  std::string attribute(const std::string& index) const;
+
+private:
+  /**
+   * An indexed value of row. Array attribute has many values.
+   */
+  struct IndexValue {
+    std::string _posting;   /**< key of posting */
+    std::string _cover;     /**< encoded value of covering entry */
+    bool _number;
+
+    bool operator < (const IndexValue& other) const { return _posting < other._posting; }
+  };
+  std::vector<IndexValue> values(const std::string& index, const nlohmann::json& row) const;
+
+  bool upsetPosting(const std::string& index, const IndexValue& value, const gkey_t& key);
+  bool mergePosting(const std::string& index, const std::string& value, const std::vector<gkey_t>& keys);
+  bool removePosting(const std::string& index, const std::string& value, const gkey_t& key);
+  void upsetCovering(const std::string& index, const std::string& value, const gkey_t& key, const nlohmann::json& row);
+  bool toBucket(const std::string& index, const IndexValue& value, uint64_t& time, uint64_t& bucket) const;
+  void upsetBucket(const std::string& index, const IndexValue& value, const gkey_t& key);
+  void removeBucket(const std::string& index, const IndexValue& value, const gkey_t& key);
+  int verifyBucket(const std::string& index, size_t& missing, size_t& stale);
+  void logRow(const std::string& index, const gkey_t& key);
+
+private:
+  GStorageEngine* _store;
+  std::string _group;
+  std::vector<std::string> _indexes;
+
+  bool _batch;
+  /**
+   * postings of batch: index -> value -> row keys
+   */
+  std::map<std::string, std::map<std::string, std::vector<gkey_t>>> _postings;
+};
@@ -0,0 +1,63 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "StorageEngine.h"
+
+#define SNAPSHOT_MAGIC        "GQLSNAP"
+#define SNAPSHOT_VERSION      1
+/**
+ * Bytes of rows in a block of snapshot. Every block has its checksum.
+ */
+#define SNAPSHOT_BLOCK_SIZE   (1024 * 1024)
+
+/**
+ * @brief GSnapshot dumps a graph to a binary file, and restores a graph from it.
+ *        File is a header with schema, then a section for every group and index map.
+ *        A section is blocks of raw entries in key order, which is ended by an empty block:
+ *          header:  magic(8) | version(u32) | schema length(u32) | schema(cbor) | crc(u32) | count of sections(u32)
+ *          section: flags of map(u32) | name length(u16) | name | block ... | 0(u32) | crc of section header(u32)
+ *          block:   count of rows(u32) | bytes(u32) | [key length(u32) | key | value length(u32) | value] ... | crc(u32)
+ *        Numbers are in native byte order, like ordinal keys of maps. Maps are restored with their flags in section.
+ *        Sections are dumped by worker threads, each of them scans with its own read transaction.
+ *        Posting lists of indexes are dumped as entries, so they are restored without building.
+ */
+class GSnapshot {
+public:
+  GSnapshot(GStorageEngine* store);
+
+  /**
+   * @brief dump last committed data. Current transaction is committed first,
+   *        and it should be called in the thread that opens database.
+   * @return ECode_DISK_WRITE_FAIL if file can't be written.
+   */
+  int dump(const std::string& path);
+  /**
+   * @brief replace all groups and indexes of graph by snapshot. Entries are appended in key order.
+   *        All blocks are verified before graph is changed.
+   * @return ECode_DISK_Checksum_Fail if snapshot is broken.
+   */
+  int restore(const std::string& path);
+
+  /**
+   * @brief count of dumped or restored entries.
+   */
+  size_t rows() const { return _rows; }
+
+private:
+  /**
+   * @brief names of maps of groups and indexes in schema.
+   */
+  std::vector<std::string> sections(const nlohmann::json& schema) const;
+  /**
+   * @brief write a section to its own file. Flags are read from the map.
+   */
+  int dumpSection(const std::string& mapname, const std::string& path, size_t& rows) const;
+  /**
+   * @brief read sections after header. If `apply` is false, blocks are only verified.
+   */
+  int loadSections(const char* begin, const char* end, bool apply);
+
+private:
+  GStorageEngine* _store;
+  size_t _rows;
+};
@@ -0,0 +1,149 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+#include "gqlite.h"
+
+/**
+ * Count of results that a statement buffers before its plans are suspended.
+ */
+#define STATEMENT_PREFETCH_SIZE   64
+/**
+ * Count of idle prepared statements that are cached by a database.
+ */
+#define STATEMENT_CACHE_SIZE      64
+
+struct GListNode;
+class GLiteral;
+class GVirtualEngine;
+class GDefaultSchedule;
+class GCoroutine;
+
+/**
+ * @brief A statement is parsed once, and executed later.
+ *        Plans of statement run in a coroutine that is suspended when `prefetch` results are buffered,
+ *        so that results are pulled by `next` and a finalized statement stops scanning.
+ */
+class GStatement {
+public:
+  GStatement(GVirtualEngine* engine);
+  ~GStatement();
+
+  /**
+   * @brief keep an AST that is parsed from gql. Statement frees it.
+   */
+  void keep(GListNode* ast);
+  /**
+   * @brief keep placeholder of parameter `$index`. A parameter can be used many times.
+   */
+  void addParameter(int index, GListNode* node);
+
+  /**
+   * @brief bind a value to parameter `$index`. A running statement is stopped first,
+   *        and bound values are kept until they are bound again.
+   * @return ECode_GQL_Parameter_Not_Exist if statement has no such parameter.
+   */
+  int bind(int index, int64_t value);
+  int bind(int index, double value);
+  int bind(int index, const char* text, size_t len);
+
+  /**
+   * @brief start plans of statement. Plans run until the first results are buffered,
+   *        so that a statement without result is finished here.
+   */
+  int execute();
+  /**
+   * @param result it is valid until next call of statement
+   * @return ECode_Success if a result is returned, ECode_Query_Stop if all results are returned,
+   *         or error of plans.
+   */
+  int next(gqlite_result** result);
+  /**
+   * @brief stop running plans and release results.
+   */
+  void finalize();
+
+  void setPrefetch(size_t count) { _prefetch = count ? count : 1; }
+  /**
+   * @brief In zero-copy mode, properties of results refer to stored values, and they are not ended with '\0'.
+   *        A result is valid until next result is pulled, and writes are rejected until then.
+   */
+  void setZeroCopy(bool enable) { _zeroCopy = enable; }
+  /**
+   * @brief results are pages of columns, and a page is valid until next result is pulled.
+   */
+  void setColumnar(bool enable) { _columnar = enable; }
+
+  /**
+   * @brief a deep copy of result, which is released by `releaseResult`. Pages of columns can't be copied.
+   */
+  static gqlite_result* copyResult(const gqlite_result* result);
+  static void releaseResult(gqlite_result* result);
+
+  /**
+   * @brief text of prepared statement that is cached. It is empty if statement is not cached.
+   */
+  const std::string& key() const { return _key; }
+  void setKey(const std::string& key) { _key = key; }
+
+  /**
+   * @brief collapse blanks outside of strings, so that same statements written in different
+   *        formats share one key.
+   */
+  static std::string normalize(const char* gql);
+
+private:
+  /**
+   * @brief callback of plans. Result is copied to buffer, and coroutine is suspended if buffer is full.
+   */
+  static int collect(gqlite_result* result, void* handle);
+  void run();
+  void clearResults();
+  /**
+   * @brief suspend plans in callback until results that refer to their page are pulled.
+   */
+  void suspend();
+  /**
+   * @brief yield coroutine, and pin transaction that keeps cursors of plans until it is resumed.
+   */
+  void yield();
+  int bind(int index, const std::function<GLiteral*()>& make);
+
+private:
+  GVirtualEngine* _engine;
+  std::vector<GListNode*> _asts;
+  struct Parameter {
+    std::vector<GListNode*> _nodes;
+    bool _bound = false;
+  };
+  std::map<int, Parameter> _parameters;
+  std::string _key;
+
+  GDefaultSchedule* _schedule;
+  GCoroutine* _coroutine;
+
+  std::deque<gqlite_result*> _results;
+  /**
+   * result that is returned by `next` last time.
+   */
+  gqlite_result* _current;
+  /**
+   * rows of a page that are not pulled in zero-copy mode. The page is valid while plans are suspended in callback.
+   */
+  gqlite_node* _view;
+  gqlite_node _viewNode;
+  gqlite_result _viewResult;
+  /**
+   * page of columns that is not pulled.
+   */
+  gqlite_result* _columns;
+  bool _zeroCopy;
+  bool _columnar;
+  size_t _prefetch;
+  bool _cancel;
+  int _errorCode;
+};
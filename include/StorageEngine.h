@@ -7,6 +7,7 @@
 #include <thread>
 #include "json.hpp"
 #include "base/type.h"
+#include "base/BloomFilter.h"
 #include <unordered_map>
 
 #define TEST_TIME(func) {\
@@ -22,16 +23,29 @@
 #define SCHEMA_CLASS_KEY        "key_type"
 #define SCHEMA_CLASS_VALUE      "val_type"
 #define SCHEMA_CLASS_NAME       "name"
+#define SCHEMA_CLASS_FILTER     "flt"
 #define SCHEMA_INDEX            "indx"
+#define SCHEMA_INDEX_INCLUDE    "incl"
+#define SCHEMA_INDEX_BUILD      "bld"
+#define SCHEMA_INDEX_BUCKET     "bkt"
+#define SCHEMA_INDEX_PARTIAL    "prt"
 #define SCHEMA_EDGE             "edge"
 #define MAP_BASIC               "__basic"
+#define INDEX_COVER_SUFFIX      ":c"
+#define INDEX_LOG_SUFFIX        ":log"
+#define INDEX_BUCKET_SUFFIX     ":b"
 
 #define SCHEMA_GLOBAL           "__global"
 #define GLOBAL_COMPRESS_LEVEL   "__lvl"
 #define GLOBAL_COMPRESS_DICT    "__dict"
 #define GLOBAL_GQL_VERSION      "__version"
+#define GLOBAL_INDEX_VERSION    "__idx_version"
 
 #define GQL_VERSION             "0.0.1"
+/**
+ * Layout of index maps. Since version 1, number postings are keyed by `gql::to_ordered_key`.
+ */
+#define INDEX_FORMAT_VERSION    1
 
 enum class ClassType : uint8_t {
     Undefined,
@@ -75,6 +89,8 @@ struct StoreOption {
 
 class GStorageEngine {
 public:
+    typedef mdbx::cursor_managed  cursor;
+
     GStorageEngine() noexcept;
     ~GStorageEngine();
 
@@ -113,8 +129,108 @@ public:
 
     /**
      * Add new index to graph schema
+     * @param includes attributes which values are stored with index entry,
+     *        so that a query only touch these attributes can be answered by index.
+     */
+    void addIndex(const std::string& indexname, const std::vector<std::string>& includes = {});
+
+    /**
+     * @brief get the attributes that covered by index. Empty if index is not a covering index.
+     */
+    std::vector<std::string> getIndexIncludes(const std::string& indexname);
+    bool isCoveringIndex(const std::string& indexname);
+
+    /**
+     * @brief Covering index map is named as `index:c`. Its key is encoded value + row key,
+     *        and its value is size of encoded value + cbor of included attributes.
+     *        Key is ordered by value, so a range of value can be read by a cursor.
+     * @param value encoded value by `encodeCovering`
+     */
+    int writeCovering(const std::string& indexname, const std::string& value, const std::string& key, const nlohmann::json& attrs);
+    int delCovering(const std::string& indexname, const std::string& value, const std::string& key);
+    cursor getCoveringCursor(const std::string& indexname);
+
+    static std::string encodeCovering(const std::string& value);
+    static std::string encodeCovering(double value);
+    /**
+     * @brief parse a covering entry to encoded value, row key and included attributes
+     */
+    static void parseCovering(const mdbx::slice& key, const mdbx::slice& data,
+      std::string& value, std::string& rowKey, nlohmann::json& attrs);
+
+    /**
+     * @brief An index which is building can't be used by query.
+     *        Its build state is recorded in schema as `{index: {hwm: last indexed key}}`.
+     */
+    bool isIndexReady(const std::string& indexname);
+    std::vector<std::string> getBuildingIndexes();
+    void setIndexBuildMark(const std::string& indexname, const std::string& key);
+    std::string getIndexBuildMark(const std::string& indexname);
+    void setIndexReady(const std::string& indexname);
+    /**
+     * @brief A partial index skipped some values of its attribute, such as booleans or numbers in arrays.
+     *        So count of its keys is not count of distinct values.
+     */
+    void setIndexPartial(const std::string& indexname);
+    bool isIndexPartial(const std::string& indexname);
+
+    /**
+     * @brief Side log of index records keys of rows which are written when index is building.
+     *        These rows are indexed again after group scan is finished.
      */
-    void addIndex(const std::string& indexname);
+    int writeIndexLog(const std::string& indexname, const std::string& key);
+    cursor getIndexLogCursor(const std::string& indexname);
+    int clearIndexLog(const std::string& indexname);
+
+    /**
+     * @brief Bucket index groups time values of rows by a fixed interval. Bucket map is named as `index:b`.
+     *        Every entry is a key of `bucket | time | row key` without value, so entries are sorted by time.
+     *        A time range is read from a few buckets, and expired rows are a leading range of entries.
+     */
+    void setBucketInterval(const std::string& indexname, uint64_t interval);
+    /**
+     * @return 0 if index is not a bucket index
+     */
+    uint64_t getBucketInterval(const std::string& indexname);
+    bool isBucketIndex(const std::string& indexname);
+
+    struct BucketEntry;
+    int writeBucket(const std::string& indexname, const BucketEntry& entry);
+    int delBucket(const std::string& indexname, const BucketEntry& entry);
+    /**
+     * @brief delete entries whose time is less than `time` one by one from the head of bucket map.
+     *        Group is not scanned, and deleted entries are as many as expired rows.
+     * @param keys row keys of deleted entries
+     */
+    int expireBucket(const std::string& indexname, uint64_t time, std::vector<std::string>& keys);
+    cursor getBucketCursor(const std::string& indexname);
+
+    struct BucketEntry {
+      uint64_t _time;
+      std::string _key;   /**< row key */
+
+      bool operator < (const BucketEntry& other) const {
+        return _time < other._time || (_time == other._time && _key < other._key);
+      }
+      bool operator == (const BucketEntry& other) const { return _time == other._time && _key == other._key; }
+    };
+    /**
+     * @brief numbers of key are encoded by `to_ordered_key`. Key of bucket without entry is the lower bound of its entries.
+     */
+    static std::string encodeBucket(uint64_t bucket, const BucketEntry* entry = nullptr);
+    static bool parseBucket(const mdbx::slice& data, uint64_t& bucket, BucketEntry& entry);
+
+    /**
+     * @brief Membership filter of map is kept in memory and saved with schema when graph is closed.
+     *        A point read of key which is not in filter returns without searching B-tree.
+     *        Edge groups enable it when they are initialized. It is sized by count of map.
+     */
+    void enableFilter(const std::string& mapname);
+    bool isFilterEnable(const std::string& mapname);
+    /**
+     * @brief false if key is not in map surely.
+     */
+    bool mayExist(const std::string& mapname, const void* key, size_t len);
 
     /** 
      * @brief Record an node/edge information to disk
@@ -146,11 +262,50 @@ public:
     int parse(const std::string& data, nlohmann::json& value);
 
     size_t estimate(const std::string& mapname);
+    /**
+     * @brief exact count of rows in map, or count of values in word/number index.
+     *        It is read from statistics of map, so rows are not scanned.
+     */
+    size_t count(const std::string& mapname);
 
-    typedef mdbx::cursor_managed  cursor;
     cursor getMapCursor(const std::string& mapname);
     cursor getIndexCursor(const std::string& mapname);
 
+    /**
+     * @brief start a read transaction of last committed data. It is not bound to session's
+     *        transaction, so that every worker thread can scan with its own snapshot.
+     */
+    mdbx::txn_managed startSnapshot();
+    /**
+     * @brief get cursor of an existed map in a snapshot.
+     */
+    static cursor getSnapshotCursor(mdbx::txn& txn, const std::string& mapname);
+
+    /**
+     * @brief remove a map with its entries. Its handles are released and its filter is cleared.
+     */
+    int dropMap(const std::string& mapname);
+    /**
+     * @brief write an entry with MDBX_APPEND, so that it is put to the last page without searching B-tree.
+     *        Entries should be written in key order, and an entry out of order is upserted.
+     * @param flags flags of map if it is created
+     */
+    int append(const std::string& mapname, MDBX_db_flags_t flags, const mdbx::slice& key, const mdbx::slice& value);
+    /**
+     * @brief replace schema by a restored one, except name of graph.
+     *        Saved filters are removed, and entries which are appended later are added to empty filters.
+     */
+    void replaceSchema(const nlohmann::json& schema);
+
+    /**
+     * @brief copy last committed data to a new file with a read transaction. It returns after copy is finished.
+     *        Current transaction is committed first. If `compact`, a new one is started before copy, free pages are skipped
+     *        and pages are written in order of B-tree, so the copy is smaller and scanned with better locality.
+     *        Otherwise copy takes the writer lock, and a new transaction is started after copy, so writes wait for the copy.
+     * @param path file should not exist
+     */
+    int backup(const std::string& path, bool compact);
+
     /** 
      * Get the schema of current graph instance.
      * Schema is a json which format as follows:
@@ -170,9 +325,38 @@ public:
      * Get vertex group's relations
      */
     std::list<std::tuple<std::string, std::string, std::string>> getRelations(const std::string& group);
+    /**
+     * Get vertex groups of edge group's endpoints
+     */
+    bool getRelation(const std::string& edge, std::string& from, std::string& to);
 
     int startTrans(ReadWriteOption opt = ReadWriteOption::read_write);
 
+    /**
+     * @brief commit current transaction with schema, then start a new one.
+     *        Commit is deferred while transaction is pinned, and its writes are committed by next commit.
+     * @return ECode_Fail if commit fails. Writes of transaction are dropped, and a new transaction is started.
+     */
+    int commitTrans();
+    /**
+     * @brief current write transaction has pages that are not committed.
+     */
+    bool isTransDirty();
+    /**
+     * @brief a suspended statement keeps cursors of current transaction, which are invalid after commit.
+     *        So transaction is pinned until statement is resumed.
+     */
+    void pinTrans() { ++_pinned; }
+    void unpinTrans() { --_pinned; }
+    bool isTransPinned() const { return _pinned != 0; }
+    /**
+     * @brief rows of a zero-copy statement refer to pages of current transaction, which may be moved by writes.
+     *        So writes are rejected with ECode_TRANSTION_Busy while the rows are viewed.
+     */
+    void pinView() { ++_views; }
+    void unpinView() { --_views; }
+    bool isViewPinned() const { return _views != 0; }
+
     // int finishTrans();
 
     int rollbackTrans();
@@ -214,22 +398,50 @@ private:
     void tryInitAttributeType(nlohmann::json& attributes, const std::string& attr, const nlohmann::json& value);
     void appendValue(uint8_t attrIndex, AttributeKind kind, const nlohmann::json& value, std::string& data);
     nlohmann::json getProp(const std::string& prop);
-    mdbx::map_handle getOrCreateHandle(const std::string& prop, mdbx::key_mode mode);
+    mdbx::map_handle getOrCreateHandle(const std::string& prop, mdbx::key_mode mode, mdbx::value_mode value = mdbx::value_mode::single);
     /*
      * @brief schema is used to record the graph's information
      */
     mdbx::map_handle openSchema(ReadWriteOption option);
+    void saveSchema(mdbx::txn_managed& txn);
+
+    GBloomFilter* getFilter(const std::string& mapname);
+    void addToFilter(const std::string& mapname, const void* key, size_t len);
+    /**
+     * @brief build filter with all keys of map.
+     */
+    void rebuildFilter(const std::string& mapname, size_t capacity);
+    /**
+     * @brief load filters when graph is opened. A filter which is not saved is built from its map.
+     *        Saved filters are removed in a writable graph, so a graph which is not closed builds them again.
+     */
+    void loadFilters(ReadWriteOption option);
+    void removeSavedFilters();
+    void saveFilters(mdbx::txn_managed& txn);
 
     void initMap(StoreOption);
 
     void initDict(int compressLvl);
     void releaseDict();
+    /**
+     * @brief indexes that are written in an older layout are dropped and built again from their groups.
+     *        If graph is read only, they are hidden from queries instead.
+     */
+    void upgradeIndexes(ReadWriteOption option);
 
 private:
     mdbx::env_managed _env;
     std::map<std::thread::id, mdbx::txn_managed> _txns;
     using handle_t = std::map<std::string, mdbx::map_handle>;
     std::map<std::thread::id, handle_t> _mHandles;
+    /**
+     * count of suspended statements that keep cursors of transaction
+     */
+    size_t _pinned = 0;
+    /**
+     * count of suspended zero-copy statements whose rows are not pulled
+     */
+    size_t _views = 0;
 
     /**
      * group_t map to group name
@@ -244,6 +456,8 @@ private:
      * prop contain current map information, include key type, attribute's name and its types.
      */
     nlohmann::json _schema;
+
+    std::map<std::string, GBloomFilter> _filters;
  
     std::string _curDBPath;
 
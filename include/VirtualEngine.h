@@ -19,6 +19,7 @@
 // error code of parsing gql  
 #define GQL_GRAMMAR_ARRAY_FAIL    -256
 #define GQL_GRAMMAR_OBJ_FAIL      -257
+#define GQL_GRAMMAR_PARAMETER_FAIL  -258
 
 struct _gqlite_result;
 
@@ -38,6 +39,7 @@ class GStorageEngine;
 struct GListNode;
 class GPlan;
 class GVirtualNetwork;
+class GStatement;
 class GVirtualEngine : public GContext {
 public:
   static uint32_t GenerateIndex();
@@ -65,6 +67,18 @@ public:
    */
   int execAST(GListNode* ast);
 
+  /**
+   * @brief keep an AST in statement that is being created.
+   * @return false if no statement is being created, and AST should be executed.
+   */
+  bool keepAST(GListNode* ast);
+
+  /**
+   * @brief make a placeholder of parameter `$index`. It is replaced by a value that is bound to statement.
+   *        A parameter can only be used in a statement that is being created.
+   */
+  GListNode* makeParameter(int index);
+
   /**
    * @brief execute some simple command that have no complex ast
    * 
@@ -95,6 +109,9 @@ public:
   // _scriptRangeCnt++ if `{` increase,  other wise decrease if encounter `}`
   int _scriptRangePairCnt = 0;
 
+  // statement that is being created. Its ASTs are kept instead of executed.
+  GStatement* _statement = nullptr;
+
 private:
   struct PlanList {
     GPlan* _plan;
@@ -134,6 +151,7 @@ private:
     VisitFlow apply(GCreateStmt* stmt, std::list<NodeType>& path);
     VisitFlow apply(GDropStmt* stmt, std::list<NodeType>& path);
     VisitFlow apply(GDumpStmt* stmt, std::list<NodeType>& path);
+    VisitFlow apply(GIndexStmt* stmt, std::list<NodeType>& path);
     VisitFlow apply(GRemoveStmt* stmt, std::list<NodeType>& path);
     VisitFlow apply(GObjectFunction* stmt, std::list<NodeType>& path);
 
@@ -151,6 +169,10 @@ private:
   bool makePlans2(GListNode* ast);
   int executePlans(PlanList*);
   void cleanPlans(PlanList*);
+  /**
+   * @brief build a batch of every building index, so that writing is not blocked by index creation.
+   */
+  void buildIndexes();
 
 private:
   MemoryPool<char> _memory;
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#define ARENA_BLOCK_SIZE  (1 << 16)
+
+/**
+ * @brief A bump allocator. Objects are carved from big blocks of `GMemory`, and released together by `reset`,
+ *        so that objects with same lifetime are not allocated and freed one by one.
+ *        Blocks are kept after reset, and reused by next allocations.
+ */
+class GArena {
+public:
+  GArena(size_t blockSize = ARENA_BLOCK_SIZE);
+  ~GArena();
+
+  GArena(const GArena&) = delete;
+  GArena& operator = (const GArena&) = delete;
+
+  void* allocate(size_t size, size_t align = alignof(std::max_align_t));
+
+  /**
+   * @brief memory of `count` objects. Objects are not constructed.
+   */
+  template<typename T>
+  T* allocate(size_t count = 1) {
+    return (T*)allocate(sizeof(T) * count, alignof(T));
+  }
+
+  /**
+   * @brief copy bytes, and end them with '\0'.
+   */
+  char* copy(const char* data, size_t len);
+
+  /**
+   * @brief release all objects. Blocks that are larger than default size are freed.
+   */
+  void reset();
+
+  /**
+   * @brief size of all blocks
+   */
+  size_t capacity() const;
+
+private:
+  struct Block {
+    char* _data;
+    size_t _size;
+  };
+
+  std::vector<Block> _blocks;
+  // index of block that is being used
+  size_t _current;
+  size_t _offset;
+  size_t _blockSize;
+};
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define BLOOM_DEFAULT_CAPACITY  (1 << 16)
+#define BLOOM_BITS_PER_KEY      10
+#define BLOOM_HASH_COUNT        6
+
+/**
+ * @brief A blocked bloom filter. All bits of a key are set in one 512 bits block,
+ *        so that a lookup touch only one cache line.
+ *        Keys can't be removed, so a removed key is only a false positive.
+ */
+class GBloomFilter {
+public:
+  GBloomFilter(size_t capacity = BLOOM_DEFAULT_CAPACITY);
+
+  void add(const void* key, size_t len);
+  /**
+   * @brief false means key is not exist. true means key may be exist.
+   */
+  bool mayContain(const void* key, size_t len) const;
+
+  /**
+   * @brief If count of keys is greater than capacity, false positive rate grows up,
+   *        and filter should be rebuilt with a bigger capacity.
+   */
+  bool full() const { return _count > _capacity; }
+  size_t capacity() const { return _capacity; }
+  size_t count() const { return _count; }
+
+  std::string serialize() const;
+  bool deserialize(const std::string& data);
+
+private:
+  static uint64_t hash(const void* key, size_t len);
+
+private:
+  std::vector<uint64_t> _bits;
+  size_t _capacity;
+  size_t _count;
+};
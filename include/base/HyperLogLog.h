@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define HLL_DEFAULT_PRECISION   12
+
+/**
+ * @brief HyperLogLog counts distinct keys with 2^precision registers.
+ *        Standard error is about 1.04 / sqrt(2^precision), 1.6% by default.
+ *        Sketches of the same precision can be merged, such as sketches of scan workers.
+ */
+class GHyperLogLog {
+public:
+  GHyperLogLog(uint8_t precision = HLL_DEFAULT_PRECISION);
+
+  void add(const void* key, size_t len);
+  void add(const std::string& key) { add(key.data(), key.size()); }
+  /**
+   * @return false if precision is not the same
+   */
+  bool merge(const GHyperLogLog& other);
+
+  size_t estimate() const;
+
+private:
+  static uint64_t hash(const void* key, size_t len);
+
+private:
+  uint8_t _precision;
+  std::vector<uint8_t> _registers;
+};
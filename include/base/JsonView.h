@@ -0,0 +1,45 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "json.hpp"
+
+/**
+ * @brief A lazy view of a stored JSON object. Text is scanned once to find positions of
+ *        top level attributes, and only the attributes that are read are parsed.
+ *        Structural characters are searched 16 bytes a time if SSE2 is supported.
+ */
+class GJsonView {
+public:
+  GJsonView(const char* data, size_t len);
+
+  /**
+   * @brief false if text is not an object, or a key of it is escaped.
+   *        Caller should parse the whole text instead.
+   */
+  bool valid() const { return _valid; }
+  size_t size() const { return _fields.size(); }
+
+  bool has(const std::string& key) const;
+  /**
+   * @brief parse the value of an attribute.
+   * 
+   * @return false if attribute is not exist
+   */
+  bool get(const std::string& key, nlohmann::json& value) const;
+
+private:
+  void index(const char* begin, const char* end);
+
+private:
+  struct Field {
+    const char* _key;
+    size_t _keyLen;
+    const char* _value;
+    size_t _valueLen;
+  };
+  const Field* find(const std::string& key) const;
+
+private:
+  std::vector<Field> _fields;
+  bool _valid;
+};
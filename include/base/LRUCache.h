@@ -0,0 +1,72 @@
+#pragma once
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief A cache that evicts least recently used items when it is full.
+ *        An item is taken out when it is used, because it can be owned by only one user.
+ *        Cache does not release items, evicted items are returned to caller.
+ */
+template<typename K, typename V>
+class GLRUCache {
+public:
+  GLRUCache(size_t capacity): _capacity(capacity ? capacity : 1) {}
+
+  /**
+   * @return false if key is not cached.
+   */
+  bool take(const K& key, V& value) {
+    auto itr = _index.find(key);
+    if (itr == _index.end()) return false;
+    value = std::move(itr->second->second);
+    _items.erase(itr->second);
+    _index.erase(itr);
+    return true;
+  }
+
+  /**
+   * @brief put an item as the most recently used one.
+   * @param evicted items that are removed from cache. If key is cached, the input value is evicted.
+   */
+  void put(const K& key, V value, std::vector<V>& evicted) {
+    if (_index.count(key)) {
+      evicted.emplace_back(std::move(value));
+      return;
+    }
+    _items.emplace_front(key, std::move(value));
+    _index[key] = _items.begin();
+    while (_items.size() > _capacity) {
+      evicted.emplace_back(std::move(_items.back().second));
+      _index.erase(_items.back().first);
+      _items.pop_back();
+    }
+  }
+
+  /**
+   * @brief remove all items.
+   */
+  std::vector<V> clear() {
+    std::vector<V> values;
+    for (auto& item : _items) {
+      values.emplace_back(std::move(item.second));
+    }
+    _items.clear();
+    _index.clear();
+    return values;
+  }
+
+  size_t size() const { return _items.size(); }
+  size_t capacity() const { return _capacity; }
+
+private:
+  using Item = std::pair<K, V>;
+
+  size_t _capacity;
+  /**
+   * the front is the most recently used item
+   */
+  std::list<Item> _items;
+  std::unordered_map<K, typename std::list<Item>::iterator> _index;
+};
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#define QUANTILE_DEFAULT_K      200
+
+/**
+ * @brief A KLL sketch of numbers. Items of level `h` have weight 2^h. When a level is full,
+ *        it is sorted and half of items are promoted to upper level.
+ *        Rank error is about 1.65 / k, and memory is O(k) items.
+ *        Sketches can be merged, such as sketches of scan workers.
+ */
+class GQuantileSketch {
+public:
+  GQuantileSketch(uint32_t k = QUANTILE_DEFAULT_K);
+
+  void add(double value);
+  void merge(const GQuantileSketch& other);
+
+  /**
+   * @param q rank in [0, 1], such as 0.5 for median
+   */
+  double quantile(double q) const;
+  /**
+   * @brief count of added numbers
+   */
+  uint64_t count() const { return _count; }
+
+private:
+  uint32_t capacity(size_t level) const;
+  void compress();
+
+private:
+  uint32_t _k;
+  uint64_t _count;
+  /**
+   * coin that select odd or even items when level is compacted
+   */
+  uint64_t _seed;
+  std::vector<std::vector<double>> _levels;
+};
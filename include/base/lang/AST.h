@@ -76,6 +76,10 @@ template <> struct GTypeTraits<NodeType::DumpStatement> {
   typedef GDumpStmt type;
 };
 
+template <> struct GTypeTraits<NodeType::IndexStatement> {
+  typedef GIndexStmt type;
+};
+
 template <> struct GTypeTraits<NodeType::CallExpression> {
   typedef GObjectFunction type;
 };
@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <vector>
 #include "base/gvm/Chunk.h"
 
 class GGQLExpression {
@@ -7,16 +8,20 @@ public:
   enum class CMDType {
     SHOW_GRAPH,
     SHOW_GRAPH_DETAIL,
+    VERIFY_INDEX,
+    IMPORT,
     MAX
   };
-  GGQLExpression(CMDType type = CMDType::MAX, const std::string& params = "");
+  GGQLExpression(CMDType type = CMDType::MAX, const std::string& params = "", const std::vector<std::string>& args = {});
 
   bool isCommand() const { return _cmdType != CMDType::MAX; }
   CMDType type() const { return _cmdType; }
   std::string params() const { return _params; }
+  const std::vector<std::string>& args() const { return _args; }
 private:
   CMDType _cmdType;
   std::string _params;
+  std::vector<std::string> _args;
 };
 
 struct GListNode;
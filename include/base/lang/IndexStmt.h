@@ -1,6 +1,30 @@
 #pragma once
+#include <cstdint>
+#include <string>
 
+struct GListNode;
 class GIndexStmt {
 public:
-  GIndexStmt();
+  /**
+   * @param graph graph name
+   * @param index index declaration, format is `group.attribute`
+   * @param includes attributes that will be stored beside every posting of index.
+   *                 If it is not nullptr, a covering index is created.
+   * @param interval if it is not 0, time values are grouped to buckets of this interval.
+   */
+  GIndexStmt(const std::string& graph, const std::string& index, GListNode* includes = nullptr, uint64_t interval = 0);
+  ~GIndexStmt();
+
+  std::string name() const { return _graph; }
+  std::string group() const { return _group; }
+  std::string attribute() const { return _attr; }
+  GListNode* includes() const { return _includes; }
+  uint64_t interval() const { return _interval; }
+
+private:
+  std::string _graph;
+  std::string _group;
+  std::string _attr;
+  GListNode* _includes;
+  uint64_t _interval;
 };
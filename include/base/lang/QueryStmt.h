@@ -3,15 +3,20 @@
 struct GListNode;
 class GQueryStmt {
 public:
-  GQueryStmt(GListNode* query, GListNode* graph, GListNode* conditions);
+  GQueryStmt(GListNode* query, GListNode* graph, GListNode* conditions, GListNode* options = nullptr);
   ~GQueryStmt();
 
   GListNode* query()const { return _query; }
   GListNode* graph()const { return _graph; }
   GListNode* where()const { return _conditions; }
+  /**
+   * properties such as `limit: 20, skip: 40`
+   */
+  GListNode* options()const { return _options; }
 private:
   GListNode* _query;
   GListNode* _graph;
   GListNode* _conditions;
+  GListNode* _options;
 
 };
\ No newline at end of file
@@ -6,7 +6,8 @@ class GRemoveStmt {
 public:
   enum RemoveType{
     Vertex,
-    Edge
+    Edge,
+    Expire
   };
   GRemoveStmt(const std::string& name, GListNode* array);
   virtual ~GRemoveStmt();
@@ -28,4 +29,13 @@ public:
 class GEdgeRemoveStmt : public GRemoveStmt {
 public:
   GEdgeRemoveStmt(const std::string& name, GListNode* array);
+};
+
+/**
+ * @brief remove vertexes whose time attribute is before a time, such as `{update_time: {$lt: 0d1653315732}}`.
+ *        If the attribute has a bucket index, expired buckets are removed as a whole.
+ */
+class GExpireStmt : public GRemoveStmt {
+public:
+  GExpireStmt(const std::string& name, GListNode* condition);
 };
\ No newline at end of file
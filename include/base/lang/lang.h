@@ -23,6 +23,7 @@
 #include "base/lang/MemberExpression.h"
 #include "base/lang/LambdaExpression.h"
 #include "base/lang/DumpStmt.h"
+#include "base/lang/IndexStmt.h"
 #include "base/lang/ReturnStmt.h"
 #include "base/lang/AssignStmt.h"
 #include "base/lang/ASTNode.h"
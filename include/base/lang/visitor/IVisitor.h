@@ -22,6 +22,7 @@ class GBlockStmt;
 class GLambdaExpression;
 class GObjectFunction;
 class GDumpStmt;
+class GIndexStmt;
 class GMemberExpression;
 class GGroupStmt;
 class GProperty;
@@ -50,6 +51,7 @@ public:
   virtual VisitFlow apply(GLambdaExpression*, std::list<NodeType>&) { return VisitFlow::SkipCurrent; }
   virtual VisitFlow apply(GObjectFunction*, std::list<NodeType>&)   { return VisitFlow::SkipCurrent; }
   virtual VisitFlow apply(GDumpStmt*, std::list<NodeType>&)     { return VisitFlow::SkipCurrent; }
+  virtual VisitFlow apply(GIndexStmt*, std::list<NodeType>&)    { return VisitFlow::SkipCurrent; }
   virtual VisitFlow apply(GMemberExpression*, std::list<NodeType>&) { return VisitFlow::SkipCurrent; }
   virtual VisitFlow apply(GGroupStmt*, std::list<NodeType>&)    { return VisitFlow::SkipCurrent; }
   virtual VisitFlow apply(GRemoveStmt*, std::list<NodeType>&)   { return VisitFlow::SkipCurrent; }
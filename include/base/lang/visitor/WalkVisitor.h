@@ -25,6 +25,7 @@ private:
   void makeEdgeCondition(GWalkDeclaration::Order order, EntityNode* start, EntityNode* end, bool direction);
 
   EntityNode* makeNodeCondition(const std::string& str);
+  EntityNode* makeNodeCondition(GListNode* condition);
 
 private:
   /**
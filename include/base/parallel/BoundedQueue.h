@@ -0,0 +1,99 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+/**
+ * @brief A blocking queue with limited size. Producers wait when it is full,
+ *        so that fast producers can't consume too much memory.
+ *        Consumer get nothing when all producers are done and queue is empty.
+ */
+template<typename T>
+class GBoundedQueue {
+public:
+  GBoundedQueue(size_t capacity, size_t producers)
+    :_capacity(capacity), _producers(producers), _closed(false) {}
+
+  /**
+   * @return false if queue is closed by consumer
+   */
+  bool push(T&& item) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _notFull.wait(lock, [this]() { return _closed || _items.size() < _capacity; });
+    if (_closed) return false;
+    _items.emplace_back(std::move(item));
+    _notEmpty.notify_one();
+    return true;
+  }
+
+  /**
+   * @return false if all producers are done and queue is empty, or queue is closed
+   */
+  bool pop(T& item) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _notEmpty.wait(lock, [this]() { return _closed || _producers == 0 || !_items.empty(); });
+    if (_closed || _items.empty()) return false;
+    item = std::move(_items.front());
+    _items.pop_front();
+    _notFull.notify_one();
+    return true;
+  }
+
+  /**
+   * @return false if queue is full or closed
+   */
+  bool tryPush(T& item) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (_closed || _items.size() >= _capacity) return false;
+    _items.emplace_back(std::move(item));
+    _notEmpty.notify_one();
+    return true;
+  }
+
+  /**
+   * @return false if no item is pushed in timeout, or queue is closed
+   */
+  bool pop(T& item, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (!_notEmpty.wait_for(lock, timeout, [this]() { return _closed || !_items.empty(); })) return false;
+    if (_closed) return false;
+    item = std::move(_items.front());
+    _items.pop_front();
+    _notFull.notify_one();
+    return true;
+  }
+
+  bool closed() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _closed;
+  }
+
+  /**
+   * @brief a producer finish its work
+   */
+  void done() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (_producers) --_producers;
+    _notEmpty.notify_all();
+  }
+
+  /**
+   * @brief consumer stop, all waiting producers return
+   */
+  void close() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _closed = true;
+    _notFull.notify_all();
+    _notEmpty.notify_all();
+  }
+
+private:
+  std::mutex _mutex;
+  std::condition_variable _notFull;
+  std::condition_variable _notEmpty;
+  std::deque<T> _items;
+  size_t _capacity;
+  size_t _producers;
+  bool _closed;
+};
@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief A read-only file that is mapped into memory, so that it is read by many threads without copy.
+ */
+class GMappedFile {
+public:
+  GMappedFile();
+  ~GMappedFile();
+
+  /**
+   * @return false if file can't be opened. An empty file is opened with null data.
+   */
+  bool open(const std::string& path);
+  void close();
+
+  const char* data() const { return _data; }
+  size_t size() const { return _size; }
+
+private:
+  const char* _data;
+  size_t _size;
+#ifdef _WIN32
+  void* _file;
+  void* _mapping;
+#else
+  int _fd;
+#endif
+};
@@ -32,10 +32,15 @@
 #define ECode_GQL_Edge_Type_Unknow  101
 #define ECode_GQL_Parse_Fail        200
 #define ECode_GQL_Type_Not_Match    201
+#define ECode_GQL_Parameter_Not_Exist 202
+#define ECode_GQL_Parameter_Not_Bound 203
 #define ECode_DISK_OPEN_FAIL        300
 #define ECode_DB_Drop_Fail          301
+#define ECode_DISK_WRITE_FAIL       302
+#define ECode_DISK_Checksum_Fail    303
 #define ECode_DATUM_Not_Exist       400
 #define ECode_TRANSTION_Not_Exist   500
+#define ECode_TRANSTION_Busy        501
 #define ECode_Query_Stop            600
 #define ECode_Query_Pause           601
 #define ECode_Remove_Unknow_Type    700
@@ -46,9 +51,10 @@
 
 typedef void* gqlite;
 
-typedef struct _gqlite_statement {
-  int value;
-}gqlite_statement;
+/**
+ * A statement that is created by `gqlite_create`. Its results are pulled by `gqlite_next`.
+ */
+typedef struct _gqlite_statement gqlite_statement;
 
 enum gqlite_primitive_type {
   gqlite_int,
@@ -83,6 +89,34 @@ typedef struct _gqlite_edge {
   uint32_t len;
 }gqlite_edge;
 
+typedef enum _gqlite_field_type {
+  gqlite_field_int,
+  gqlite_field_double,
+  gqlite_field_text,
+  gqlite_field_vector,
+}gqlite_field_type;
+
+/**
+ * A typed attribute of row that is written by bulk loading.
+ */
+typedef struct _gqlite_field {
+  const char* name;
+  gqlite_field_type type;
+  union {
+    int64_t integer;
+    double number;
+    const char* text;
+    const double* vector;
+  };
+  // length of text, or dimension of vector
+  uint32_t len;
+}gqlite_field;
+
+/**
+ * Bulk loading of a group that is started by `gqlite_bulk_begin`.
+ */
+typedef struct _gqlite_bulk gqlite_bulk;
+
 typedef enum _gqlite_node_type {
   gqlite_node_type_vertex,
   gqlite_node_type_edge,
@@ -100,12 +134,74 @@ typedef struct _gqlite_node {
 enum gqlite_result_type {
   gqlite_result_type_node,
   gqlite_result_type_cmd,
-  gqlite_result_type_info
+  gqlite_result_type_info,
+  gqlite_result_type_column
 };
+
+/**
+ * Structures of Arrow C data interface, so that a page of columns can be imported by Arrow without copy.
+ */
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+  // Array type description
+  const char* format;
+  const char* name;
+  const char* metadata;
+  int64_t flags;
+  int64_t n_children;
+  struct ArrowSchema** children;
+  struct ArrowSchema* dictionary;
+
+  // Release callback
+  void (*release)(struct ArrowSchema*);
+  // Opaque producer-specific data
+  void* private_data;
+};
+
+struct ArrowArray {
+  // Array data description
+  int64_t length;
+  int64_t null_count;
+  int64_t offset;
+  int64_t n_buffers;
+  int64_t n_children;
+  const void** buffers;
+  struct ArrowArray** children;
+  struct ArrowArray* dictionary;
+
+  // Release callback
+  void (*release)(struct ArrowArray*);
+  // Opaque producer-specific data
+  void* private_data;
+};
+
+#endif  // ARROW_C_DATA_INTERFACE
+
+/**
+ * A page of rows in columns. It is a struct array whose children are columns:
+ * `id` of vertexes or `from`, `to`, `direction` of edges, then one column for every attribute.
+ * Integers are int64, decimals are double, vectors are fixed size lists of double,
+ * and strings or other values are utf8 json.
+ */
+typedef struct _gqlite_columns {
+  struct ArrowSchema* schema;
+  struct ArrowArray* array;
+}gqlite_columns;
 typedef struct _gqlite_result {
   union {
+    /**
+     * A page of `count` nodes. They are a contiguous array, and also linked by `_next`.
+     * Nodes are released after callback returns.
+     */
     gqlite_node* nodes;
     char** infos;
+    gqlite_columns* columns;
   };
   uint32_t count;
   enum gqlite_result_type type;
@@ -130,9 +226,108 @@ extern "C" {
   */
   SYMBOL_EXPORT int gqlite_version(gqlite* ppDb, int* major, int* minor, int* patch);
   SYMBOL_EXPORT int gqlite_exec(gqlite* pDb, const char* gql, int (*gqlite_callback)(gqlite_result*, void*), void*, char** err);
+  /**
+   * @brief parse gql to a statement. It is executed by `gqlite_execute`.
+   */
   SYMBOL_EXPORT int gqlite_create(gqlite* pDb, const char* gql, gqlite_statement** statement);
+  /**
+   * @brief parse gql with parameters `$1`, `$2`... to a statement. Prepared statements are cached,
+   *        so a finalized statement is reused by next prepare of same gql without parsing.
+   */
+  SYMBOL_EXPORT int gqlite_prepare(gqlite* pDb, const char* gql, gqlite_statement** statement);
+  /**
+   * @brief bind a value to parameter `$index` before statement is executed.
+   *        A running statement is stopped when a value is bound.
+   * @return ECode_GQL_Parameter_Not_Exist if statement has no such parameter.
+   */
+  SYMBOL_EXPORT int gqlite_bind_int(gqlite* pDb, gqlite_statement* statement, int index, int64_t value);
+  SYMBOL_EXPORT int gqlite_bind_double(gqlite* pDb, gqlite_statement* statement, int index, double value);
+  /**
+   * @param len length of text. If it is negative, text ends with '\0'.
+   */
+  SYMBOL_EXPORT int gqlite_bind_text(gqlite* pDb, gqlite_statement* statement, int index, const char* text, int len);
+  /**
+   * @brief start statement. A statement without result is finished here,
+   *        and a query buffers its first results.
+   * @return ECode_GQL_Parameter_Not_Bound if a parameter has no value.
+   */
   SYMBOL_EXPORT int gqlite_execute(gqlite* pDb, gqlite_statement* statement);
+  /**
+   * @brief pull next result of statement.
+   * @param result it is released by statement when next result is pulled or statement is finalized.
+   * @return ECode_Success if a result is returned. ECode_Query_Stop if all results are returned.
+   */
   SYMBOL_EXPORT int gqlite_next(gqlite* pDb, gqlite_statement* statement, gqlite_result** result);
+  /**
+   * @brief count of results that statement buffers when it is executing. Default is 64.
+   */
+  SYMBOL_EXPORT int gqlite_prefetch(gqlite* pDb, gqlite_statement* statement, uint32_t count);
+  /**
+   * @brief In zero-copy mode, properties of results refer to stored values instead of copies,
+   *        and they are not ended with '\0', so `len` should be used.
+   *        A result is valid until next result is pulled. Until then, writes of the same handle return ECode_TRANSTION_Busy.
+   *        Rows that are projected, sorted or joined, or have datetime, vector or binary attributes, are still copied.
+   */
+  SYMBOL_EXPORT int gqlite_zero_copy(gqlite* pDb, gqlite_statement* statement, bool enable);
+  /**
+   * @brief results of statement are pages of columns in Arrow layout, whose type is `gqlite_result_type_column`.
+   *        A page is released when next result is pulled, unless its schema and array are moved by an Arrow consumer.
+   *        A moved page keeps its buffers until consumer calls `release`.
+   */
+  SYMBOL_EXPORT int gqlite_columnar(gqlite* pDb, gqlite_statement* statement, bool enable);
+  /**
+   * @brief copy a result, so that it is kept after next result is pulled. It is released by `gqlite_free_result`.
+   *        A page of columns can't be copied, and nullptr is returned.
+   */
+  SYMBOL_EXPORT gqlite_result* gqlite_copy_result(const gqlite_result* result);
+  SYMBOL_EXPORT void gqlite_free_result(gqlite_result* result);
+  /**
+   * @brief stop statement and release it. Rows that are not pulled are not scanned.
+   *        A prepared statement is kept in cache instead.
+   */
+  SYMBOL_EXPORT int gqlite_finalize(gqlite* pDb, gqlite_statement* statement);
+
+  /**
+   * @brief start bulk loading of a group. Rows are written without parsing gql,
+   *        and indexes of group are built when loading ends, so they can't be used by query before it.
+   * @return ECode_Group_Not_Exist if group is not created.
+   */
+  SYMBOL_EXPORT int gqlite_bulk_begin(gqlite* pDb, const char* group, gqlite_bulk** bulk);
+  /**
+   * @brief write a vertex. Only id of `vertex` is used, and its attributes are `fields`.
+   * @return ECode_GQL_Type_Not_Match if type of id is not the type of group.
+   */
+  SYMBOL_EXPORT int gqlite_bulk_vertex(gqlite* pDb, gqlite_bulk* bulk, const gqlite_vertex* vertex, const gqlite_field* fields, uint32_t count);
+  /**
+   * @param direction if true, edge is from `from` to `to`.
+   */
+  SYMBOL_EXPORT int gqlite_bulk_edge(gqlite* pDb, gqlite_bulk* bulk, const gqlite_vertex* from, const gqlite_vertex* to, bool direction, const gqlite_field* fields, uint32_t count);
+  /**
+   * @brief build indexes of group, commit and release bulk.
+   */
+  SYMBOL_EXPORT int gqlite_bulk_end(gqlite* pDb, gqlite_bulk* bulk);
+
+  /**
+   * @brief write a binary snapshot of opened graph to `path`. Current transaction is committed first,
+   *        then groups and indexes are dumped in parallel, and every block of rows has a checksum.
+   * @return ECode_TRANSTION_Busy if a statement is not finalized.
+   */
+  SYMBOL_EXPORT int gqlite_snapshot(gqlite* pDb, const char* path);
+  /**
+   * @brief replace opened graph by a snapshot. Posting lists of indexes are restored without building.
+   * @return ECode_DISK_Checksum_Fail if snapshot is broken, and graph is not changed.
+   *         ECode_TRANSTION_Busy if a statement is not finalized.
+   */
+  SYMBOL_EXPORT int gqlite_restore(gqlite* pDb, const char* path);
+
+  /**
+   * @brief copy opened graph to a new file from a read snapshot. The call blocks the session until copy is finished.
+   *        If `compact`, free pages are dropped and pages are renumbered, so file shrinks after many removes,
+   *        and write transaction of session stays open. Otherwise copy takes the writer lock, so no write is done during copy.
+   * @param path file should not exist
+   * @return ECode_TRANSTION_Busy if a statement is not finalized.
+   */
+  SYMBOL_EXPORT int gqlite_backup(gqlite* pDb, const char* path, bool compact);
 
   SYMBOL_EXPORT int gqlite_close(gqlite* pDb);
   SYMBOL_EXPORT char* gqlite_error(gqlite* pDb, int error);
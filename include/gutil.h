@@ -42,6 +42,18 @@ namespace gql {
    */
   std::string normalize(const std::string& gql);
 
+  /**
+   * @brief encode a number to 8 bytes big-endian key which keep the order of number
+   *        when keys are compared by memcmp.
+   */
+  std::string to_ordered_key(double value);
+  double from_ordered_key(const char* key);
+
+  /**
+   * @brief CRC-32 (IEEE) of data. A crc of previous data can be passed to continue it.
+   */
+  uint32_t crc32(const void* data, size_t len, uint32_t crc = 0);
+
   struct alignas(8) edge_id {
     bool _direction : 1;
     uint8_t _from_type : 1; // 0 means integer, otherwise bytes
@@ -0,0 +1,74 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "json.hpp"
+#include "base/parallel/BoundedQueue.h"
+
+#define PIPELINE_QUEUE_SIZE   256
+/**
+ * Milliseconds that a blocked source waits for output of operators.
+ */
+#define PIPELINE_WAIT_MS      1
+/**
+ * A query which returns less rows than this is not pipelined, because starting threads costs more.
+ */
+#define PIPELINE_MIN_ROWS     (1 << 12)
+
+enum class KeyType: uint8_t;
+
+/**
+ * @brief a row that flows between stages of a pipeline.
+ */
+struct PipelineRow {
+  KeyType _type;
+  std::string _key;
+  nlohmann::json _value;
+  /**
+   * serialized value that is filled by a stage
+   */
+  std::string _text;
+  int _status;
+};
+
+/**
+ * @brief Operators of a pipeline run in their own threads and are connected by bounded queues,
+ *        so that an operator works on next rows while the later one works on former rows.
+ *        Source and sink run in caller's thread, because transaction of storage is bound to it.
+ *        When queues are full, source waits and sink consumes rows.
+ */
+class GPipeline {
+public:
+  /**
+   * @brief push a row to next stage. It returns false if pipeline is stopped.
+   */
+  using Emit = std::function<bool(PipelineRow&&)>;
+  using Source = std::function<void(const Emit&)>;
+  /**
+   * @brief process a row. It returns false if row is dropped.
+   */
+  using Operator = std::function<bool(PipelineRow&)>;
+  /**
+   * @brief consume a row. It returns false to stop pipeline.
+   */
+  using Sink = std::function<bool(PipelineRow&)>;
+
+  GPipeline(size_t capacity = PIPELINE_QUEUE_SIZE);
+
+  void source(const Source& source) { _source = source; }
+  void then(const Operator& op) { _operators.push_back(op); }
+
+  /**
+   * @brief run all stages until source is finished or sink stops.
+   *        An exception of any stage is thrown again after all stages are stopped.
+   */
+  void run(const Sink& sink);
+
+private:
+  using Queue = GBoundedQueue<PipelineRow>;
+
+  size_t _capacity;
+  Source _source;
+  std::vector<Operator> _operators;
+};
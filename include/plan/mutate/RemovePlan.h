@@ -6,9 +6,18 @@ class GRemovePlan: public GPlan {
 public:
   GRemovePlan(GContext* context, GRemoveStmt* stmt);
   ~GRemovePlan();
+  virtual int prepare();
   virtual int execute(GVM* gvm, const std::function<ExecuteStatus(KeyType, const std::string& key, nlohmann::json& value, int status)>&);
 
+private:
+  /**
+   * @brief remove expired rows whose keys are deleted from the head of bucket map, so group is not scanned.
+   * @return ECode_Fail if condition can't be answered by bucket index
+   */
+  int expire();
+
 private:
   std::string _group;
+  bool _expire;
   GPlan* _scan;
 };
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include "json.hpp"
 #include "Graph/GRAD.h"
 #include "operand/query/HNSW.h"
+#include "IndexWriter.h"
 #include <cstddef>
 
 #define ATTRIBUTE_SET(item) \
@@ -197,73 +198,44 @@ private:
 private:
   bool upsetVertex();
   bool upsetEdge();
-  bool upsetIndex(const std::string& index, const std::string& value, uint64_t id);
-  bool upsetIndex(const std::string& index, double value, uint64_t id);
-  bool upsetIndex(const std::string& index, double value, const std::string& id);
-  bool upsetIndex(const std::string& index, const std::string& value, const std::string& id);
   void addVectorIndex(const std::string& index, const std::string& id, const std::vector<double>& v);
   void addVectorIndex(const std::string& index, uint32_t id, const std::vector<double>& v);
   GVirtualNetwork* generateNetwork(const std::string& branch);
 
+  /**
+   * @brief read current row before it is overwritten, so that its old index values can be removed.
+   */
   template<typename T>
-  bool upsetIndex(const nlohmann::json& item, const T& id) {
-    for (auto& index : _indexes) {
-      std::string k = index.substr(_class.size() + 1, index.size() - _class.size() - 1);
+  nlohmann::json readVertex(const T& id) {
+    nlohmann::json row;
+    std::string data;
+    if (_writer->indexes().empty() || !_store->isMapExist(_class)) return row;
+    if (_store->read(_class, id, data) == ECode_Success && data.size()) {
+      row = nlohmann::json::parse(data);
+    }
+    return row;
+  }
+
+  template<typename T>
+  bool upsetIndex(const nlohmann::json& item, const T& id, const nlohmann::json& old) {
+    for (auto& index : _writer->indexes()) {
+      std::string k = _writer->attribute(index);
       if (item.count(k) == 0) continue;
       auto& value = item[k];
-      if (value.is_object() && value.count(OBJECT_TYPE_NAME)) {
-        switch ((AttributeKind)value[OBJECT_TYPE_NAME])
-        {
-        case AttributeKind::Vector:
-        {
-          if (!_hnsws.count(index)) {
-            // group name + index name can fix identity name
-            GVirtualNetwork* net = generateNetwork(index);
-            _hnsws[index] = new GHNSW(net, _store, index.c_str(), (index + ":v").c_str());
-          }
-          addVectorIndex(index, id, value["value"]);
-          _store->updateIndexType(index, IndexType::Vector);
-        }
-          break;
-        case AttributeKind::Datetime: {
-          uint64_t v = value["value"];
-          upsetIndex(index, v, id);
-        }
-          break;
-        default:
-          printf("TODO: Not implement: %d\n", (AttributeKind)value[OBJECT_TYPE_NAME]);
-          break;
+      if (value.is_object() && value.count(OBJECT_TYPE_NAME) &&
+        (AttributeKind)value[OBJECT_TYPE_NAME] == AttributeKind::Vector) {
+        if (!_hnsws.count(index)) {
+          // group name + index name can fix identity name
+          GVirtualNetwork* net = generateNetwork(index);
+          _hnsws[index] = new GHNSW(net, _store, index.c_str(), (index + ":v").c_str());
         }
-      }
-      else if (value.is_string()) {
-        upsetIndex(index, (std::string)value, id);
-      }
-      else if (value.is_number_unsigned()) {
-        uint64_t k = value;
-        upsetIndex(index, k, id);
-      }
-      else if (value.is_number_integer()) {
-        double k = value;
-        upsetIndex(index, k, id);
-      }
-      else if (value.is_array()) {
-        for (auto datum: value)
-        {
-          switch ((nlohmann::json::value_t)datum)
-          {
-          case nlohmann::json::value_t::string:
-            upsetIndex(index, (std::string)datum, id);
-            break;
-          default:
-            break;
-          }
-        }
-      }
-      else {
-        printf("%s unknow type: %s\n", index.c_str(), value.type_name());
+        addVectorIndex(index, id, value["value"]);
+        _store->updateIndexType(index, IndexType::Vector);
       }
     }
-    return true;
+    gkey_t key;
+    key = id;
+    return _writer->update(key, old, item) == ECode_Success;
   }
 private:
   bool _vertex;       /**< true if upset target is vertex, else is edge */
@@ -272,7 +244,7 @@ private:
   nlohmann::json _props;
   std::map<gkey_t, nlohmann::json> _vertexes;
   std::map<gql::edge_id, std::string> _edges;
-  std::vector<std::string> _indexes;
+  GIndexWriter* _writer;
   // 
   std::map<std::string, GHNSW*> _hnsws;
 
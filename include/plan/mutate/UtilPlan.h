@@ -13,10 +13,12 @@ public:
     Creation,
     Drop,
     Dump,
+    Index,
   };
   GUtilPlan(GContext* context, GCreateStmt* ast);
   GUtilPlan(GContext* context, GDropStmt* ast);
   GUtilPlan(GContext* context, GDumpStmt* ast);
+  GUtilPlan(GContext* context, GIndexStmt* ast);
   virtual int prepare();
   virtual int execute(GVM* gvm, const std::function<ExecuteStatus(KeyType, const std::string& key, nlohmann::json& value, int status)>&);
 
@@ -30,18 +32,21 @@ private:
   Variant<std::string> _var;
   /**
    * @brief for creation, _vParams1 are groups name
-   * 
+   *        for index, _vParams1 is index's group
    */
   std::vector<Variant<std::string>> _vParams1;
   /**
    * @brief for creation, _vParams2 are group's property
-   * 
+   *        for index, _vParams2 is included attributes
    */
   std::vector<std::vector<std::string>> _vParams2;
   /**
    * @brief for creation, _vParams3 are indexes
-   * 
+   *        for index, _vParams3 is index name
    */
   std::vector<Variant<std::string>> _vParams3;
-
+  /**
+   * @brief for index, interval of time bucket. 0 if index is not a bucket index.
+   */
+  uint64_t _interval = 0;
 };
@@ -0,0 +1,97 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <limits>
+#include "json.hpp"
+#include "base/HyperLogLog.h"
+#include "base/QuantileSketch.h"
+
+enum class AggregateKind {
+  Count,
+  Sum,
+  Avg,
+  Min,
+  Max,
+  ApproxCountDistinct,
+  ApproxQuantile,
+};
+
+/**
+ * @brief An aggregate function of query, such as `avg(movie.rating)`.
+ *        `_attr` is empty if function is applied to rows, such as `count(movie)`.
+ */
+struct AggregateSpec {
+  AggregateKind _kind;
+  std::string _attr;
+  /**
+   * rank of `approx_quantile`, such as 0.5
+   */
+  double _param = 0;
+
+  /**
+   * @brief name of result column, such as `avg(rating)`
+   */
+  std::string name() const;
+};
+
+/**
+ * @brief Aggregate rows with a hash group-by. Every scan worker can aggregate its own rows,
+ *        then partial results are merged.
+ */
+class GAggregator {
+public:
+  GAggregator(const std::vector<AggregateSpec>& specs, const std::string& groupBy);
+
+  void add(const nlohmann::json& row);
+  /**
+   * @brief add count of a function without reading rows, such as count from statistics of map.
+   *        It is used by `count` of rows and `approx_count_distinct`.
+   */
+  void addCount(size_t spec, size_t count);
+  void merge(GAggregator& other);
+  void clear() { _groups.clear(); }
+
+  /**
+   * @brief rows of result, every group is a row.
+   */
+  std::vector<nlohmann::json> result() const;
+
+  const std::vector<AggregateSpec>& specs() const { return _specs; }
+  const std::string& groupBy() const { return _groupBy; }
+  /**
+   * @brief attributes that are read by aggregate functions and group-by.
+   */
+  std::vector<std::string> attributes() const;
+  /**
+   * @return false if name is not an aggregate function
+   */
+  static bool parseKind(const std::string& name, AggregateKind& kind);
+
+private:
+  struct State {
+    size_t _count = 0;
+    double _sum = 0;
+    double _min = std::numeric_limits<double>::max();
+    double _max = std::numeric_limits<double>::lowest();
+    /**
+     * sketches are created when the first value is added
+     */
+    std::unique_ptr<GHyperLogLog> _distinct;
+    std::unique_ptr<GQuantileSketch> _quantile;
+  };
+  struct Group {
+    nlohmann::json _value;
+    std::vector<State> _states;
+  };
+  Group& group(const nlohmann::json& value);
+
+private:
+  std::vector<AggregateSpec> _specs;
+  std::string _groupBy;
+  /**
+   * key of group is dumped value of group-by attribute
+   */
+  std::unordered_map<std::string, Group> _groups;
+};
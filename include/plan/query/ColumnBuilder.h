@@ -0,0 +1,77 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "json.hpp"
+#include "gqlite.h"
+
+enum class KeyType: uint8_t;
+class GArena;
+
+/**
+ * @brief Rows are appended to typed columns, then a page of columns is built in Arrow layout.
+ *        Type of column is decided by its first value. When a later value doesn't fit,
+ *        integers are promoted to doubles, and other columns are changed to json text.
+ */
+class GColumnBuilder {
+public:
+  GColumnBuilder();
+
+  /**
+   * @brief vertexes and edges have different id columns, so they can't be in a page.
+   */
+  bool accept(KeyType type) const;
+  void add(KeyType type, const std::string& key, const nlohmann::json& row);
+
+  size_t size() const { return _rows; }
+
+  /**
+   * @brief build a page of columns in its own memory, which is freed when `schema` and `array` are released.
+   *        They may be moved by an Arrow consumer, and released by it later.
+   */
+  void build(struct ArrowSchema* schema, struct ArrowArray* array) const;
+  void clear();
+
+private:
+  enum class ColumnKind {
+    Null,
+    Bool,
+    Int64,
+    UInt64,
+    Double,
+    Vector,
+    Utf8,
+  };
+
+  struct Column {
+    std::string _name;
+    ColumnKind _kind = ColumnKind::Null;
+    // size of vector
+    size_t _width = 0;
+    std::vector<bool> _valid;
+    std::vector<int64_t> _ints;
+    std::vector<double> _doubles;
+    std::vector<int32_t> _offsets;
+    std::string _bytes;
+  };
+
+  Column& column(const std::string& name);
+  void appendId(Column& col, uint8_t type, const char* id, size_t len);
+  void append(Column& col, const nlohmann::json& value);
+  void appendText(Column& col, const std::string& text);
+  void appendNull(Column& col);
+  void pushDefault(Column& col);
+  void setKind(Column& col, ColumnKind kind, size_t width = 0);
+  /**
+   * @brief change values of column to json text
+   */
+  void toText(Column& col);
+  void build(GArena& arena, const Column& col, struct ArrowSchema* schema, struct ArrowArray* array) const;
+
+private:
+  bool _edge;
+  size_t _rows;
+  std::vector<Column> _columns;
+  std::map<std::string, size_t> _index;
+};
@@ -0,0 +1,34 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include "json.hpp"
+#include "base/BloomFilter.h"
+
+/**
+ * @brief Build side of a hash join. Rows of a scan are built into a hash table by their keys,
+ *        then keys of the other side probe it.
+ *        After `seal`, a bloom bitmap of keys is probed first, so that most of missed keys
+ *        don't touch the hash table. It is used as a semi-join filter that pushed into edge scan.
+ */
+class GHashJoin {
+public:
+  void build(const std::string& key, nlohmann::json& row);
+  /**
+   * @brief build is finished, bitmap of keys is created.
+   */
+  void seal();
+  void clear();
+
+  /**
+   * @return row of key, or nullptr if key is not built
+   */
+  const nlohmann::json* probe(const std::string& key) const;
+  bool contains(const std::string& key) const { return probe(key) != nullptr; }
+
+  size_t size() const { return _rows.size(); }
+
+private:
+  std::unordered_map<std::string, nlohmann::json> _rows;
+  GBloomFilter _bitmap;
+  bool _sealed = false;
+};
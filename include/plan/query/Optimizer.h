@@ -0,0 +1,73 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Graph/GRAD.h"
+#include "StorageEngine.h"
+
+/**
+ * Cost of reading a row by cursor, reading a row by its key, parsing and predicting a row,
+ * and reading a key of posting or an entry of index.
+ */
+#define COST_SEQUENTIAL_ROW   1.0
+#define COST_RANDOM_ROW       4.0
+#define COST_DECODE_ROW       1.0
+#define COST_INDEX_ENTRY      0.25
+
+enum class AccessKind {
+  Scan,           /**< scan all rows of group */
+  Index,          /**< read postings of an index, then rows by their keys */
+  Intersection,   /**< intersect postings of many indexes, then read rows by their keys */
+  Covering,       /**< scan a covering index only */
+  Bucket,         /**< scan buckets of a time range, then rows by their keys */
+};
+
+struct AccessPath {
+  AccessKind _kind = AccessKind::Scan;
+  std::vector<std::string> _indexes;
+  /**
+   * estimated count of rows that are read
+   */
+  double _rows = 0;
+  double _cost = 0;
+};
+
+/**
+ * @brief GOptimizer enumerates access paths of a group and chooses the cheapest one.
+ *        Count of rows and values are read from statistics of maps, and count of values
+ *        in a range is estimated by cursors of index. So no statistic is collected by scan.
+ */
+class GOptimizer {
+public:
+  GOptimizer(GStorageEngine* store, const std::string& group);
+
+  /**
+   * @param conditions conditions of `and` pattern
+   * @param covering covering index that contains all attributes of query, or empty
+   * @param bucket bucket index that can be scanned by time range, or empty
+   */
+  AccessPath choose(const std::vector<AttributeCondition>& conditions, const std::string& covering, const std::string& bucket);
+  std::vector<AccessPath> enumerate(const std::vector<AttributeCondition>& conditions, const std::string& covering, const std::string& bucket);
+
+  /**
+   * @brief get inclusive range of index's keys from conditions of its attribute.
+   *        Upper is empty if range has no upper bound.
+   * @return false if index can't be seeked by conditions
+   */
+  static bool range(IndexType type, const std::string& attr, const std::vector<AttributeCondition>& conditions, std::string& lower, std::string& upper);
+
+private:
+  /**
+   * @brief count of index's keys in range
+   */
+  size_t values(GStorageEngine::cursor& from, const std::string& lower, const std::string& upper, GStorageEngine::cursor& to);
+  /**
+   * @brief estimated count of rows whose attribute is in range of index.
+   */
+  double estimate(const std::string& index, const std::string& lower, const std::string& upper);
+  double estimateBucket(const std::string& index, const std::vector<AttributeCondition>& conditions);
+
+private:
+  GStorageEngine* _store;
+  std::string _group;
+  double _rows;
+};
@@ -0,0 +1,86 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <functional>
+#include "json.hpp"
+#include "Graph/GRAD.h"
+
+#define SELECTIVITY_KEY     0.001f
+#define SELECTIVITY_EQUAL   0.05f
+#define SELECTIVITY_RANGE   0.3f
+#define SELECTIVITY_OTHER   0.5f
+#define SELECTIVITY_EXISTS  0.9f
+
+enum class KeyType: uint8_t;
+
+/**
+ * @brief Predicates of a query condition are compiled to a flat program of typed comparations.
+ *        Literal is converted to its type once, and a row's attribute is compared without `Variant`.
+ *        And ops are ordered by estimated selectivity so that the most selective one is checked first,
+ *        and or ops are ordered reversely.
+ *        A predicate that can't be specialized, such as `near`, is kept as a function op.
+ */
+class GPredicateProgram {
+public:
+  enum class OpKind : uint8_t {
+    Number,     /**< compare number or datetime attribute with a number */
+    String,     /**< compare string attribute with a string */
+    Exists,     /**< attribute has a comparable value, such as `{attr: '*'}` */
+    Key,        /**< key is equal to a literal */
+    Function,
+  };
+
+  struct Op {
+    OpKind _kind;
+    CompareOperator _op;
+    std::string _attr;
+    double _number;
+    std::string _string;
+    /** integer form of key literal, `_isInteger` is false if literal is not an integer */
+    uint64_t _integer;
+    bool _isInteger;
+    std::function<bool(const attribute_t&)> _func;
+    float _selectivity;
+  };
+
+  GPredicateProgram();
+
+  /**
+   * @brief compile predicates of vertexes.
+   * @return false if condition can't be compiled, and predicates should be interpreted.
+   */
+  bool compile(const QueryCondition& where);
+  bool compiled() const { return _compiled; }
+
+  bool match(KeyType type, const gkey_t& key, const nlohmann::json& row) const;
+  /**
+   * @brief evaluate ops over many rows. Every op is run on the rows that are still selected.
+   * @param selection indexes of rows that match
+   */
+  void select(KeyType type, const std::vector<gkey_t>& keys, const std::vector<nlohmann::json>& rows, std::vector<uint32_t>& selection) const;
+
+  /**
+   * @brief call a function predicate with attribute of a row.
+   */
+  static bool call(const std::function<bool(const attribute_t&)>& op, const nlohmann::json& attr);
+
+private:
+  bool eval(const Op& op, KeyType type, const gkey_t& key, const nlohmann::json& row) const;
+
+  template<typename T>
+  static bool compare(CompareOperator op, const T& left, const T& right) {
+    switch (op) {
+    case CompareOperator::Equal: return left == right;
+    case CompareOperator::LessThan: return left < right;
+    case CompareOperator::LessEqual: return left <= right;
+    case CompareOperator::GreatThan: return left > right;
+    case CompareOperator::GreatEqual: return left >= right;
+    default: return false;
+    }
+  }
+
+private:
+  std::vector<Op> _and;
+  std::vector<Op> _or;
+  bool _compiled;
+};
@@ -1,5 +1,12 @@
 #pragma once
 #include "plan/Plan.h"
+#include "base/Arena.h"
+#include "plan/query/ColumnBuilder.h"
+
+/**
+ * Max count of rows that are returned by one callback.
+ */
+#define QUERY_PAGE_SIZE   256
 
 class GScanPlan;
 class GQueryStmt;
@@ -13,8 +20,30 @@ public:
   virtual void addCompiler(Compiler* c);
   
 private:
-  void convert_vertex(KeyType type, const std::string& key, nlohmann::json& value, gqlite_result& result);
-  void convert_edge(const std::string& key, nlohmann::json& value, gqlite_result& result);
+  /**
+   * @brief serialize a row to json text that is returned.
+   */
+  std::string serialize(KeyType type, nlohmann::json& value);
+  /**
+   * @brief append a serialized row to current page. Page is returned by callback when it is full.
+   * @param copy false if value is stored bytes that are valid until query finished, so it is referred directly.
+   * @return result of callback. If it is ECode_Query_Stop, query is stopped.
+   */
+  int output(KeyType type, const std::string& key, const char* value, size_t len, int status, bool copy);
+  /**
+   * @brief append a row to columns of current page. Page is returned by callback when it is full.
+   */
+  int append(KeyType type, const std::string& key, nlohmann::json& value);
+  /**
+   * @brief return rows of current page by callback, then release them.
+   */
+  int flush();
+  /**
+   * @brief release page of columns if it is not moved by consumer.
+   */
+  void releaseColumns();
+  void convert_vertex(KeyType type, const std::string& key, const char* value, size_t len, bool copy, gqlite_node& node);
+  void convert_edge(const std::string& key, const char* value, size_t len, bool copy, gqlite_node& node);
   // convert obj to display type
   void beautify(nlohmann::json& input);
 
@@ -22,4 +51,23 @@ private:
   GScanPlan* _scan;
   gqlite_callback _cb;
   void* _handle;
+
+  /**
+   * rows of a page are allocated from arena, which is reset after page is returned.
+   */
+  GArena _arena;
+  gqlite_node* _page;
+  uint32_t _pageCount;
+  /**
+   * rows refer to stored values in zero-copy mode.
+   */
+  bool _zeroCopy;
+  bool _columnar;
+  GColumnBuilder _columns;
+  /**
+   * last page of columns. It is released when next page is built, unless consumer moved it.
+   */
+  struct ArrowSchema _schema;
+  struct ArrowArray _array;
+  gqlite_columns _pageColumns;
 };
@@ -7,8 +7,28 @@
 #include <thread>
 #include <vector>
 #include <stack>
+#include <set>
 #include "base/lang/visitor/IVisitor.h"
 #include "base/system/Observer.h"
+#include "plan/query/PredicateProgram.h"
+#include "plan/query/TopK.h"
+#include "plan/query/Aggregator.h"
+#include "plan/query/Optimizer.h"
+#include "plan/query/HashJoin.h"
+
+/**
+ * A group which has more rows than this is scanned by many workers.
+ */
+#define SCAN_PARALLEL_MIN_ROWS  (1 << 15)
+/**
+ * Every worker scans this count of rows at least.
+ */
+#define SCAN_PARTITION_ROWS     (1 << 14)
+#define SCAN_QUEUE_SIZE         1024
+/**
+ * Count of rows that compiled predicates evaluate a time.
+ */
+#define SCAN_BATCH_SIZE         256
 
 class GQueryStmt;
 struct GListNode;
@@ -45,13 +65,135 @@ public:
   void goon();
   void stop();
 
+  /**
+   * @brief get condition of query if query is only a comparation of one attribute.
+   */
+  bool getCondition(AttributeCondition& condition) const;
+
+  /**
+   * @brief query is an aggregate, such as `[count(g), avg(g.rating)]`.
+   *        Rows are aggregated when plan is executed, and no row is returned by callback.
+   */
+  bool isAggregate() const { return _aggregates.size() != 0; }
+  /**
+   * @brief rows of aggregate result, every group is a row.
+   */
+  std::vector<nlohmann::json> aggregates() const;
+  /**
+   * @brief count of rows that query may return. It is known after plan is prepared.
+   */
+  size_t estimateRows() const;
+
+  /**
+   * @brief rows that are not changed by plan are also returned as stored bytes by `raw`,
+   *        and they are not decoded if no predicate reads them.
+   */
+  void setRaw(bool enable) { _rawEnable = enable; }
+  /**
+   * @brief stored bytes of the row in callback. It is empty if row is built by plan.
+   *        It refers to a page of database, so it is valid in current transaction only.
+   */
+  const mdbx::slice& raw() const { return _raw; }
+
   //std::vector<std::string> groups() { return _queries; }
 protected:
   int scan(const std::function<ExecuteStatus(KeyType, const std::string& key, nlohmann::json& value, int status)>& cb);
   // scan indexes
   int scan();
+  /**
+   * @brief scan covering index only. Row is built from the attributes stored in index,
+   *        so that the group map is not read.
+   */
+  int scanCovering(const std::function<ExecuteStatus(KeyType, const std::string& key, nlohmann::json& value, int status)>& cb);
+
+  /**
+   * @brief choose a covering index which contains all attributes of projection and predicates.
+   * 
+   * @return index name, or empty if no covering index can be used
+   */
+  std::string chooseCoveringIndex();
+  bool predictCovering(const nlohmann::json& row);
+
+  /**
+   * @brief read postings of indexes in `_access`, then rows are read by their keys.
+   *        Postings of many indexes are intersected.
+   */
+  int scanIndex(const std::function<ExecuteStatus(KeyType, const std::string& key, nlohmann::json& value, int status)>& cb);
+  /**
+   * @brief row keys of index's postings in range of conditions. Keys are sorted by bytes.
+   */
+  std::vector<std::string> readPostings(const std::string& index);
+  /**
+   * @brief choose the cheapest access path of group with statistics of indexes.
+   */
+  AccessPath chooseAccessPath();
+
+  /**
+   * @brief scan buckets of time range, then rows are read by their keys.
+   */
+  int scanBucket(const std::function<ExecuteStatus(KeyType, const std::string& key, nlohmann::json& value, int status)>& cb);
+  /**
+   * @brief choose a bucket index whose attribute is compared with a time.
+   *
+   * @return index name, or empty if no bucket index can be used
+   */
+  std::string chooseBucketIndex();
+
+  /**
+   * @brief count of workers that scan group. 1 means group is scanned serially.
+   */
+  size_t parallelism(const std::string& group);
+  /**
+   * @brief split key space of group to ranges which have nearly the same count of rows.
+   *        Boundaries are searched with estimate of cursors.
+   *
+   * @return lower bounds of ranges except the first one
+   */
+  std::vector<std::string> partition(const std::string& group, size_t parts);
+  /**
+   * @brief every range is scanned by a worker with its own read transaction and GVM.
+   *        Rows are merged through a bounded queue into callback on current thread,
+   *        so they are not ordered by key.
+   * @return first error of workers. Other workers stop, so rows of scan are not complete.
+   */
+  int scanParallel(const std::string& group, size_t workers, const std::function<ExecuteStatus(KeyType, const std::string& key, nlohmann::json& value, int status)>& cb);
+
+  /**
+   * @brief collect attributes that projection and predicates use.
+   */
+  void initDecodes();
+  /**
+   * @brief parse a stored row. Only attributes in `_decodes` are parsed by a lazy view of row.
+   *        If the view can't index row, others are dropped when the whole row is parsed.
+   */
+  nlohmann::json decode(const mdbx::slice& value) const;
+  /**
+   * @brief keep attributes of projection only, so that they are serialized to result.
+   */
+  void project(KeyType type, nlohmann::json& row) const;
+
+  /**
+   * @brief parse options of query, such as `limit` and `skip`.
+   */
+  void parseOptions(GListNode* options);
+  /**
+   * @brief count of rows that an ordered query keeps.
+   */
+  size_t topK() const;
+  /**
+   * @brief rows are read in order when the covering index of order attribute is scanned ascendingly.
+   */
+  bool isIndexOrdered() const;
 
   void parseGroup(GListNode* query);
+  /**
+   * @brief parse an aggregate function, such as `count(g)` or `avg(g.rating)`.
+   */
+  void parseAggregate(GListNode* call);
+  /**
+   * @brief aggregate rows of groups. An unfiltered count is read from statistics of group.
+   */
+  int aggregate();
   /**
    * parse condition node, retrieve simple condition/graph pattern or other kind of condition
    */
@@ -62,9 +204,22 @@ protected:
   bool stopExit();
 
   gkey_t getKey(KeyType type, mdbx::slice& slice);
-  bool predict(KeyType type, gkey_t key, nlohmann::json& row);
+  /**
+   * @param gvm virtual machine that run lambda of query. If it is null, `_gvm` is used.
+   */
+  bool predict(KeyType type, gkey_t key, nlohmann::json& row, GVM* gvm = nullptr);
   bool predictEdge(gkey_t key, nlohmann::json& row);
-  bool predictVertex(gkey_t key, nlohmann::json& row);
+  /**
+   * @brief endpoints of edge pattern that filter vertexes, such as `[{genres: 'Horror'}, ->, *]`,
+   *        are scanned by sub plans of endpoint's group.
+   */
+  void initJoins(GContext* context);
+  /**
+   * @brief matched vertexes of every endpoint are built into a hash join before edges are scanned.
+   */
+  void buildJoins(GVM* gvm);
+  const GHashJoin* getJoin(EntityNode* node) const;
+  bool predictVertex(gkey_t key, nlohmann::json& row, GVM* gvm = nullptr);
   bool predict(const std::function<bool(const attribute_t&)>& op, const nlohmann::json& attr)const;
 
   void initQueryGroups(const std::string& group);
@@ -130,6 +285,64 @@ protected:
 
   std::string _graph;
   std::string _group;
+  /**
+   * attributes of group that query return, such as `class` in `[g.class]`.
+   * It is empty if all attributes are required.
+   */
+  std::vector<std::string> _projection;
+  /**
+   * attributes that are decoded from stored row. It is empty if all attributes are required.
+   */
+  std::set<std::string> _decodes;
+  bool _rawEnable = false;
+  mdbx::slice _raw;
+  /**
+   * predicates of vertexes compiled when plan is prepared.
+   */
+  GPredicateProgram _program;
+  /**
+   * count of rows that query returns at most, and count of matched rows that are skipped before them.
+   * Scan stops when `_limit` rows are returned.
+   */
+  size_t _limit;
+  size_t _skip;
+  size_t _skipped;
+  size_t _produced;
+  /**
+   * attribute that rows are ordered by. Only the first `_skip + _limit` rows are kept in a heap.
+   */
+  std::string _order;
+  bool _descend;
+  /**
+   * aggregate functions of query and attribute that rows are grouped by.
+   */
+  std::vector<AggregateSpec> _aggregates;
+  std::string _groupBy;
+  /**
+   * rows are aggregated by it when plan is executed.
+   */
+  GAggregator* _aggregator;
+  /**
+   * covering index that used by scan. If it is empty, group is scanned.
+   */
+  std::string _coverIndex;
+  /**
+   * bucket index that used by scan when covering index is not used.
+   */
+  std::string _bucketIndex;
+  /**
+   * access path that chosen by optimizer.
+   */
+  AccessPath _access;
+  /**
+   * hash joins of endpoints that filter vertexes. Edges are probed by them when scanned.
+   */
+  struct EdgeJoin {
+    EntityNode* _node;
+    GScanPlan* _plan;
+    GHashJoin _join;
+  };
+  std::vector<EdgeJoin> _joins;
   
   std::vector<IObserver*> _observers;
   /**
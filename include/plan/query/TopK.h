@@ -0,0 +1,111 @@
+#pragma once
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "json.hpp"
+#include "base/type.h"
+
+enum class KeyType: uint8_t;
+
+/**
+ * @brief Keep the first k rows ordered by an attribute with a bounded binary heap.
+ *        The last row of the k rows is on the top of heap, so that a new row only
+ *        compares with it. Rows without a comparable attribute are ordered last.
+ */
+class GTopK {
+public:
+  struct Row {
+    KeyType _type;
+    std::string _key;
+    nlohmann::json _value;
+    /** 0: number, 1: string, 2: not comparable */
+    int _kind;
+    double _number;
+    std::string _string;
+    /** order of arrival, so that rows with same value keep their scan order */
+    size_t _sequence;
+  };
+
+  GTopK(const std::string& attr, bool descend, size_t k)
+    :_attr(attr), _descend(descend), _k(k), _sequence(0) {}
+
+  void push(KeyType type, const std::string& key, nlohmann::json& value) {
+    if (_k == 0) return;
+    Row row{ type, key, nlohmann::json(), 2, 0, "", _sequence++ };
+    auto itr = value.find(_attr);
+    if (itr != value.end()) {
+      const nlohmann::json& attr = *itr;
+      if (attr.is_number()) {
+        row._kind = 0;
+        row._number = attr.get<double>();
+      }
+      else if (attr.is_string()) {
+        row._kind = 1;
+        row._string = attr.get<std::string>();
+      }
+      else if (attr.is_object() && attr.count(OBJECT_TYPE_NAME) &&
+        AttributeKind(attr[OBJECT_TYPE_NAME]) == AttributeKind::Datetime) {
+        row._kind = 0;
+        row._number = attr["value"].get<double>();
+      }
+    }
+    if (_rows.size() == _k && !before(row, _rows.front())) return;
+    row._value = std::move(value);
+    push(std::move(row));
+  }
+
+  /**
+   * @brief merge rows of another heap, such as a heap of parallel worker.
+   */
+  void merge(GTopK& other) {
+    for (auto& row : other._rows) {
+      if (_rows.size() == _k && !before(row, _rows.front())) continue;
+      row._sequence = _sequence++;
+      push(std::move(row));
+    }
+    other._rows.clear();
+  }
+
+  /**
+   * @brief get rows in order. Heap is empty after it.
+   */
+  std::vector<Row> sorted() {
+    std::vector<Row> rows(std::move(_rows));
+    _rows.clear();
+    std::sort(rows.begin(), rows.end(), [this](const Row& left, const Row& right) {
+      return before(left, right);
+      });
+    return rows;
+  }
+
+  size_t size() const { return _rows.size(); }
+
+private:
+  void push(Row&& row) {
+    auto cmp = [this](const Row& left, const Row& right) { return before(left, right); };
+    _rows.emplace_back(std::move(row));
+    std::push_heap(_rows.begin(), _rows.end(), cmp);
+    if (_rows.size() > _k) {
+      std::pop_heap(_rows.begin(), _rows.end(), cmp);
+      _rows.pop_back();
+    }
+  }
+
+  bool before(const Row& left, const Row& right) const {
+    if (left._kind != right._kind) return left._kind < right._kind;
+    if (left._kind == 0 && left._number != right._number) {
+      return _descend ? left._number > right._number : left._number < right._number;
+    }
+    if (left._kind == 1 && left._string != right._string) {
+      return _descend ? left._string > right._string : left._string < right._string;
+    }
+    return left._sequence < right._sequence;
+  }
+
+private:
+  std::string _attr;
+  bool _descend;
+  size_t _k;
+  size_t _sequence;
+  std::vector<Row> _rows;
+};
@@ -32,7 +32,7 @@ public:
         free( limit);
     }
 };
-using stack_allocator = simple_stack_allocator<8 * 1024 * 1024, 64 * 1024, 8 * 1024>;
+using stack_allocator = simple_stack_allocator<8 * 1024 * 1024, 256 * 1024, 8 * 1024>;
 
 
 class GDefaultSchedule: public GSchedule {
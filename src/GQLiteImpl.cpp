@@ -4,6 +4,7 @@
 #include "Error.h"
 #include "Memory.h"
 #include "StorageEngine.h"
+#include "Statement.h"
 #include "base/system/exception/CompileException.h"
 #ifdef _WIN32
 #include <io.h>
@@ -24,10 +25,14 @@ int yylex(YYSTYPE* yylval_param, YYLTYPE* yylloc_param, void* yyscanner, GVirtua
 
 GQLiteImpl::GQLiteImpl(GVirtualEngine* pEng)
   : _ve(pEng)
+  , _statements(STATEMENT_CACHE_SIZE)
 {}
 
 GQLiteImpl::~GQLiteImpl()
 {
+  for (GStatement* statement : _statements.clear()) {
+    delete statement;
+  }
   this->close();
   if (_ve) {
     delete _ve;
@@ -90,4 +95,42 @@ void GQLiteImpl::exec(GVirtualEngine& stm)
   }
   
   yylex_destroy(scanner);
-}
\ No newline at end of file
+}
+
+int GQLiteImpl::prepare(const char* gql, bool cached, GStatement*& statement)
+{
+  std::string key;
+  if (cached) {
+    key = GStatement::normalize(gql);
+    if (_statements.take(key, statement)) return ECode_Success;
+  }
+  statement = new GStatement(_ve);
+  _ve->_errIndx = 0;
+  _ve->_gql = gql;
+  _ve->_errorCode = 0;
+  _ve->_statement = statement;
+  exec(*_ve);
+  _ve->_statement = nullptr;
+  if (_ve->_errorCode != ECode_Success) {
+    delete statement;
+    statement = nullptr;
+    return _ve->_errorCode;
+  }
+  statement->setKey(key);
+  return ECode_Success;
+}
+
+void GQLiteImpl::finalize(GStatement* statement)
+{
+  if (!statement) return;
+  if (statement->key().empty()) {
+    delete statement;
+    return;
+  }
+  statement->finalize();
+  std::vector<GStatement*> evicted;
+  _statements.put(statement->key(), statement, evicted);
+  for (GStatement* item : evicted) {
+    delete item;
+  }
+}
@@ -0,0 +1,366 @@
+#include "Statement.h"
+#include <cctype>
+#include <cstring>
+#include <limits>
+#include "VirtualEngine.h"
+#include "StorageEngine.h"
+#include "base/lang/ASTNode.h"
+#include "base/lang/LiteralNumber.h"
+#include "base/lang/LiteralString.h"
+#include "schedule/DefaultSchedule.h"
+
+namespace {
+  char* copy_string(const char* str) {
+    if (!str) return nullptr;
+    size_t len = strlen(str) + 1;
+    char* dst = new char[len];
+    memcpy(dst, str, len);
+    return dst;
+  }
+
+  // properties may refer to stored values, which are not ended with '\0'
+  char* copy_bytes(const char* data, size_t len) {
+    if (!data) return nullptr;
+    char* dst = new char[len + 1];
+    memcpy(dst, data, len);
+    dst[len] = '\0';
+    return dst;
+  }
+
+  gqlite_vertex* copy_vertex(const gqlite_vertex* vertex) {
+    gqlite_vertex* dst = new gqlite_vertex;
+    dst->type = vertex->type;
+    if (vertex->type == gqlite_id_type::bytes) dst->cid = copy_string(vertex->cid);
+    else dst->uid = vertex->uid;
+    dst->properties = copy_bytes(vertex->properties, vertex->len);
+    dst->len = dst->properties ? vertex->len : 0;
+    return dst;
+  }
+
+  void release_vertex(gqlite_vertex* vertex) {
+    if (vertex->type == gqlite_id_type::bytes) delete[] vertex->cid;
+    delete[] vertex->properties;
+    delete vertex;
+  }
+}
+
+gqlite_result* GStatement::copyResult(const gqlite_result* result)
+{
+  if (result->type == gqlite_result_type_column) return nullptr;
+  gqlite_result* dst = new gqlite_result(*result);
+  if (result->type == gqlite_result_type_node) {
+    gqlite_node** tail = &dst->nodes;
+    for (gqlite_node* node = result->nodes; node; node = node->_next) {
+      gqlite_node* copy = new gqlite_node;
+      copy->_type = node->_type;
+      copy->_next = nullptr;
+      if (node->_type == gqlite_node_type_vertex) {
+        copy->_vertex = copy_vertex(node->_vertex);
+      }
+      else {
+        copy->_edge = new gqlite_edge;
+        copy->_edge->from = copy_vertex(node->_edge->from);
+        copy->_edge->to = copy_vertex(node->_edge->to);
+        copy->_edge->direction = node->_edge->direction;
+        copy->_edge->properties = copy_bytes(node->_edge->properties, node->_edge->len);
+        copy->_edge->len = copy->_edge->properties ? node->_edge->len : 0;
+      }
+      *tail = copy;
+      tail = &copy->_next;
+    }
+    *tail = nullptr;
+  }
+  else {
+    dst->infos = new char*[result->count];
+    for (uint32_t idx = 0; idx < result->count; ++idx) {
+      dst->infos[idx] = copy_string(result->infos[idx]);
+    }
+  }
+  return dst;
+}
+
+void GStatement::releaseResult(gqlite_result* result)
+{
+  if (!result) return;
+  if (result->type == gqlite_result_type_node) {
+    gqlite_node* node = result->nodes;
+    while (node) {
+      gqlite_node* next = node->_next;
+      if (node->_type == gqlite_node_type_vertex) {
+        release_vertex(node->_vertex);
+      }
+      else {
+        release_vertex(node->_edge->from);
+        release_vertex(node->_edge->to);
+        delete[] node->_edge->properties;
+        delete node->_edge;
+      }
+      delete node;
+      node = next;
+    }
+  }
+  else {
+    for (uint32_t idx = 0; idx < result->count; ++idx) {
+      delete[] result->infos[idx];
+    }
+    delete[] result->infos;
+  }
+  delete result;
+}
+
+GStatement::GStatement(GVirtualEngine* engine)
+:_engine(engine)
+,_schedule(nullptr)
+,_coroutine(nullptr)
+,_current(nullptr)
+,_view(nullptr)
+,_columns(nullptr)
+,_zeroCopy(false)
+,_columnar(false)
+,_prefetch(STATEMENT_PREFETCH_SIZE)
+,_cancel(false)
+,_errorCode(ECode_Success)
+{
+}
+
+GStatement::~GStatement()
+{
+  finalize();
+  for (GListNode* ast : _asts) {
+    FreeNode(ast);
+  }
+}
+
+void GStatement::keep(GListNode* ast)
+{
+  _asts.push_back(ast);
+}
+
+void GStatement::addParameter(int index, GListNode* node)
+{
+  _parameters[index]._nodes.push_back(node);
+}
+
+int GStatement::bind(int index, int64_t value)
+{
+  return bind(index, [value]() -> GLiteral* {
+    if (value >= std::numeric_limits<int>::min() && value <= std::numeric_limits<int>::max()) {
+      int v = (int)value;
+      return new GLiteralNumber<int>(v);
+    }
+    long v = (long)value;
+    return new GLiteralNumber<long>(v);
+  });
+}
+
+int GStatement::bind(int index, double value)
+{
+  return bind(index, [value]() -> GLiteral* {
+    double v = value;
+    return new GLiteralNumber<double>(v);
+  });
+}
+
+int GStatement::bind(int index, const char* text, size_t len)
+{
+  if (!text) return ECODE_NULL_PTR;
+  std::string str(text, len);
+  return bind(index, [&str]() -> GLiteral* {
+    return new GLiteralString(str.c_str(), str.size());
+  });
+}
+
+int GStatement::bind(int index, const std::function<GLiteral*()>& make)
+{
+  auto itr = _parameters.find(index);
+  if (itr == _parameters.end()) return ECode_GQL_Parameter_Not_Exist;
+  // plans of a suspended statement may refer to old value
+  finalize();
+  for (GListNode* node : itr->second._nodes) {
+    delete (GLiteral*)node->_value;
+    node->_value = make();
+  }
+  itr->second._bound = true;
+  return ECode_Success;
+}
+
+std::string GStatement::normalize(const char* gql)
+{
+  std::string text;
+  char quote = 0;
+  bool blank = false;
+  for (const char* c = gql; *c; ++c) {
+    if (quote) {
+      text.push_back(*c);
+      if (*c == '\\' && *(c + 1)) text.push_back(*++c);
+      else if (*c == quote) quote = 0;
+      continue;
+    }
+    if (isspace((unsigned char)*c)) {
+      blank = true;
+      continue;
+    }
+    if (blank && !text.empty()) text.push_back(' ');
+    blank = false;
+    if (*c == '\'' || *c == '"') quote = *c;
+    text.push_back(*c);
+  }
+  return text;
+}
+
+int GStatement::execute()
+{
+  finalize();
+  for (auto& item : _parameters) {
+    if (!item.second._bound) return ECode_GQL_Parameter_Not_Bound;
+  }
+  _cancel = false;
+  _errorCode = ECode_Success;
+  _schedule = new GDefaultSchedule(_engine);
+  _coroutine = _schedule->addCoroutine([this](GCoroutine*) { run(); });
+  _coroutine->resume();
+  return _errorCode;
+}
+
+int GStatement::next(gqlite_result** result)
+{
+  releaseResult(_current);
+  _current = nullptr;
+  *result = nullptr;
+  if (!_view && !_columns && _results.empty() && _coroutine && _coroutine->status() != GWorker::Status::Finish) {
+    _coroutine->resume();
+  }
+  if (_columns) {
+    *result = _columns;
+    _columns = nullptr;
+    return ECode_Success;
+  }
+  if (_view) {
+    // row refers to page of plans, which is valid until coroutine is resumed
+    _viewNode = *_view;
+    _viewNode._next = nullptr;
+    _viewResult.nodes = &_viewNode;
+    _viewResult.count = 1;
+    _viewResult.type = gqlite_result_type_node;
+    _viewResult.errcode = ECode_Success;
+    _view = _view->_next;
+    *result = &_viewResult;
+    return ECode_Success;
+  }
+  if (_results.empty()) {
+    return _errorCode == ECode_Success ? ECode_Query_Stop : _errorCode;
+  }
+  _current = _results.front();
+  _results.pop_front();
+  *result = _current;
+  return ECode_Success;
+}
+
+void GStatement::finalize()
+{
+  _view = nullptr;
+  _columns = nullptr;
+  if (_coroutine) {
+    // suspended plans see the cancel flag and stop
+    _cancel = true;
+    while (_coroutine->status() != GWorker::Status::Finish) {
+      _coroutine->resume();
+    }
+  }
+  // coroutine is released with its schedule
+  delete _schedule;
+  _schedule = nullptr;
+  _coroutine = nullptr;
+  clearResults();
+}
+
+int GStatement::collect(gqlite_result* result, void* handle)
+{
+  GStatement* statement = (GStatement*)handle;
+  if (statement->_cancel) return ECode_Query_Stop;
+  if (statement->_zeroCopy || result->type == gqlite_result_type_column) {
+    // rows are pulled from page directly, so plans wait until all of them are pulled
+    if (result->type == gqlite_result_type_node) statement->_view = result->nodes;
+    else if (result->type == gqlite_result_type_column) statement->_columns = result;
+    else statement->_results.push_back(copyResult(result));
+    // rows refer to pages of transaction, so writes are rejected until they are pulled
+    bool view = statement->_zeroCopy && result->type == gqlite_result_type_node;
+    GStorageEngine* store = statement->_engine->storage();
+    if (view && store) store->pinView();
+    statement->suspend();
+    if (view && store) store->unpinView();
+    return statement->_cancel ? ECode_Query_Stop : ECode_Success;
+  }
+  if (result->type == gqlite_result_type_node) {
+    // a page of rows is split, so that rows are pulled one by one
+    for (gqlite_node* node = result->nodes; node; node = node->_next) {
+      gqlite_node single = *node;
+      single._next = nullptr;
+      gqlite_result row = *result;
+      row.nodes = &single;
+      row.count = 1;
+      statement->_results.push_back(copyResult(&row));
+    }
+  }
+  else {
+    statement->_results.push_back(copyResult(result));
+  }
+  if (statement->_results.size() >= statement->_prefetch) {
+    statement->yield();
+  }
+  return statement->_cancel ? ECode_Query_Stop : ECode_Success;
+}
+
+void GStatement::run()
+{
+  // an exception can't be thrown out of coroutine
+  try {
+    for (GListNode* ast : _asts) {
+      if (_cancel) break;
+      // engine may run other gql when statement is suspended, so callback is set for every AST
+      _engine->_result_callback = &GStatement::collect;
+      _engine->_handle = this;
+      _engine->_errorCode = ECode_Success;
+      _engine->_zeroCopy = _zeroCopy;
+      _engine->_columnar = _columnar;
+      _errorCode = _engine->execAST(ast);
+      if (_errorCode != ECode_Success) break;
+    }
+  }
+  catch (...) {
+    _errorCode = ECode_Fail;
+  }
+  _engine->_zeroCopy = false;
+  _engine->_columnar = false;
+}
+
+void GStatement::suspend()
+{
+  // other gql that runs before next pull returns results as usual
+  _engine->_zeroCopy = false;
+  _engine->_columnar = false;
+  yield();
+  _engine->_zeroCopy = _zeroCopy;
+  _engine->_columnar = _columnar;
+  _view = nullptr;
+  _columns = nullptr;
+}
+
+void GStatement::yield()
+{
+  // cursors of plans are kept in transaction of session, so it is not committed until plans are resumed
+  GStorageEngine* store = _engine->storage();
+  if (store) store->pinTrans();
+  _coroutine->yield();
+  if (store) store->unpinTrans();
+}
+
+void GStatement::clearResults()
+{
+  releaseResult(_current);
+  _current = nullptr;
+  for (gqlite_result* result : _results) {
+    releaseResult(result);
+  }
+  _results.clear();
+}
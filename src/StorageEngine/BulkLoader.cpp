@@ -0,0 +1,141 @@
+#include "BulkLoader.h"
+#include "IndexBuilder.h"
+#include "gutil.h"
+
+GBulkLoader::GBulkLoader(GStorageEngine* store, const std::string& group)
+:_store(store)
+,_group(group)
+,_writer(store, group)
+,_empty(true)
+,_rows(0)
+,_started(false)
+{
+}
+
+GBulkLoader::~GBulkLoader()
+{
+  // indexes should not be left as building
+  end();
+}
+
+int GBulkLoader::begin()
+{
+  if (!_store->isMapExist(_group)) return ECode_Group_Not_Exist;
+  if (_store->isViewPinned()) return ECode_TRANSTION_Busy;
+  KeyType type = _store->getKeyType(_group);
+  _empty = (type != KeyType::Integer && type != KeyType::Byte && type != KeyType::Edge) || _store->count(_group) == 0;
+  // an index which is building is built again, because its mark may be after keys of loaded rows
+  for (auto& index : _writer.indexes()) {
+    _store->setIndexBuildMark(index, "");
+    _indexes.emplace_back(index);
+  }
+  _rows = 0;
+  _started = true;
+  return ECode_Success;
+}
+
+int GBulkLoader::addVertex(const gkey_t& key, const nlohmann::json& row)
+{
+  if (!_started) return ECode_Fail;
+  if (_store->isViewPinned()) return ECode_TRANSTION_Busy;
+  KeyType type = _store->getKeyType(_group);
+  if (type == KeyType::Edge) return ECode_GQL_Type_Not_Match;
+  try {
+    int ret = key.visit(
+      [&](std::string k) {
+        if (type == KeyType::Integer) return ECode_GQL_Type_Not_Match;
+        std::string old;
+        // postings of old row are removed, and new row is indexed when loading ends
+        if (!_empty && _indexes.size() && _store->read(_group, k, old) == ECode_Success && old != "null") {
+          _writer.remove(key, nlohmann::json::parse(old));
+        }
+        return _store->write(_group, k, row);
+      },
+      [&](uint64_t k) {
+        if (type == KeyType::Byte) return ECode_GQL_Type_Not_Match;
+        std::string old;
+        if (!_empty && _indexes.size() && _store->read(_group, k, old) == ECode_Success && old != "null") {
+          _writer.remove(key, nlohmann::json::parse(old));
+        }
+        return _store->write(_group, k, row);
+      });
+    if (ret != ECode_Success) return ret;
+  }
+  catch (const std::exception&) {
+    return ECode_Fail;
+  }
+  if (++_rows % BULK_COMMIT_ROWS == 0) return commit();
+  return ECode_Success;
+}
+
+int GBulkLoader::addEdge(const gkey_t& from, const gkey_t& to, bool direction, const nlohmann::json& row)
+{
+  gql::edge_id eid = gql::make_edge_id(direction, from, to);
+  std::string key = gql::to_string(eid);
+  gql::release_edge_id(eid);
+  return addEdge(key, row);
+}
+
+int GBulkLoader::addEdge(const std::string& key, const nlohmann::json& row)
+{
+  if (!_started) return ECode_Fail;
+  if (_store->isViewPinned()) return ECode_TRANSTION_Busy;
+  KeyType type = _store->getKeyType(_group);
+  if (type == KeyType::Integer || type == KeyType::Byte) return ECode_GQL_Type_Not_Match;
+  _store->tryInitKeyType(_group, KeyType::Edge);
+  std::string data = row.dump();
+  int ret = _store->write(_group, key, (void*)data.data(), data.size());
+  if (ret != ECode_Success) return ret;
+  if (++_rows % BULK_COMMIT_ROWS == 0) return commit();
+  return ECode_Success;
+}
+
+int GBulkLoader::end()
+{
+  if (!_started) return ECode_Success;
+  _started = false;
+  int ret = commit();
+  // indexes are left as building, and they are built by later gql
+  if (_store->isViewPinned()) {
+    _indexes.clear();
+    return ret;
+  }
+  // builder scans group in key order and commits every step
+  for (auto& index : _indexes) {
+    GIndexBuilder builder(_store, index);
+    while (!builder.step(BULK_INDEX_BATCH));
+  }
+  _indexes.clear();
+  return ret;
+}
+
+nlohmann::json GBulkLoader::toRow(const gqlite_field* fields, uint32_t count)
+{
+  nlohmann::json row;
+  for (uint32_t idx = 0; idx < count; ++idx) {
+    const gqlite_field& field = fields[idx];
+    if (!field.name) continue;
+    switch (field.type) {
+    case gqlite_field_int:
+      row[field.name] = field.integer;
+      break;
+    case gqlite_field_double:
+      row[field.name] = field.number;
+      break;
+    case gqlite_field_text:
+      if (field.text) row[field.name] = std::string(field.text, field.len);
+      break;
+    case gqlite_field_vector:
+      if (field.vector) row[field.name] = std::vector<double>(field.vector, field.vector + field.len);
+      break;
+    default:
+      break;
+    }
+  }
+  return row;
+}
+
+int GBulkLoader::commit()
+{
+  return _store->commitTrans();
+}
@@ -0,0 +1,317 @@
+#include "Importer.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <queue>
+#include <regex>
+#include <thread>
+#include "BulkLoader.h"
+#include "base/system/MappedFile.h"
+#include "gutil.h"
+
+namespace {
+  struct Field {
+    std::string _text;
+    bool _quoted = false;
+  };
+
+  // split by delimiter out of double quotes, and `""` in quotes is a quote
+  std::vector<Field> split_fields(const char* begin, const char* end, char delim) {
+    std::vector<Field> fields(1);
+    bool quote = false;
+    for (const char* c = begin; c < end; ++c) {
+      Field& field = fields.back();
+      if (quote) {
+        if (*c != '"') field._text.push_back(*c);
+        else if (c + 1 < end && *(c + 1) == '"') field._text.push_back(*++c);
+        else quote = false;
+      }
+      else if (*c == '"') {
+        quote = true;
+        field._quoted = true;
+        field._text.clear();
+      }
+      else if (*c == delim) fields.emplace_back();
+      else if (!field._quoted && (*c != ' ' || field._text.size())) field._text.push_back(*c);
+    }
+    for (auto& field : fields) {
+      if (field._quoted) continue;
+      field._text.erase(field._text.find_last_not_of(' ') + 1);
+    }
+    return fields;
+  }
+
+  bool is_digits(const std::string& text) {
+    return text.size() && std::all_of(text.begin(), text.end(), [](char c) { return c >= '0' && c <= '9'; });
+  }
+
+  // an unquoted value is a number or boolean if it can be
+  nlohmann::json to_value(const Field& field) {
+    if (field._quoted) return field._text;
+    const std::string& text = field._text;
+    if (text.empty()) return nullptr;
+    const char* str = text.c_str();
+    char* stop = nullptr;
+    errno = 0;
+    long long integer = strtoll(str, &stop, 10);
+    if (errno == 0 && stop == str + text.size()) return (int64_t)integer;
+    double number = strtod(str, &stop);
+    if (stop == str + text.size()) return number;
+    if (text == "true") return true;
+    if (text == "false") return false;
+    return text;
+  }
+
+  gkey_t to_key(const std::string& id) {
+    gkey_t key;
+    if (is_digits(id)) key = (uint64_t)strtoull(id.c_str(), nullptr, 10);
+    else key = id;
+    return key;
+  }
+
+  bool ends_with(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+  }
+}
+
+GImporter::GImporter(GStorageEngine* store, const std::string& group, const std::vector<std::string>& mapping)
+:_store(store)
+,_group(group)
+,_mapping(mapping)
+,_format(Format::CSV)
+,_edge(false)
+,_integer(false)
+,_id(0)
+,_from(-1)
+,_to(-1)
+,_chunkSize(IMPORT_CHUNK_SIZE)
+,_rows(0)
+,_skipped(0)
+{
+}
+
+int GImporter::load(const std::string& path)
+{
+  if (!_store->isMapExist(_group)) return ECode_Group_Not_Exist;
+  GMappedFile file;
+  if (!file.open(path)) return ECode_DISK_OPEN_FAIL;
+  const char* begin = file.data();
+  const char* end = begin + file.size();
+  _format = ends_with(path, ".ngql") ? Format::NGQL : Format::CSV;
+  if (_format == Format::CSV) {
+    if (_mapping.empty() && begin != end) {
+      const char* line = std::find(begin, end, '\n');
+      const char* stop = (line != begin && *(line - 1) == '\r') ? line - 1 : line;
+      for (auto& field : split_fields(begin, stop, ',')) {
+        _mapping.emplace_back(field._text);
+      }
+      begin = (line == end) ? end : line + 1;
+    }
+    initColumns();
+  }
+  else {
+    std::string vertex = "insert vertex " + _group + "(";
+    std::string edge = "insert edge " + _group + "(";
+    _edge = std::search(begin, end, edge.begin(), edge.end()) < std::search(begin, end, vertex.begin(), vertex.end());
+  }
+  if (!_edge) {
+    KeyType type = _store->getKeyType(_group);
+    if (type == KeyType::Edge) return ECode_GQL_Type_Not_Match;
+    // type of new group is decided by the first id
+    _integer = (type == KeyType::Integer);
+    if (type == KeyType::Uninitialize) {
+      for (const char* line = begin; line < end;) {
+        const char* stop = std::find(line, end, '\n');
+        Row row;
+        if (parseLine(line, stop, row)) {
+          _integer = is_digits(row._key);
+          break;
+        }
+        line = (stop == end) ? end : stop + 1;
+      }
+    }
+  }
+
+  GBulkLoader loader(_store, _group);
+  int ret = loader.begin();
+  if (ret != ECode_Success) return ret;
+  size_t threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+  while (begin < end && ret == ECode_Success) {
+    // a round has a chunk for every thread, and a chunk ends at line break
+    std::vector<std::pair<const char*, const char*>> bounds;
+    while (bounds.size() < threads && begin < end) {
+      const char* stop = ((size_t)(end - begin) > _chunkSize) ? begin + _chunkSize : end;
+      stop = std::find(stop, end, '\n');
+      if (stop != end) ++stop;
+      bounds.emplace_back(begin, stop);
+      begin = stop;
+    }
+    std::vector<Chunk> chunks(bounds.size());
+    std::vector<size_t> skipped(bounds.size(), 0);
+    std::vector<std::thread> workers;
+    for (size_t idx = 1; idx < bounds.size(); ++idx) {
+      workers.emplace_back([&, idx]() { parse(bounds[idx].first, bounds[idx].second, chunks[idx], skipped[idx]); });
+    }
+    parse(bounds[0].first, bounds[0].second, chunks[0], skipped[0]);
+    for (auto& worker : workers) {
+      worker.join();
+    }
+    for (size_t count : skipped) {
+      _skipped += count;
+    }
+    ret = write(loader, chunks);
+  }
+  int last = loader.end();
+  return ret != ECode_Success ? ret : last;
+}
+
+void GImporter::initColumns()
+{
+  auto find = [this](const std::string& name) {
+    auto itr = std::find(_mapping.begin(), _mapping.end(), name);
+    return itr == _mapping.end() ? -1 : (int)(itr - _mapping.begin());
+  };
+  _id = find("id");
+  _from = find("from");
+  _to = find("to");
+  _edge = (_from >= 0 && _to >= 0);
+  if (_edge || _id >= 0) return;
+  _id = 0;
+  if (_mapping.size()) _mapping[0] = "id";
+}
+
+void GImporter::parse(const char* begin, const char* end, Chunk& chunk, size_t& skipped) const
+{
+  for (const char* line = begin; line < end;) {
+    const char* stop = std::find(line, end, '\n');
+    const char* last = (stop != line && *(stop - 1) == '\r') ? stop - 1 : stop;
+    if (last != line) {
+      Row row;
+      if (parseLine(line, last, row)) chunk.emplace_back(std::move(row));
+      else if (_format == Format::CSV) ++skipped;
+    }
+    line = (stop == end) ? end : stop + 1;
+  }
+  // later row of a key is written later, so it is kept
+  std::stable_sort(chunk.begin(), chunk.end(), [this](const Row& left, const Row& right) {
+    return less(left, right);
+  });
+}
+
+bool GImporter::parseLine(const char* begin, const char* end, Row& row) const
+{
+  try {
+    if (_format == Format::CSV) return parseCSV(begin, end, row);
+    return parseNGQL(begin, end, row);
+  }
+  catch (const std::exception&) {
+    return false;
+  }
+}
+
+bool GImporter::parseCSV(const char* begin, const char* end, Row& row) const
+{
+  std::vector<Field> fields = split_fields(begin, end, ',');
+  if (_edge) {
+    if ((int)fields.size() <= std::max(_from, _to)) return false;
+    setEdge(fields[_from]._text, fields[_to]._text, "->", row);
+  }
+  else {
+    if ((int)fields.size() <= _id || !setVertex(fields[_id]._text, row)) return false;
+  }
+  for (size_t idx = 0; idx < fields.size() && idx < _mapping.size(); ++idx) {
+    if ((int)idx == _id || (int)idx == _from || (int)idx == _to || _mapping[idx].empty()) continue;
+    nlohmann::json value = to_value(fields[idx]);
+    if (!value.is_null()) row._value[_mapping[idx]] = value;
+  }
+  return true;
+}
+
+bool GImporter::parseNGQL(const char* begin, const char* end, Row& row) const
+{
+  while (begin < end && *begin == ' ') ++begin;
+  static const std::string prefix("insert ");
+  if ((size_t)(end - begin) < prefix.size() || !std::equal(prefix.begin(), prefix.end(), begin)) return false;
+  static const std::regex vertex(R"(insert vertex (\w+)\(([\w, ]*)\) values \"(\w+)\":\(([\w\W]*)\);\s*)");
+  static const std::regex edge(R"(insert edge (\w+)\(([\w, ]*)\) values \"(\w+)\"([-><]+)\"(\w+)\"[@\w]*:\(([\w\W]*)\);\s*)");
+  std::cmatch m;
+  std::string props, values;
+  if (!_edge && std::regex_match(begin, end, m, vertex)) {
+    if (m[1] != _group || !setVertex(m[3], row)) return false;
+    props = m[2];
+    values = m[4];
+  }
+  else if (_edge && std::regex_match(begin, end, m, edge)) {
+    if (m[1] != _group) return false;
+    setEdge(m[3], m[5], m[4], row);
+    props = m[2];
+    values = m[6];
+  }
+  else return false;
+  std::vector<Field> names = split_fields(props.data(), props.data() + props.size(), ',');
+  std::vector<Field> fields = split_fields(values.data(), values.data() + values.size(), ',');
+  for (size_t idx = 0; idx < names.size() && idx < fields.size(); ++idx) {
+    if (names[idx]._text.empty()) continue;
+    nlohmann::json value = to_value(fields[idx]);
+    if (!value.is_null()) row._value[names[idx]._text] = value;
+  }
+  return true;
+}
+
+bool GImporter::setVertex(const std::string& id, Row& row) const
+{
+  if (id.empty()) return false;
+  if (!_integer) {
+    row._key = id;
+    return true;
+  }
+  if (!is_digits(id)) return false;
+  row._uid = strtoull(id.c_str(), nullptr, 10);
+  return true;
+}
+
+void GImporter::setEdge(const std::string& from, const std::string& to, const std::string& direction, Row& row) const
+{
+  gql::edge_id eid;
+  if (direction == "->") eid = gql::make_edge_id(true, to_key(from), to_key(to));
+  else if (direction == "<-") eid = gql::make_edge_id(true, to_key(to), to_key(from));
+  else eid = gql::make_edge_id(false, to_key(from), to_key(to));
+  row._key = gql::to_string(eid);
+  gql::release_edge_id(eid);
+}
+
+bool GImporter::less(const Row& left, const Row& right) const
+{
+  if (!_edge && _integer) return left._uid < right._uid;
+  return left._key < right._key;
+}
+
+int GImporter::write(GBulkLoader& loader, std::vector<Chunk>& chunks)
+{
+  // heads of chunks. Same keys are written in order of chunks, so the last one is kept
+  auto greater = [&](const std::pair<size_t, size_t>& left, const std::pair<size_t, size_t>& right) {
+    const Row& l = chunks[left.first][left.second];
+    const Row& r = chunks[right.first][right.second];
+    if (less(l, r)) return false;
+    if (less(r, l)) return true;
+    return left.first > right.first;
+  };
+  std::priority_queue<std::pair<size_t, size_t>, std::vector<std::pair<size_t, size_t>>, decltype(greater)> heads(greater);
+  for (size_t idx = 0; idx < chunks.size(); ++idx) {
+    if (chunks[idx].size()) heads.push({ idx, 0 });
+  }
+  while (heads.size()) {
+    auto head = heads.top();
+    heads.pop();
+    Row& row = chunks[head.first][head.second];
+    int ret;
+    if (_edge) ret = loader.addEdge(row._key, row._value);
+    else if (_integer) ret = loader.addVertex(row._uid, row._value);
+    else ret = loader.addVertex(row._key, row._value);
+    if (ret == ECode_GQL_Type_Not_Match) ++_skipped;
+    else if (ret != ECode_Success) return ret;
+    else ++_rows;
+    if (head.second + 1 < chunks[head.first].size()) heads.push({ head.first, head.second + 1 });
+  }
+  return ECode_Success;
+}
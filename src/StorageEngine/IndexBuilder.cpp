@@ -0,0 +1,98 @@
+#include "IndexBuilder.h"
+#include "gqlite.h"
+
+GIndexBuilder::GIndexBuilder(GStorageEngine* store, const std::string& index)
+:_store(store)
+,_index(index)
+,_group(index.substr(0, index.find(':')))
+,_writer(store, _group)
+{
+}
+
+void GIndexBuilder::start(GStorageEngine* store, const std::string& index)
+{
+  std::string group = index.substr(0, index.find(':'));
+  KeyType type = store->getKeyType(group);
+  // group has no row yet
+  if (type != KeyType::Integer && type != KeyType::Byte) return;
+  store->setIndexBuildMark(index, "");
+}
+
+bool GIndexBuilder::step(size_t batch)
+{
+  if (_store->isIndexReady(_index)) return true;
+  KeyType type = _store->getKeyType(_group);
+  if (!_store->isMapExist(_group) || (type != KeyType::Integer && type != KeyType::Byte)) {
+    _store->setIndexReady(_index);
+    return true;
+  }
+
+  bool finished = false;
+  {
+    std::string mark = _store->getIndexBuildMark(_index);
+    auto cursor = _store->getMapCursor(_group);
+    auto data = mark.empty() ? cursor.to_first(false) :
+      cursor.move(mdbx::cursor::key_lowerbound, mdbx::slice(mark.data(), mark.size()), false);
+    // skip the last indexed row
+    if (data && !mark.empty() && mark == std::string((char*)data.key.byte_ptr(), data.key.size())) {
+      data = cursor.to_next(false);
+    }
+    _writer.beginBatch();
+    size_t count = 0;
+    while (data && count < batch) {
+      std::string key((char*)data.key.byte_ptr(), data.key.size());
+      std::string value((char*)data.value.byte_ptr(), data.value.size());
+      if (value != "null") {
+        _writer.upset(_index, toKey(type, key), nlohmann::json::parse(value));
+      }
+      mark = key;
+      ++count;
+      data = cursor.to_next(false);
+    }
+    _writer.flush();
+    finished = !data;
+    if (!finished) _store->setIndexBuildMark(_index, mark);
+  }
+  if (finished) {
+    mergeLog();
+    _store->setIndexReady(_index);
+  }
+  _store->commitTrans();
+  return finished;
+}
+
+void GIndexBuilder::mergeLog()
+{
+  KeyType type = _store->getKeyType(_group);
+  {
+    auto cursor = _store->getIndexLogCursor(_index);
+    auto data = cursor.to_first(false);
+    _writer.beginBatch();
+    while (data) {
+      std::string key((char*)data.key.byte_ptr(), data.key.size());
+      gkey_t k = toKey(type, key);
+      std::string row;
+      int ret = (type == KeyType::Integer) ?
+        _store->read(_group, k.Get<uint64_t>(), row) : _store->read(_group, key, row);
+      // row may be removed after it is logged
+      if (ret == ECode_Success && row != "null") {
+        _writer.upset(_index, k, nlohmann::json::parse(row));
+      }
+      data = cursor.to_next(false);
+    }
+    _writer.flush();
+  }
+  _store->clearIndexLog(_index);
+}
+
+gkey_t GIndexBuilder::toKey(KeyType type, const std::string& key) const
+{
+  gkey_t k;
+  if (type == KeyType::Integer) {
+    k = *(uint64_t*)key.data();
+  }
+  else {
+    k = key;
+  }
+  return k;
+}
@@ -0,0 +1,398 @@
+#include "IndexWriter.h"
+#include "gqlite.h"
+#include "gutil.h"
+#include <algorithm>
+#include <cstring>
+#include <set>
+
+namespace {
+  std::string to_row_key(const gkey_t& key) {
+    return key.visit(
+      [](std::string id) { return id; },
+      [](uint64_t id) { return std::string((char*)&id, sizeof(uint64_t)); });
+  }
+}
+
+GIndexWriter::GIndexWriter(GStorageEngine* store, const std::string& group)
+:_store(store)
+,_group(group)
+,_batch(false)
+{
+  std::string prefix = _group + ":";
+  for (auto& index : _store->getIndexes()) {
+    if (index.compare(0, prefix.size(), prefix) == 0) {
+      _indexes.emplace_back(index);
+    }
+  }
+}
+
+std::string GIndexWriter::attribute(const std::string& index) const
+{
+  return index.substr(_group.size() + 1);
+}
+
+void GIndexWriter::exclude(const std::string& index)
+{
+  _indexes.erase(std::remove(_indexes.begin(), _indexes.end(), index), _indexes.end());
+}
+
+void GIndexWriter::beginBatch()
+{
+  _batch = true;
+}
+
+void GIndexWriter::flush()
+{
+  for (auto& index : _postings) {
+    for (auto& posting : index.second) {
+      mergePosting(index.first, posting.first, posting.second);
+    }
+  }
+  _postings.clear();
+  _batch = false;
+}
+
+int GIndexWriter::upset(const gkey_t& key, const nlohmann::json& row)
+{
+  for (auto& index : _indexes) {
+    if (!_store->isIndexReady(index)) {
+      // index is building, row will be indexed when side log is merged
+      logRow(index, key);
+      continue;
+    }
+    upset(index, key, row);
+  }
+  return ECode_Success;
+}
+
+int GIndexWriter::upset(const std::string& index, const gkey_t& key, const nlohmann::json& row)
+{
+  bool isBucket = _store->isBucketIndex(index);
+  for (auto& value : values(index, row)) {
+    if (isBucket) {
+      upsetBucket(index, value, key);
+      continue;
+    }
+    upsetPosting(index, value, key);
+    upsetCovering(index, value._cover, key, row);
+  }
+  return ECode_Success;
+}
+
+int GIndexWriter::update(const gkey_t& key, const nlohmann::json& oldRow, const nlohmann::json& newRow)
+{
+  std::string rowKey = to_row_key(key);
+  for (auto& index : _indexes) {
+    auto oldValues = values(index, oldRow);
+    auto newValues = values(index, newRow);
+    std::sort(oldValues.begin(), oldValues.end());
+    std::sort(newValues.begin(), newValues.end());
+    std::vector<IndexValue> removed, added;
+    std::set_difference(oldValues.begin(), oldValues.end(), newValues.begin(), newValues.end(), std::back_inserter(removed));
+    std::set_difference(newValues.begin(), newValues.end(), oldValues.begin(), oldValues.end(), std::back_inserter(added));
+    bool isBucket = _store->isBucketIndex(index);
+    for (auto& value : removed) {
+      if (isBucket) {
+        removeBucket(index, value, key);
+        continue;
+      }
+      removePosting(index, value._posting, key);
+      if (_store->isCoveringIndex(index)) _store->delCovering(index, value._cover, rowKey);
+    }
+    if (!_store->isIndexReady(index)) {
+      logRow(index, key);
+      continue;
+    }
+    for (auto& value : added) {
+      if (isBucket) upsetBucket(index, value, key);
+      else upsetPosting(index, value, key);
+    }
+    if (isBucket) continue;
+    // included attributes may be changed even if indexed value is not changed
+    for (auto& value : newValues) {
+      upsetCovering(index, value._cover, key, newRow);
+    }
+  }
+  return ECode_Success;
+}
+
+int GIndexWriter::remove(const gkey_t& key, const nlohmann::json& row)
+{
+  std::string rowKey = to_row_key(key);
+  for (auto& index : _indexes) {
+    bool isBucket = _store->isBucketIndex(index);
+    for (auto& value : values(index, row)) {
+      if (isBucket) {
+        removeBucket(index, value, key);
+        continue;
+      }
+      removePosting(index, value._posting, key);
+      if (_store->isCoveringIndex(index)) _store->delCovering(index, value._cover, rowKey);
+    }
+  }
+  return ECode_Success;
+}
+
+int GIndexWriter::verify(const std::string& index, size_t& missing, size_t& stale)
+{
+  missing = 0;
+  stale = 0;
+  KeyType type = _store->getKeyType(_group);
+  if (type != KeyType::Integer && type != KeyType::Byte) return ECode_Success;
+  if (_store->isBucketIndex(index)) return verifyBucket(index, missing, stale);
+  // postings and covering entries which are built from group
+  std::map<std::string, std::set<std::string>> expected;
+  std::set<std::string> covers;
+  {
+    auto cursor = _store->getMapCursor(_group);
+    auto data = cursor.to_first(false);
+    while (data) {
+      std::string key((char*)data.key.byte_ptr(), data.key.size());
+      std::string row((char*)data.value.byte_ptr(), data.value.size());
+      if (row != "null") {
+        for (auto& value : values(index, nlohmann::json::parse(row))) {
+          expected[value._posting].insert(key);
+          covers.insert(value._cover + key);
+        }
+      }
+      data = cursor.to_next(false);
+    }
+  }
+  {
+    auto cursor = _store->getIndexCursor(index);
+    auto data = cursor.to_first(false);
+    while (data) {
+      std::string posting((char*)data.key.byte_ptr(), data.key.size());
+      std::string ids((char*)data.value.byte_ptr(), data.value.size());
+      std::vector<std::string> keys;
+      if (type == KeyType::Integer) {
+        for (size_t offset = 0; offset + sizeof(uint64_t) <= ids.size(); offset += sizeof(uint64_t)) {
+          keys.emplace_back(ids.substr(offset, sizeof(uint64_t)));
+        }
+      }
+      else {
+        keys = gql::split(ids, '\0');
+      }
+      auto& rows = expected[posting];
+      for (auto& key : keys) {
+        if (rows.erase(key) == 0) ++stale;
+      }
+      data = cursor.to_next(false);
+    }
+  }
+  for (auto& item : expected) {
+    missing += item.second.size();
+  }
+  if (_store->isCoveringIndex(index)) {
+    auto cursor = _store->getCoveringCursor(index);
+    auto data = cursor.to_first(false);
+    while (data) {
+      std::string key((char*)data.key.byte_ptr(), data.key.size());
+      if (covers.erase(key) == 0) ++stale;
+      data = cursor.to_next(false);
+    }
+    missing += covers.size();
+  }
+  return ECode_Success;
+}
+
+std::vector<GIndexWriter::IndexValue> GIndexWriter::values(const std::string& index, const nlohmann::json& row) const
+{
+  std::vector<IndexValue> result;
+  auto add_number = [&result](double v) {
+    result.push_back({ gql::to_ordered_key(v), GStorageEngine::encodeCovering(v), true });
+  };
+  auto add_string = [&result](const std::string& v) {
+    result.push_back({ v, GStorageEngine::encodeCovering(v), false });
+  };
+  std::string k = attribute(index);
+  if (!row.is_object() || row.count(k) == 0) return result;
+  auto& value = row[k];
+  // a value that is not indexed makes index partial
+  bool skipped = false;
+  if (value.is_object() && value.count(OBJECT_TYPE_NAME)) {
+    switch ((AttributeKind)value[OBJECT_TYPE_NAME])
+    {
+    case AttributeKind::Datetime: {
+      uint64_t v = value["value"];
+      add_number((double)v);
+    }
+      break;
+    case AttributeKind::Vector:
+      // vector index is maintained by HNSW
+      break;
+    default:
+      // other kinds of object are not indexed
+      skipped = true;
+      break;
+    }
+  }
+  else if (value.is_string()) {
+    add_string(value);
+  }
+  else if (value.is_number()) {
+    add_number(value);
+  }
+  else if (value.is_array()) {
+    for (auto& datum : value)
+    {
+      switch ((nlohmann::json::value_t)datum)
+      {
+      case nlohmann::json::value_t::string:
+        add_string(datum);
+        break;
+      default:
+        skipped = true;
+        break;
+      }
+    }
+  }
+  // null is not a value, and boolean is not indexed
+  else if (!value.is_null()) skipped = true;
+  if (skipped) _store->setIndexPartial(index);
+  return result;
+}
+
+bool GIndexWriter::upsetPosting(const std::string& index, const IndexValue& value, const gkey_t& key)
+{
+  _store->updateIndexType(index, value._number ? IndexType::Number : IndexType::Word);
+  if (_batch) {
+    _postings[index][value._posting].push_back(key);
+    return true;
+  }
+  return mergePosting(index, value._posting, { key });
+}
+
+bool GIndexWriter::mergePosting(const std::string& index, const std::string& value, const std::vector<gkey_t>& keys)
+{
+  if (keys.empty()) return true;
+  std::string data;
+  _store->read(index, value, data);
+  keys[0].visit(
+    [&](std::string) {
+      std::vector<std::string> v = gql::split(data, '\0');
+      for (auto& key : keys) {
+        addUniqueDataAndSort(v, key.Get<std::string>());
+      }
+      data.clear();
+      for (auto& datum : v) {
+        data += datum + '\0';
+      }
+      data.pop_back();
+      _store->write(index, value, (void*)data.data(), data.size() * sizeof(char));
+    },
+    [&](uint64_t) {
+      std::vector<uint64_t> v((uint64_t*)data.data(), (uint64_t*)data.data() + data.size() / sizeof(uint64_t));
+      for (auto& key : keys) {
+        addUniqueDataAndSort(v, key.Get<uint64_t>());
+      }
+      _store->write(index, value, v.data(), v.size() * sizeof(uint64_t));
+    });
+  return true;
+}
+
+bool GIndexWriter::removePosting(const std::string& index, const std::string& value, const gkey_t& key)
+{
+  std::string data;
+  if (_store->read(index, value, data) != ECode_Success) return false;
+  size_t count = key.visit(
+    [&](std::string id) {
+      std::vector<std::string> v = gql::split(data, '\0');
+      eraseSortedData(v, id);
+      data.clear();
+      for (auto& datum : v) {
+        data += datum + '\0';
+      }
+      if (data.size()) data.pop_back();
+      return v.size();
+    },
+    [&](uint64_t id) {
+      std::vector<uint64_t> v((uint64_t*)data.data(), (uint64_t*)data.data() + data.size() / sizeof(uint64_t));
+      eraseSortedData(v, id);
+      data.assign((char*)v.data(), v.size() * sizeof(uint64_t));
+      return v.size();
+    });
+  if (count == 0) {
+    _store->del(index, value);
+  }
+  else {
+    _store->write(index, value, (void*)data.data(), data.size());
+  }
+  return true;
+}
+
+void GIndexWriter::upsetCovering(const std::string& index, const std::string& value, const gkey_t& key, const nlohmann::json& row)
+{
+  if (!_store->isCoveringIndex(index)) return;
+  std::string attr = attribute(index);
+  nlohmann::json covered;
+  covered[attr] = row[attr];
+  for (auto& include : _store->getIndexIncludes(index)) {
+    if (row.count(include)) covered[include] = row[include];
+  }
+  _store->writeCovering(index, value, to_row_key(key), covered);
+}
+
+bool GIndexWriter::toBucket(const std::string& index, const IndexValue& value, uint64_t& time, uint64_t& bucket) const
+{
+  if (!value._number) return false;
+  double v = gql::from_ordered_key(value._posting.data());
+  if (v < 0) return false;
+  uint64_t interval = _store->getBucketInterval(index);
+  time = (uint64_t)v;
+  bucket = time - time % interval;
+  return true;
+}
+
+void GIndexWriter::upsetBucket(const std::string& index, const IndexValue& value, const gkey_t& key)
+{
+  uint64_t time = 0, bucket = 0;
+  if (!toBucket(index, value, time, bucket)) return;
+  // every entry is a key of bucket map, so it is written without reading its bucket
+  _store->writeBucket(index, { time, to_row_key(key) });
+}
+
+void GIndexWriter::removeBucket(const std::string& index, const IndexValue& value, const gkey_t& key)
+{
+  uint64_t time = 0, bucket = 0;
+  if (!toBucket(index, value, time, bucket)) return;
+  _store->delBucket(index, { time, to_row_key(key) });
+}
+
+int GIndexWriter::verifyBucket(const std::string& index, size_t& missing, size_t& stale)
+{
+  std::set<GStorageEngine::BucketEntry> expected;
+  {
+    auto cursor = _store->getMapCursor(_group);
+    auto data = cursor.to_first(false);
+    while (data) {
+      std::string key((char*)data.key.byte_ptr(), data.key.size());
+      std::string row((char*)data.value.byte_ptr(), data.value.size());
+      if (row != "null") {
+        for (auto& value : values(index, nlohmann::json::parse(row))) {
+          uint64_t time = 0, bucket = 0;
+          if (toBucket(index, value, time, bucket)) expected.insert({ time, key });
+        }
+      }
+      data = cursor.to_next(false);
+    }
+  }
+  uint64_t interval = _store->getBucketInterval(index);
+  auto cursor = _store->getBucketCursor(index);
+  auto data = cursor.to_first(false);
+  uint64_t bucket = 0;
+  GStorageEngine::BucketEntry entry;
+  while (data) {
+    // an entry in wrong bucket can't be found by range query
+    if (!GStorageEngine::parseBucket(data.key, bucket, entry) ||
+      entry._time - entry._time % interval != bucket || expected.erase(entry) == 0) ++stale;
+    data = cursor.to_next(false);
+  }
+  missing = expected.size();
+  return ECode_Success;
+}
+
+void GIndexWriter::logRow(const std::string& index, const gkey_t& key)
+{
+  _store->writeIndexLog(index, to_row_key(key));
+}
@@ -0,0 +1,318 @@
+#include "Snapshot.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <set>
+#include <thread>
+#include "BulkLoader.h"
+#include "base/system/MappedFile.h"
+#include "gutil.h"
+
+namespace {
+  template<typename T>
+  void put_number(std::string& buffer, T value) {
+    buffer.append((const char*)&value, sizeof(T));
+  }
+
+  /**
+   * @brief read data of a mapped file with bounds check.
+   */
+  struct Reader {
+    const char* _cur;
+    const char* _end;
+
+    template<typename T>
+    bool number(T& value) {
+      if ((size_t)(_end - _cur) < sizeof(T)) return false;
+      memcpy(&value, _cur, sizeof(T));
+      _cur += sizeof(T);
+      return true;
+    }
+
+    bool bytes(size_t len, const char*& data) {
+      if ((size_t)(_end - _cur) < len) return false;
+      data = _cur;
+      _cur += len;
+      return true;
+    }
+  };
+
+  /**
+   * @brief checksum of a block covers its count of rows.
+   */
+  uint32_t block_crc(uint32_t rows, const char* block, size_t bytes) {
+    return gql::crc32(block, bytes, gql::crc32(&rows, sizeof(uint32_t)));
+  }
+
+  bool write_block(FILE* fp, uint32_t rows, const std::string& block) {
+    uint32_t bytes = block.size();
+    uint32_t crc = block_crc(rows, block.data(), block.size());
+    return fwrite(&rows, sizeof(uint32_t), 1, fp) == 1 && fwrite(&bytes, sizeof(uint32_t), 1, fp) == 1 &&
+      fwrite(block.data(), 1, block.size(), fp) == block.size() && fwrite(&crc, sizeof(uint32_t), 1, fp) == 1;
+  }
+
+  /**
+   * @brief a section is ended by a block without rows, whose checksum is the checksum of section header.
+   */
+  bool write_end(FILE* fp, uint32_t crc) {
+    uint32_t rows = 0;
+    return fwrite(&rows, sizeof(uint32_t), 1, fp) == 1 && fwrite(&crc, sizeof(uint32_t), 1, fp) == 1;
+  }
+
+  std::string part_path(const std::string& path, size_t idx) {
+    return path + "." + std::to_string(idx);
+  }
+
+  bool has(const nlohmann::json& schema, const char* item, const std::string& name) {
+    auto itr = schema.find(item);
+    return itr != schema.end() && itr->is_object() && itr->count(name) != 0;
+  }
+}
+
+GSnapshot::GSnapshot(GStorageEngine* store)
+:_store(store)
+,_rows(0)
+{
+}
+
+int GSnapshot::dump(const std::string& path)
+{
+  if (!_store->isOpen()) return ECode_Graph_Not_Exist;
+  if (_store->isTransPinned()) return ECode_TRANSTION_Busy;
+  int ret = _store->commitTrans();
+  if (ret != ECode_Success) return ret;
+  const nlohmann::json& schema = _store->getSchema();
+  std::vector<std::string> maps = sections(schema);
+  std::vector<uint8_t> cbor = nlohmann::json::to_cbor(schema);
+
+  // every section is dumped to its own file by a worker, then files are joined in order.
+  // Workers are not the thread of write transaction, which can't start a read transaction.
+  std::vector<int> results(maps.size(), ECode_Success);
+  std::vector<size_t> rows(maps.size(), 0);
+  std::atomic<size_t> next(0);
+  auto worker = [&]() {
+    for (size_t idx = next++; idx < maps.size(); idx = next++) {
+      results[idx] = dumpSection(maps[idx], part_path(path, idx), rows[idx]);
+    }
+  };
+  size_t threads = std::min<size_t>(std::max<size_t>(1, std::thread::hardware_concurrency()), maps.size());
+  std::vector<std::thread> workers;
+  for (size_t idx = 0; idx < threads; ++idx) {
+    workers.emplace_back(worker);
+  }
+  for (auto& thread : workers) {
+    thread.join();
+  }
+
+  _rows = 0;
+  ret = ECode_Success;
+  FILE* fp = fopen(path.c_str(), "wb");
+  if (!fp) ret = ECode_DISK_WRITE_FAIL;
+  else {
+    std::string header(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    put_number<uint32_t>(header, SNAPSHOT_VERSION);
+    put_number<uint32_t>(header, cbor.size());
+    header.append((const char*)cbor.data(), cbor.size());
+    put_number<uint32_t>(header, gql::crc32(cbor.data(), cbor.size()));
+    put_number<uint32_t>(header, maps.size());
+    if (fwrite(header.data(), 1, header.size(), fp) != header.size()) ret = ECode_DISK_WRITE_FAIL;
+  }
+  std::vector<char> buffer(SNAPSHOT_BLOCK_SIZE);
+  for (size_t idx = 0; idx < maps.size(); ++idx) {
+    std::string part = part_path(path, idx);
+    if (ret == ECode_Success) ret = results[idx];
+    if (ret == ECode_Success) {
+      FILE* section = fopen(part.c_str(), "rb");
+      if (!section) ret = ECode_DISK_OPEN_FAIL;
+      else {
+        size_t len = 0;
+        while ((len = fread(buffer.data(), 1, buffer.size(), section)) > 0) {
+          if (fwrite(buffer.data(), 1, len, fp) != len) {
+            ret = ECode_DISK_WRITE_FAIL;
+            break;
+          }
+        }
+        fclose(section);
+      }
+      _rows += rows[idx];
+    }
+    std::remove(part.c_str());
+  }
+  if (fp) {
+    if (fclose(fp) != 0 && ret == ECode_Success) ret = ECode_DISK_WRITE_FAIL;
+    if (ret != ECode_Success) std::remove(path.c_str());
+  }
+  return ret;
+}
+
+int GSnapshot::restore(const std::string& path)
+{
+  if (!_store->isOpen()) return ECode_Graph_Not_Exist;
+  // maps are dropped, which are scanned by suspended statements
+  if (_store->isTransPinned()) return ECode_TRANSTION_Busy;
+  GMappedFile file;
+  if (!file.open(path)) return ECode_DISK_OPEN_FAIL;
+  Reader reader{ file.data(), file.data() + file.size() };
+  const char* magic = nullptr;
+  uint32_t version = 0, len = 0, crc = 0;
+  const char* cbor = nullptr;
+  if (!reader.bytes(sizeof(SNAPSHOT_MAGIC), magic) || memcmp(magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+    return ECode_DISK_Checksum_Fail;
+  }
+  if (!reader.number(version) || version != SNAPSHOT_VERSION) return ECode_DISK_Checksum_Fail;
+  if (!reader.number(len) || !reader.bytes(len, cbor) || !reader.number(crc) || gql::crc32(cbor, len) != crc) {
+    return ECode_DISK_Checksum_Fail;
+  }
+  nlohmann::json schema;
+  try {
+    schema = nlohmann::json::from_cbor(cbor, cbor + len);
+  }
+  catch (const std::exception&) {
+    return ECode_DISK_Checksum_Fail;
+  }
+  // graph is not changed if snapshot is broken
+  int ret = loadSections(reader._cur, reader._end, false);
+  if (ret != ECode_Success) return ret;
+
+  std::set<std::string> restored;
+  for (auto& mapname : sections(schema)) {
+    restored.insert(mapname);
+  }
+  for (auto& mapname : sections(_store->getSchema())) {
+    if (restored.count(mapname) == 0) _store->dropMap(mapname);
+  }
+  _store->replaceSchema(schema);
+  ret = loadSections(reader._cur, reader._end, true);
+  int last = _store->commitTrans();
+  return ret != ECode_Success ? ret : last;
+}
+
+std::vector<std::string> GSnapshot::sections(const nlohmann::json& schema) const
+{
+  std::vector<std::string> maps;
+  auto groups = schema.find(SCHEMA_CLASS);
+  if (groups != schema.end() && groups->is_object()) {
+    for (auto itr = groups->begin(); itr != groups->end(); ++itr) {
+      if (itr.key() == MAP_BASIC || !itr->is_object() || itr->count(SCHEMA_CLASS_KEY) == 0) continue;
+      KeyType type = (*itr)[SCHEMA_CLASS_KEY];
+      // map is not created before its key type is known
+      if (type == KeyType::Uninitialize) continue;
+      maps.push_back(itr.key());
+    }
+  }
+  auto indexes = schema.find(SCHEMA_INDEX);
+  if (indexes != schema.end() && indexes->is_object()) {
+    for (auto itr = indexes->begin(); itr != indexes->end(); ++itr) {
+      const std::string& name = itr.key();
+      if (has(schema, SCHEMA_CLASS, name)) continue;
+      IndexType type = *itr;
+      if (type == IndexType::Word || type == IndexType::Number) {
+        maps.push_back(name);
+      }
+      if (has(schema, SCHEMA_INDEX_INCLUDE, name) && !schema[SCHEMA_INDEX_INCLUDE][name].empty()) {
+        maps.push_back(name + INDEX_COVER_SUFFIX);
+      }
+      if (has(schema, SCHEMA_INDEX_BUCKET, name)) {
+        maps.push_back(name + INDEX_BUCKET_SUFFIX);
+      }
+      // keys that are written when index is building are indexed after restore
+      if (has(schema, SCHEMA_INDEX_BUILD, name)) {
+        maps.push_back(name + INDEX_LOG_SUFFIX);
+      }
+    }
+  }
+  return maps;
+}
+
+int GSnapshot::dumpSection(const std::string& mapname, const std::string& path, size_t& rows) const
+{
+  FILE* fp = fopen(path.c_str(), "wb");
+  if (!fp) return ECode_DISK_WRITE_FAIL;
+  std::string header;
+  auto write_header = [&](uint32_t flags) {
+    put_number<uint32_t>(header, flags);
+    put_number<uint16_t>(header, mapname.size());
+    header.append(mapname);
+    return fwrite(header.data(), 1, header.size(), fp) == header.size();
+  };
+  bool success = true;
+  std::string block;
+  uint32_t count = 0;
+  try {
+    mdbx::txn_managed txn = _store->startSnapshot();
+    GStorageEngine::cursor cursor = GStorageEngine::getSnapshotCursor(txn, mapname);
+    success = write_header(txn.get_handle_info(cursor.map()).flags);
+    for (auto data = cursor.to_first(false); data && success; data = cursor.to_next(false)) {
+      put_number<uint32_t>(block, data.key.size());
+      block.append(data.key.char_ptr(), data.key.size());
+      put_number<uint32_t>(block, data.value.size());
+      block.append(data.value.char_ptr(), data.value.size());
+      ++rows;
+      ++count;
+      if (block.size() >= SNAPSHOT_BLOCK_SIZE) {
+        success = write_block(fp, count, block);
+        block.clear();
+        count = 0;
+      }
+    }
+  }
+  catch (const std::exception&) {
+    // map is not created, so section is empty
+    if (!header.empty()) success = false;
+  }
+  if (header.empty()) success = write_header(MDBX_DB_DEFAULTS);
+  if (success && count) success = write_block(fp, count, block);
+  if (success) success = write_end(fp, gql::crc32(header.data(), header.size()));
+  if (fclose(fp) != 0) success = false;
+  return success ? ECode_Success : ECode_DISK_WRITE_FAIL;
+}
+
+int GSnapshot::loadSections(const char* begin, const char* end, bool apply)
+{
+  Reader reader{ begin, end };
+  uint32_t count = 0;
+  if (!reader.number(count)) return ECode_DISK_Checksum_Fail;
+  _rows = 0;
+  for (uint32_t idx = 0; idx < count; ++idx) {
+    const char* header = reader._cur;
+    uint32_t flags = 0;
+    uint16_t len = 0;
+    const char* name = nullptr;
+    if (!reader.number(flags) || !reader.number(len) || !reader.bytes(len, name)) return ECode_DISK_Checksum_Fail;
+    std::string mapname(name, len);
+    // entries are appended to an empty map
+    if (apply) _store->dropMap(mapname);
+    while (true) {
+      uint32_t rows = 0, bytes = 0, crc = 0;
+      const char* block = nullptr;
+      if (!reader.number(rows)) return ECode_DISK_Checksum_Fail;
+      if (rows == 0) {
+        if (!reader.number(crc) || crc != gql::crc32(header, name + len - header)) return ECode_DISK_Checksum_Fail;
+        break;
+      }
+      if (!reader.number(bytes) || !reader.bytes(bytes, block) || !reader.number(crc)) return ECode_DISK_Checksum_Fail;
+      if (!apply && block_crc(rows, block, bytes) != crc) return ECode_DISK_Checksum_Fail;
+      Reader entries{ block, block + bytes };
+      for (uint32_t row = 0; row < rows; ++row) {
+        uint32_t klen = 0, vlen = 0;
+        const char* key = nullptr;
+        const char* value = nullptr;
+        if (!entries.number(klen) || !entries.bytes(klen, key) || !entries.number(vlen) || !entries.bytes(vlen, value)) {
+          return ECode_DISK_Checksum_Fail;
+        }
+        if (apply) {
+          int ret = _store->append(mapname, (MDBX_db_flags_t)flags, mdbx::slice(key, klen), mdbx::slice(value, vlen));
+          if (ret != ECode_Success) return ret;
+          if ((_rows + 1) % BULK_COMMIT_ROWS == 0) {
+            ret = _store->commitTrans();
+            if (ret != ECode_Success) return ret;
+          }
+        }
+        ++_rows;
+      }
+      if (entries._cur != entries._end) return ECode_DISK_Checksum_Fail;
+    }
+  }
+  return reader._cur == reader._end ? ECode_Success : ECode_DISK_Checksum_Fail;
+}
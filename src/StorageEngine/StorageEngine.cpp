@@ -1,4 +1,5 @@
 #include "StorageEngine.h"
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <limits>
@@ -35,6 +36,7 @@ using namespace std::experimental;
 #define CHECK_RESULT(expr) {int ret = ECode_Success; if ((ret = expr) != ECode_Success) return ret;}
 #define DB_SCHEMA   "gql_schema"
 #define SCHEMA_BASIC  "basic"
+#define SCHEMA_FILTER_PREFIX  "flt:"
 
 #define SRC_PREV_INDEX  0
 #define SRC_NEXT_INDEX  1
@@ -177,6 +179,8 @@ int GStorageEngine::open(const char* filename, StoreOption option) {
   _curDBPath = fullpath;
   initMap(option);
   initDict(option.compress);
+  upgradeIndexes(option.mode);
+  loadFilters(option.mode);
   return ret;
 }
 
@@ -194,13 +198,8 @@ void GStorageEngine::close()
     try {
       auto flag = _txns[id].flags();
       if ((flag & MDBX_TXN_RDONLY) == 0) {
-        if (!_schema.empty()) {
-          mdbx::map_handle handle = openSchema(ReadWriteOption::read_write);
-          std::vector<uint8_t> v = nlohmann::json::to_cbor(_schema);
-          mdbx::slice data(v.data(), v.size());
-          ::put(_txns[id], handle, SCHEMA_BASIC, data);
-          // _env.close_map(handle);
-        }
+        saveSchema(_txns[id]);
+        saveFilters(_txns[id]);
         _txns[id].commit();
       }
     } catch (const mdbx::exception& err) {
@@ -208,10 +207,62 @@ void GStorageEngine::close()
     }
   }
   _txns.clear();
+  _filters.clear();
   releaseDict();
   if (_env) _env.close();
 }
 
+void GStorageEngine::saveSchema(mdbx::txn_managed& txn)
+{
+  if (_schema.empty()) return;
+  mdbx::map_handle handle = openSchema(ReadWriteOption::read_write);
+  std::vector<uint8_t> v = nlohmann::json::to_cbor(_schema);
+  mdbx::slice data(v.data(), v.size());
+  ::put(txn, handle, SCHEMA_BASIC, data);
+  // _env.close_map(handle);
+}
+
+void GStorageEngine::saveFilters(mdbx::txn_managed& txn)
+{
+  mdbx::map_handle handle = openSchema(ReadWriteOption::read_write);
+  for (auto& item : _filters) {
+    std::string filter = item.second.serialize();
+    ::put(txn, handle, SCHEMA_FILTER_PREFIX + item.first, mdbx::slice(filter.data(), filter.size()));
+  }
+}
+
+void GStorageEngine::loadFilters(ReadWriteOption option)
+{
+  _filters.clear();
+  if (_schema.count(SCHEMA_CLASS) == 0) return;
+  thread_local auto id = std::this_thread::get_id();
+  mdbx::map_handle handle = openSchema(ReadWriteOption::read_only);
+  for (auto itr = _schema[SCHEMA_CLASS].begin(); itr != _schema[SCHEMA_CLASS].end(); ++itr) {
+    const std::string& mapname = itr.key();
+    if (!isFilterEnable(mapname)) continue;
+    mdbx::slice data = ::get(_txns[id], handle, SCHEMA_FILTER_PREFIX + mapname);
+    GBloomFilter filter;
+    if (data.size() && filter.deserialize(std::string((char*)data.data(), data.size()))) {
+      _filters[mapname] = filter;
+    }
+    else {
+      size_t keys = getKeyType(mapname) == KeyType::Uninitialize ? 0 : count(mapname);
+      rebuildFilter(mapname, std::max<size_t>(BLOOM_DEFAULT_CAPACITY, keys * 2));
+    }
+  }
+  if (option == ReadWriteOption::read_write) removeSavedFilters();
+}
+
+void GStorageEngine::removeSavedFilters()
+{
+  // filters are changed by writes, and they are saved again when graph is closed
+  thread_local auto id = std::this_thread::get_id();
+  mdbx::map_handle handle = openSchema(ReadWriteOption::read_write);
+  for (auto& item : _filters) {
+    ::del(_txns[id], handle, SCHEMA_FILTER_PREFIX + item.first);
+  }
+}
+
 mdbx::map_handle GStorageEngine::openSchema(ReadWriteOption option) {
   mdbx::map_handle schema;
   thread_local auto id = std::this_thread::get_id();
@@ -268,6 +319,32 @@ void GStorageEngine::initDict(int compressLvl)
   }
 }
 
+void GStorageEngine::upgradeIndexes(ReadWriteOption option)
+{
+  auto& global = _schema[SCHEMA_GLOBAL];
+  if (global.count(GLOBAL_INDEX_VERSION) && global[GLOBAL_INDEX_VERSION] >= INDEX_FORMAT_VERSION) return;
+  std::vector<std::string> indexes;
+  if (_schema.count(SCHEMA_INDEX)) {
+    for (auto& item : _schema[SCHEMA_INDEX].items()) {
+      if (getIndexType(item.key()) != IndexType::Vector) indexes.emplace_back(item.key());
+    }
+  }
+  if (option == ReadWriteOption::read_only) {
+    for (auto& index : indexes) {
+      _schema[SCHEMA_INDEX].erase(index);
+    }
+    return;
+  }
+  for (auto& index : indexes) {
+    // map of an old number index has ordinal keys, so it is dropped instead of cleared
+    dropMap(index);
+    std::string group = index.substr(0, index.find(':'));
+    KeyType type = getKeyType(group);
+    if (type == KeyType::Integer || type == KeyType::Byte) setIndexBuildMark(index, "");
+  }
+  global[GLOBAL_INDEX_VERSION] = INDEX_FORMAT_VERSION;
+}
+
 void GStorageEngine::releaseDict()
 {
   if (_id2key.size()) {
@@ -285,11 +362,240 @@ void GStorageEngine::addMap(const std::string& prop, KeyType type) {
   }
 }
 
-void GStorageEngine::addIndex(const std::string& indexname)
+void GStorageEngine::addIndex(const std::string& indexname, const std::vector<std::string>& includes)
 {
   if (!isIndexExist(indexname)) {
     _schema[SCHEMA_INDEX][indexname] = IndexType::Uninitialize;
   }
+  if (includes.size()) {
+    _schema[SCHEMA_INDEX_INCLUDE][indexname] = includes;
+  }
+}
+
+std::vector<std::string> GStorageEngine::getIndexIncludes(const std::string& indexname)
+{
+  std::vector<std::string> includes;
+  if (!isCoveringIndex(indexname)) return includes;
+  return _schema[SCHEMA_INDEX_INCLUDE][indexname];
+}
+
+bool GStorageEngine::isCoveringIndex(const std::string& indexname)
+{
+  if (_schema.empty() || _schema.count(SCHEMA_INDEX_INCLUDE) == 0) return false;
+  return _schema[SCHEMA_INDEX_INCLUDE].count(indexname) != 0;
+}
+
+int GStorageEngine::writeCovering(const std::string& indexname, const std::string& value, const std::string& key, const nlohmann::json& attrs)
+{
+  auto handle = getOrCreateHandle(indexname + INDEX_COVER_SUFFIX, mdbx::key_mode::usual);
+  thread_local auto id = std::this_thread::get_id();
+  std::vector<uint8_t> cbor = nlohmann::json::to_cbor(attrs);
+  uint32_t len = value.size();
+  std::string data((char*)&len, sizeof(uint32_t));
+  data.append(cbor.begin(), cbor.end());
+  if (0 == ::put(_txns[id], handle, value + key, mdbx::slice(data.data(), data.size()))) {
+    return ECode_Success;
+  }
+  return ECode_Fail;
+}
+
+int GStorageEngine::delCovering(const std::string& indexname, const std::string& value, const std::string& key)
+{
+  auto handle = getOrCreateHandle(indexname + INDEX_COVER_SUFFIX, mdbx::key_mode::usual);
+  thread_local auto id = std::this_thread::get_id();
+  if (::del(_txns[id], handle, value + key)) return ECode_Fail;
+  return ECode_Success;
+}
+
+GStorageEngine::cursor GStorageEngine::getCoveringCursor(const std::string& indexname)
+{
+  assert(isCoveringIndex(indexname));
+  auto handle = getOrCreateHandle(indexname + INDEX_COVER_SUFFIX, mdbx::key_mode::usual);
+  thread_local auto id = std::this_thread::get_id();
+  return _txns[id].open_cursor(handle);
+}
+
+bool GStorageEngine::isIndexReady(const std::string& indexname)
+{
+  if (_schema.empty() || _schema.count(SCHEMA_INDEX_BUILD) == 0) return true;
+  return _schema[SCHEMA_INDEX_BUILD].count(indexname) == 0;
+}
+
+std::vector<std::string> GStorageEngine::getBuildingIndexes()
+{
+  std::vector<std::string> indexes;
+  thread_local auto id = std::this_thread::get_id();
+  // graph is closed
+  if (_txns.count(id) == 0) return indexes;
+  if (_schema.empty() || _schema.count(SCHEMA_INDEX_BUILD) == 0) return indexes;
+  for (auto& item : _schema[SCHEMA_INDEX_BUILD].items()) {
+    indexes.emplace_back(item.key());
+  }
+  return indexes;
+}
+
+void GStorageEngine::setIndexBuildMark(const std::string& indexname, const std::string& key)
+{
+  _schema[SCHEMA_INDEX_BUILD][indexname]["hwm"] = nlohmann::json::binary(std::vector<uint8_t>(key.begin(), key.end()));
+}
+
+std::string GStorageEngine::getIndexBuildMark(const std::string& indexname)
+{
+  if (isIndexReady(indexname)) return "";
+  auto& mark = _schema[SCHEMA_INDEX_BUILD][indexname]["hwm"];
+  if (!mark.is_binary()) return "";
+  auto& bin = mark.get_binary();
+  return std::string(bin.begin(), bin.end());
+}
+
+void GStorageEngine::setIndexReady(const std::string& indexname)
+{
+  if (isIndexReady(indexname)) return;
+  _schema[SCHEMA_INDEX_BUILD].erase(indexname);
+  if (_schema[SCHEMA_INDEX_BUILD].empty()) _schema.erase(SCHEMA_INDEX_BUILD);
+}
+
+void GStorageEngine::setIndexPartial(const std::string& indexname)
+{
+  if (isIndexPartial(indexname)) return;
+  _schema[SCHEMA_INDEX_PARTIAL][indexname] = true;
+}
+
+bool GStorageEngine::isIndexPartial(const std::string& indexname)
+{
+  if (_schema.empty() || _schema.count(SCHEMA_INDEX_PARTIAL) == 0) return false;
+  return _schema[SCHEMA_INDEX_PARTIAL].count(indexname) != 0;
+}
+
+int GStorageEngine::writeIndexLog(const std::string& indexname, const std::string& key)
+{
+  auto handle = getOrCreateHandle(indexname + INDEX_LOG_SUFFIX, mdbx::key_mode::usual);
+  thread_local auto id = std::this_thread::get_id();
+  uint8_t flag = 1;
+  if (0 == ::put(_txns[id], handle, key, mdbx::slice(&flag, sizeof(uint8_t)))) {
+    return ECode_Success;
+  }
+  return ECode_Fail;
+}
+
+GStorageEngine::cursor GStorageEngine::getIndexLogCursor(const std::string& indexname)
+{
+  auto handle = getOrCreateHandle(indexname + INDEX_LOG_SUFFIX, mdbx::key_mode::usual);
+  thread_local auto id = std::this_thread::get_id();
+  return _txns[id].open_cursor(handle);
+}
+
+int GStorageEngine::clearIndexLog(const std::string& indexname)
+{
+  auto handle = getOrCreateHandle(indexname + INDEX_LOG_SUFFIX, mdbx::key_mode::usual);
+  thread_local auto id = std::this_thread::get_id();
+  GRAPH_EXCEPTION_CATCH(_txns[id].clear_map(handle));
+  return ECode_Success;
+}
+
+void GStorageEngine::setBucketInterval(const std::string& indexname, uint64_t interval)
+{
+  if (interval == 0) return;
+  _schema[SCHEMA_INDEX_BUCKET][indexname] = interval;
+}
+
+uint64_t GStorageEngine::getBucketInterval(const std::string& indexname)
+{
+  if (!isBucketIndex(indexname)) return 0;
+  return _schema[SCHEMA_INDEX_BUCKET][indexname];
+}
+
+bool GStorageEngine::isBucketIndex(const std::string& indexname)
+{
+  if (_schema.empty() || _schema.count(SCHEMA_INDEX_BUCKET) == 0) return false;
+  return _schema[SCHEMA_INDEX_BUCKET].count(indexname) != 0;
+}
+
+int GStorageEngine::writeBucket(const std::string& indexname, const BucketEntry& entry)
+{
+  uint64_t interval = getBucketInterval(indexname);
+  if (interval == 0) return ECode_Fail;
+  auto handle = getOrCreateHandle(indexname + INDEX_BUCKET_SUFFIX, mdbx::key_mode::usual);
+  thread_local auto id = std::this_thread::get_id();
+  if (0 == ::put(_txns[id], handle, encodeBucket(entry._time - entry._time % interval, &entry), mdbx::slice())) {
+    return ECode_Success;
+  }
+  return ECode_Fail;
+}
+
+int GStorageEngine::delBucket(const std::string& indexname, const BucketEntry& entry)
+{
+  uint64_t interval = getBucketInterval(indexname);
+  if (interval == 0) return ECode_Fail;
+  auto handle = getOrCreateHandle(indexname + INDEX_BUCKET_SUFFIX, mdbx::key_mode::usual);
+  thread_local auto id = std::this_thread::get_id();
+  if (::del(_txns[id], handle, encodeBucket(entry._time - entry._time % interval, &entry))) return ECode_Fail;
+  return ECode_Success;
+}
+
+int GStorageEngine::expireBucket(const std::string& indexname, uint64_t time, std::vector<std::string>& keys)
+{
+  auto itr = getBucketCursor(indexname);
+  uint64_t bucket = 0;
+  BucketEntry entry;
+  // entries are sorted by time, so expired entries are the first range of map
+  for (auto data = itr.to_first(false); data; data = itr.to_first(false)) {
+    if (!parseBucket(data.key, bucket, entry) || entry._time >= time) break;
+    keys.emplace_back(entry._key);
+    try {
+      itr.erase();
+    } catch (const mdbx::exception& err) {
+      return ECode_Fail;
+    }
+  }
+  return ECode_Success;
+}
+
+GStorageEngine::cursor GStorageEngine::getBucketCursor(const std::string& indexname)
+{
+  assert(isBucketIndex(indexname));
+  auto handle = getOrCreateHandle(indexname + INDEX_BUCKET_SUFFIX, mdbx::key_mode::usual);
+  thread_local auto id = std::this_thread::get_id();
+  return _txns[id].open_cursor(handle);
+}
+
+std::string GStorageEngine::encodeBucket(uint64_t bucket, const BucketEntry* entry)
+{
+  std::string data = gql::to_ordered_key((double)bucket);
+  if (entry) {
+    data.append(gql::to_ordered_key((double)entry->_time));
+    data.append(entry->_key);
+  }
+  return data;
+}
+
+bool GStorageEngine::parseBucket(const mdbx::slice& data, uint64_t& bucket, BucketEntry& entry)
+{
+  if (data.size() < 2 * sizeof(uint64_t)) return false;
+  const char* ptr = (const char*)data.byte_ptr();
+  bucket = (uint64_t)gql::from_ordered_key(ptr);
+  entry._time = (uint64_t)gql::from_ordered_key(ptr + sizeof(uint64_t));
+  entry._key.assign(ptr + 2 * sizeof(uint64_t), data.size() - 2 * sizeof(uint64_t));
+  return true;
+}
+
+std::string GStorageEngine::encodeCovering(const std::string& value)
+{
+  return value + '\0';
+}
+
+std::string GStorageEngine::encodeCovering(double value)
+{
+  return gql::to_ordered_key(value);
+}
+
+void GStorageEngine::parseCovering(const mdbx::slice& key, const mdbx::slice& data,
+  std::string& value, std::string& rowKey, nlohmann::json& attrs)
+{
+  uint32_t len = *(uint32_t*)data.byte_ptr();
+  value.assign((char*)key.byte_ptr(), len);
+  rowKey.assign((char*)key.byte_ptr() + len, key.size() - len);
+  attrs = nlohmann::json::from_cbor(data.byte_ptr() + sizeof(uint32_t), data.byte_ptr() + data.size());
 }
 
 bool GStorageEngine::isMapExist(const std::string& prop) {
@@ -335,10 +641,89 @@ std::list<std::tuple<std::string, std::string, std::string>> GStorageEngine::get
   return relations;
 }
 
+bool GStorageEngine::getRelation(const std::string& edge, std::string& from, std::string& to)
+{
+  if (_schema.count(SCHEMA_EDGE) == 0 || _schema[SCHEMA_EDGE].count(edge) == 0) return false;
+  std::tie(from, to) = std::pair<std::string, std::string>(_schema[SCHEMA_EDGE][edge]);
+  return true;
+}
+
 void GStorageEngine::tryInitKeyType(const std::string& prop, KeyType type)
 {
   if (_schema[SCHEMA_CLASS][prop][SCHEMA_CLASS_KEY] != KeyType::Uninitialize) return;
   _schema[SCHEMA_CLASS][prop][SCHEMA_CLASS_KEY] = type;
+  if (type == KeyType::Edge) {
+    // most of edge lookups are missed when edges are inserted
+    enableFilter(prop);
+  }
+}
+
+void GStorageEngine::enableFilter(const std::string& mapname)
+{
+  if (!isMapExist(mapname) || isFilterEnable(mapname)) return;
+  _schema[SCHEMA_CLASS][mapname][SCHEMA_CLASS_FILTER] = true;
+  size_t keys = getKeyType(mapname) == KeyType::Uninitialize ? 0 : count(mapname);
+  rebuildFilter(mapname, std::max<size_t>(BLOOM_DEFAULT_CAPACITY, keys * 2));
+}
+
+bool GStorageEngine::isFilterEnable(const std::string& mapname)
+{
+  if (!isMapExist(mapname)) return false;
+  return _schema[SCHEMA_CLASS][mapname].count(SCHEMA_CLASS_FILTER) != 0;
+}
+
+bool GStorageEngine::mayExist(const std::string& mapname, const void* key, size_t len)
+{
+  GBloomFilter* filter = getFilter(mapname);
+  if (!filter) return true;
+  return filter->mayContain(key, len);
+}
+
+GBloomFilter* GStorageEngine::getFilter(const std::string& mapname)
+{
+  // filters are loaded when graph is opened, so that a read never scans map
+  auto itr = _filters.find(mapname);
+  if (itr == _filters.end()) return nullptr;
+  return &itr->second;
+}
+
+void GStorageEngine::addToFilter(const std::string& mapname, const void* key, size_t len)
+{
+  GBloomFilter* filter = getFilter(mapname);
+  if (!filter || filter->mayContain(key, len)) return;
+  filter->add(key, len);
+  if (filter->full()) {
+    rebuildFilter(mapname, filter->capacity() * 2);
+  }
+}
+
+void GStorageEngine::rebuildFilter(const std::string& mapname, size_t capacity)
+{
+  size_t count = 0;
+  {
+    GBloomFilter filter(capacity);
+    KeyType type = getKeyType(mapname);
+    // map is not created before its key type is known
+    mdbx::map_handle handle;
+    if (type != KeyType::Uninitialize) {
+      handle = getOrCreateHandle(mapname, type == KeyType::Integer ? mdbx::key_mode::ordinal : mdbx::key_mode::usual);
+    }
+    if (handle) {
+      thread_local auto id = std::this_thread::get_id();
+      auto cursor = _txns[id].open_cursor(handle);
+      auto data = cursor.to_first(false);
+      while (data) {
+        filter.add(data.key.data(), data.key.size());
+        data = cursor.to_next(false);
+      }
+    }
+    count = filter.count();
+    if (count * 2 <= capacity) {
+      _filters[mapname] = filter;
+      return;
+    }
+  }
+  rebuildFilter(mapname, count * 2);
 }
 
 void GStorageEngine::tryInitAttributeType(nlohmann::json& attributes, const std::string& attr, const nlohmann::json& value)
@@ -411,13 +796,13 @@ nlohmann::json GStorageEngine::getProp(const std::string& prop)
   return props[prop];
 }
 
-mdbx::map_handle GStorageEngine::getOrCreateHandle(const std::string& prop, mdbx::key_mode mode) {
+mdbx::map_handle GStorageEngine::getOrCreateHandle(const std::string& prop, mdbx::key_mode mode, mdbx::value_mode value) {
   thread_local auto id = std::this_thread::get_id();
   if (_mHandles[id].count(prop) == 0) {
     mdbx::map_handle propMap;
     GRAPH_EXCEPTION_CATCH(propMap = _txns[id].open_map(prop, (mdbx::key_mode)MDBX_db_flags_t::MDBX_DB_ACCEDE, mdbx::value_mode::single));
     if (!propMap) {
-      GRAPH_EXCEPTION_CATCH(propMap = _txns[id].create_map(prop, mode, mdbx::value_mode::single));
+      GRAPH_EXCEPTION_CATCH(propMap = _txns[id].create_map(prop, mode, value));
     }
     _mHandles[id][prop] = propMap;
   }
@@ -438,6 +823,7 @@ int GStorageEngine::write(const std::string& prop, const std::string& key, void*
   void* buffer = value;
   mdbx::slice data(buffer, cSize);
   if (0 == ::put(_txns[id], handle, key, data)) {
+    addToFilter(prop, key.data(), key.size());
     return ECode_Success;
   }
   return ECode_Fail;
@@ -541,6 +927,7 @@ int GStorageEngine::del(const std::string& mapname, const std::string& key, bool
 
 int GStorageEngine::read(const std::string& prop, const std::string& key, std::string& value) {
   assert(isMapExist(prop) || isIndexExist(prop));
+  if (!mayExist(prop, key.data(), key.size())) return ECode_DATUM_Not_Exist;
   auto handle = getOrCreateHandle(prop, mdbx::key_mode::usual);
   thread_local auto id = std::this_thread::get_id();
   mdbx::slice data = ::get(_txns[id], handle, key);
@@ -589,6 +976,24 @@ size_t GStorageEngine::estimate(const std::string& mapname)
   return std::numeric_limits<size_t>::max();
 }
 
+size_t GStorageEngine::count(const std::string& mapname)
+{
+  mdbx::map_handle handle;
+  if (isIndexExist(mapname)) {
+    IndexType type = getIndexType(mapname);
+    if (type != IndexType::Number && type != IndexType::Word) return 0;
+    handle = getOrCreateHandle(mapname, mdbx::key_mode::usual);
+  }
+  else if (isMapExist(mapname)) {
+    auto pp = getProp(mapname);
+    auto type = (KeyType)pp[SCHEMA_CLASS_KEY];
+    handle = getOrCreateHandle(mapname, type == KeyType::Integer ? mdbx::key_mode::ordinal : mdbx::key_mode::usual);
+  }
+  else return 0;
+  thread_local auto id = std::this_thread::get_id();
+  return _txns[id].get_map_stat(handle).ms_entries;
+}
+
 int GStorageEngine::del(const std::string& mapname, const std::string& key)
 {
   assert(isMapExist(mapname) || isIndexExist(mapname));
@@ -621,12 +1026,14 @@ int GStorageEngine::write(const std::string& prop, uint64_t key, void* value, si
   thread_local auto id = std::this_thread::get_id();
   mdbx::slice data(buffer, cSize);
   if (0 == ::put(_txns[id], handle, key, data)) {
+    addToFilter(prop, &key, sizeof(uint64_t));
     return ECode_Success;
   }
   return ECode_Fail;
 }
 int GStorageEngine::read(const std::string& prop, uint64_t key, std::string& value) {
   assert(isMapExist(prop) || isIndexExist(prop));
+  if (!mayExist(prop, &key, sizeof(uint64_t))) return ECode_DATUM_Not_Exist;
   auto handle = getOrCreateHandle(prop, mdbx::key_mode::ordinal);
   thread_local auto id = std::this_thread::get_id();
   mdbx::slice data = ::get(_txns[id], handle, key);
@@ -652,15 +1059,128 @@ GStorageEngine::cursor GStorageEngine::getMapCursor(const std::string& prop)
   return _txns[id].open_cursor(handle);
 }
 
+mdbx::txn_managed GStorageEngine::startSnapshot()
+{
+  return _env.start_read();
+}
+
+GStorageEngine::cursor GStorageEngine::getSnapshotCursor(mdbx::txn& txn, const std::string& mapname)
+{
+  auto handle = txn.open_map(mapname, (mdbx::key_mode)MDBX_db_flags_t::MDBX_DB_ACCEDE, mdbx::value_mode::single);
+  return txn.open_cursor(handle);
+}
+
+int GStorageEngine::dropMap(const std::string& mapname)
+{
+  thread_local auto id = std::this_thread::get_id();
+  try {
+    _txns[id].drop_map(mapname, false);
+  } catch (const mdbx::exception& err) {
+    printf("err: %s\n", err.what());
+    return ECode_Fail;
+  }
+  for (auto& item : _mHandles) {
+    item.second.erase(mapname);
+  }
+  if (_filters.count(mapname)) {
+    _filters[mapname] = GBloomFilter();
+  }
+  return ECode_Success;
+}
+
+int GStorageEngine::append(const std::string& mapname, MDBX_db_flags_t flags, const mdbx::slice& key, const mdbx::slice& value)
+{
+  auto handle = getOrCreateHandle(mapname, (mdbx::key_mode)(flags & (MDBX_REVERSEKEY | MDBX_INTEGERKEY)),
+    (mdbx::value_mode)(flags & (MDBX_DUPSORT | MDBX_DUPFIXED | MDBX_INTEGERDUP | MDBX_REVERSEDUP)));
+  if (!handle) return ECode_Fail;
+  thread_local auto id = std::this_thread::get_id();
+  mdbx::slice data(value);
+  if (_txns[id].put(handle, key, &data, MDBX_APPEND) != MDBX_SUCCESS) {
+    data = value;
+    if (_txns[id].put(handle, key, &data, MDBX_put_flags_t(mdbx::upsert)) != MDBX_SUCCESS) return ECode_Fail;
+  }
+  addToFilter(mapname, key.data(), key.size());
+  return ECode_Success;
+}
+
+void GStorageEngine::replaceSchema(const nlohmann::json& schema)
+{
+  thread_local auto id = std::this_thread::get_id();
+  mdbx::map_handle handle = openSchema(ReadWriteOption::read_write);
+  for (const nlohmann::json* s : std::initializer_list<const nlohmann::json*>{ &_schema, &schema }) {
+    if (s->count(SCHEMA_CLASS) == 0) continue;
+    for (auto itr = (*s)[SCHEMA_CLASS].begin(); itr != (*s)[SCHEMA_CLASS].end(); ++itr) {
+      ::del(_txns[id], handle, SCHEMA_FILTER_PREFIX + itr.key());
+    }
+  }
+  _filters.clear();
+  nlohmann::json name = _schema[SCHEMA_GRAPH_NAME];
+  _schema = schema;
+  _schema[SCHEMA_GRAPH_NAME] = name;
+  _key2id.clear();
+  _id2key.clear();
+  initDict(0);
+  for (auto itr = _schema[SCHEMA_CLASS].begin(); itr != _schema[SCHEMA_CLASS].end(); ++itr) {
+    addMap(itr.key(), getKeyType(itr.key()));
+    // entries are appended to maps later
+    if (isFilterEnable(itr.key())) _filters[itr.key()] = GBloomFilter();
+  }
+}
+
+int GStorageEngine::backup(const std::string& path, bool compact)
+{
+  if (!_env) return ECode_Graph_Not_Exist;
+  thread_local auto id = std::this_thread::get_id();
+  if (_txns.count(id) == 0) return ECode_TRANSTION_Not_Exist;
+  if (_pinned) return ECode_TRANSTION_Busy;
+  bool writable = (_txns[id].flags() & MDBX_TXN_RDONLY) == 0;
+  // compacting copy only reads a snapshot, so a new write transaction is started at once.
+  // Copy without compacting takes the writer lock, so write transaction of this thread
+  // is ended until copy is finished
+  bool restart = writable && !compact;
+  if (writable && compact) {
+    if (commitTrans() != ECode_Success) return ECode_Fail;
+  }
+  else if (restart) {
+    try {
+      saveSchema(_txns[id]);
+      _txns[id].commit();
+    } catch (const mdbx::exception& err) {
+      return ECode_Fail;
+    }
+  }
+  int ret = ECode_Success;
+  // copy reads with its own transaction, which can't be started by thread of session
+  std::thread worker([&]() {
+    try {
+#if defined(__APPLE__) || defined(__gnu_linux__) || defined(__linux__) 
+      _env.copy(path, compact);
+#else
+      _env.copy(gql::string2wstring(path), compact);
+#endif
+    } catch (const mdbx::exception& err) {
+      ret = ECode_DISK_WRITE_FAIL;
+    }
+  });
+  worker.join();
+  if (restart) {
+    try {
+      _txns[id] = _env.start_write();
+    } catch (const mdbx::exception& err) {
+      return ECode_Fail;
+    }
+  }
+  return ret;
+}
+
 GStorageEngine::cursor GStorageEngine::getIndexCursor(const std::string& mapname)
 {
   assert(isIndexExist(mapname));
   mdbx::map_handle handle;
   switch (getIndexType(mapname)) {
   case IndexType::Number:
-    handle = getOrCreateHandle(mapname, mdbx::key_mode::ordinal);
-    break;
   case IndexType::Word:
+    // postings of numbers are encoded in byte order
     handle = getOrCreateHandle(mapname, mdbx::key_mode::usual);
     break;
   case IndexType::Vector: // Support number's element only
@@ -688,6 +1208,40 @@ int GStorageEngine::startTrans(ReadWriteOption opt) {
   return ECode_Success;
 }
 
+int GStorageEngine::commitTrans() {
+  thread_local auto id = std::this_thread::get_id();
+  if (_txns.count(id) == 0) return ECode_TRANSTION_Not_Exist;
+  auto flag = _txns[id].flags();
+  if ((flag & MDBX_TXN_RDONLY) != 0) return ECode_Success;
+  if (_pinned) return ECode_Success;
+  try {
+    saveSchema(_txns[id]);
+    _txns[id].commit();
+    _txns[id] = _env.start_write();
+  } catch (const mdbx::exception&) {
+    // writes of failed transaction are dropped, and session gets a new transaction for later writes
+    try {
+      _txns[id].abort();
+    } catch (const mdbx::exception&) {}
+    try {
+      _txns[id] = _env.start_write();
+      // saved filters come back if their removal is dropped
+      removeSavedFilters();
+    } catch (const mdbx::exception&) {
+      _txns.erase(id);
+    }
+    return ECode_Fail;
+  }
+  return ECode_Success;
+}
+
+bool GStorageEngine::isTransDirty() {
+  thread_local auto id = std::this_thread::get_id();
+  if (_txns.count(id) == 0) return false;
+  if ((_txns[id].flags() & MDBX_TXN_RDONLY) != 0) return false;
+  return _txns[id].get_info().txn_space_dirty != 0;
+}
+
 // int GStorageEngine::finishTrans() {
 //   thread_local auto id = std::this_thread::get_id();
 //   if (_txns.count(id) == 0) return ECode_TRANSTION_Not_Exist;
@@ -11,6 +11,8 @@
 #include "base/Future.h"
 #include "gqlite.h"
 #include "StorageEngine.h"
+#include "IndexBuilder.h"
+#include "Importer.h"
 #include "plan/Plan.h"
 #include "plan/mutate/RemovePlan.h"
 #include "plan/mutate/UtilPlan.h"
@@ -19,8 +21,10 @@
 #include "plan/query/ScanPlan.h"
 #include "plan/query/PathPlan.h"
 #include "VirtualNetwork.h"
+#include "Statement.h"
 #include "schedule/DefaultSchedule.h"
 
+#include <algorithm>
 #include <cstdint>
 
 void init_result_info(gqlite_result& result, const std::vector<std::string>& info) {
@@ -46,6 +50,8 @@ const char* GVirtualEngine::GetErrorInfo(int code)
   {
   case GQL_GRAMMAR_ARRAY_FAIL:
     return "array is not correct format";
+  case GQL_GRAMMAR_PARAMETER_FAIL:
+    return "parameter is only used in prepared statement";
   default:
     return nullptr;
   }
@@ -133,9 +139,33 @@ int GVirtualEngine::execAST(GListNode* ast) {
   PlanList* plans = makePlans(ast);
   int ret = executePlans(plans);
   cleanPlans(plans);
+  buildIndexes();
   return ret;
 }
 
+bool GVirtualEngine::keepAST(GListNode* ast) {
+  if (!_statement) return false;
+  _statement->keep(ast);
+  return true;
+}
+
+GListNode* GVirtualEngine::makeParameter(int index) {
+  GListNode* node = MakeNode(NodeType::Literal, new GLiteralString("", 0), nullptr);
+  if (_statement) _statement->addParameter(index, node);
+  else _errorCode = GQL_GRAMMAR_PARAMETER_FAIL;
+  return node;
+}
+
+void GVirtualEngine::buildIndexes()
+{
+  // indexes are built by later gql if rows of zero-copy statement are viewed
+  if (!_storage || _storage->isViewPinned()) return;
+  for (auto& index : _storage->getBuildingIndexes()) {
+    GIndexBuilder builder(_storage, index);
+    builder.step();
+  }
+}
+
 int GVirtualEngine::execCommand(GListNode* ast)
 {
   GGQLExpression* expr = (GGQLExpression * )ast->_value;
@@ -151,6 +181,49 @@ int GVirtualEngine::execCommand(GListNode* ast)
     release_result_info(result);
   }
     break;
+  case GGQLExpression::CMDType::VERIFY_INDEX:
+  {
+    // index name may be `group.attr` or `group:attr`
+    std::string name = expr->params();
+    std::replace(name.begin(), name.end(), '.', ':');
+    std::vector<std::string> indexes;
+    for (auto& index : _storage->getIndexes()) {
+      if (name.empty() || index == name) indexes.emplace_back(index);
+    }
+    if (indexes.empty()) return ECode_GQL_Index_Not_Exist;
+    std::vector<std::string> infos;
+    for (auto& index : indexes) {
+      if (_storage->getIndexType(index) == IndexType::Vector) {
+        infos.emplace_back(index + ": skip");
+        continue;
+      }
+      if (!_storage->isIndexReady(index)) {
+        infos.emplace_back(index + ": building");
+        continue;
+      }
+      size_t missing = 0, stale = 0;
+      GIndexWriter writer(_storage, index.substr(0, index.find(':')));
+      writer.verify(index, missing, stale);
+      infos.emplace_back(index + ": missing " + std::to_string(missing) + ", stale " + std::to_string(stale));
+    }
+    _gqlite_result result;
+    init_result_info(result, infos);
+    _result_callback(&result, _handle);
+    release_result_info(result);
+  }
+    break;
+  case GGQLExpression::CMDType::IMPORT:
+  {
+    const auto& args = expr->args();
+    GImporter importer(_storage, args[0], std::vector<std::string>(args.begin() + 1, args.end()));
+    int ret = importer.load(expr->params());
+    if (ret != ECode_Success) return ret;
+    _gqlite_result result;
+    init_result_info(result, { "import " + std::to_string(importer.rows()) + " rows, skip " + std::to_string(importer.skipped()) + " lines" });
+    if (_result_callback) _result_callback(&result, _handle);
+    release_result_info(result);
+  }
+    break;
   default:
     break;
   }
@@ -201,6 +274,13 @@ VisitFlow GVirtualEngine::PlanVisitor::apply(GDumpStmt* stmt, std::list<NodeType
   return VisitFlow::Return;
 }
 
+VisitFlow GVirtualEngine::PlanVisitor::apply(GIndexStmt* stmt, std::list<NodeType>& path)
+{
+  GPlan* plan = new GUtilPlan(_context, stmt);
+  add(plan);
+  return VisitFlow::Return;
+}
+
 VisitFlow GVirtualEngine::PlanVisitor::apply(GRemoveStmt* stmt, std::list<NodeType>& path)
 {
   GPlan* plan = new GRemovePlan(_context, stmt);
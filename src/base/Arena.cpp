@@ -0,0 +1,69 @@
+#include "base/Arena.h"
+#include <cstdint>
+#include <cstring>
+#include "Memory.h"
+
+GArena::GArena(size_t blockSize)
+:_current(0)
+,_offset(0)
+,_blockSize(blockSize ? blockSize : ARENA_BLOCK_SIZE)
+{
+}
+
+GArena::~GArena()
+{
+  for (Block& block : _blocks) {
+    GMemory::deallocate(block._data);
+  }
+}
+
+void* GArena::allocate(size_t size, size_t align)
+{
+  while (_current < _blocks.size()) {
+    Block& block = _blocks[_current];
+    uintptr_t start = (uintptr_t)block._data + _offset;
+    size_t padding = (align - start % align) % align;
+    if (_offset + padding + size <= block._size) {
+      _offset += padding + size;
+      return (void*)(start + padding);
+    }
+    ++_current;
+    _offset = 0;
+  }
+  // a large object gets its own block
+  size_t blockSize = size + align > _blockSize ? size + align : _blockSize;
+  Block block{ (char*)GMemory::allocate((int)blockSize), blockSize };
+  if (!block._data) return nullptr;
+  _blocks.push_back(block);
+  _current = _blocks.size() - 1;
+  _offset = 0;
+  return allocate(size, align);
+}
+
+char* GArena::copy(const char* data, size_t len)
+{
+  char* dst = (char*)allocate(len + 1, 1);
+  if (!dst) return nullptr;
+  if (len) memcpy(dst, data, len);
+  dst[len] = '\0';
+  return dst;
+}
+
+void GArena::reset()
+{
+  size_t kept = 0;
+  for (Block& block : _blocks) {
+    if (block._size > _blockSize) GMemory::deallocate(block._data);
+    else _blocks[kept++] = block;
+  }
+  _blocks.resize(kept);
+  _current = 0;
+  _offset = 0;
+}
+
+size_t GArena::capacity() const
+{
+  size_t size = 0;
+  for (const Block& block : _blocks) size += block._size;
+  return size;
+}
@@ -0,0 +1,81 @@
+#include "base/BloomFilter.h"
+#include <cstring>
+
+#define BLOOM_BLOCK_WORDS   8
+#define BLOOM_BLOCK_BITS    (BLOOM_BLOCK_WORDS * 64)
+
+GBloomFilter::GBloomFilter(size_t capacity)
+:_capacity(capacity)
+,_count(0)
+{
+  size_t blocks = (capacity * BLOOM_BITS_PER_KEY + BLOOM_BLOCK_BITS - 1) / BLOOM_BLOCK_BITS;
+  if (blocks == 0) blocks = 1;
+  _bits.resize(blocks * BLOOM_BLOCK_WORDS, 0);
+}
+
+uint64_t GBloomFilter::hash(const void* key, size_t len)
+{
+  // FNV-1a with a murmur finalizer, so that short integer keys are mixed well
+  const uint8_t* ptr = (const uint8_t*)key;
+  uint64_t h = 0xcbf29ce484222325ULL;
+  for (size_t idx = 0; idx < len; ++idx) {
+    h ^= ptr[idx];
+    h *= 0x100000001b3ULL;
+  }
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+void GBloomFilter::add(const void* key, size_t len)
+{
+  uint64_t h = hash(key, len);
+  size_t blocks = _bits.size() / BLOOM_BLOCK_WORDS;
+  uint64_t* block = _bits.data() + ((h >> 32) * blocks >> 32) * BLOOM_BLOCK_WORDS;
+  uint32_t a = (uint32_t)h;
+  uint32_t b = (uint32_t)(h >> 17) | 1;
+  for (int i = 0; i < BLOOM_HASH_COUNT; ++i) {
+    uint32_t bit = (a + i * b) % BLOOM_BLOCK_BITS;
+    block[bit / 64] |= (1ULL << (bit % 64));
+  }
+  ++_count;
+}
+
+bool GBloomFilter::mayContain(const void* key, size_t len) const
+{
+  uint64_t h = hash(key, len);
+  size_t blocks = _bits.size() / BLOOM_BLOCK_WORDS;
+  const uint64_t* block = _bits.data() + ((h >> 32) * blocks >> 32) * BLOOM_BLOCK_WORDS;
+  uint32_t a = (uint32_t)h;
+  uint32_t b = (uint32_t)(h >> 17) | 1;
+  for (int i = 0; i < BLOOM_HASH_COUNT; ++i) {
+    uint32_t bit = (a + i * b) % BLOOM_BLOCK_BITS;
+    if ((block[bit / 64] & (1ULL << (bit % 64))) == 0) return false;
+  }
+  return true;
+}
+
+std::string GBloomFilter::serialize() const
+{
+  uint64_t header[2] = { (uint64_t)_capacity, (uint64_t)_count };
+  std::string data((char*)header, sizeof(header));
+  data.append((char*)_bits.data(), _bits.size() * sizeof(uint64_t));
+  return data;
+}
+
+bool GBloomFilter::deserialize(const std::string& data)
+{
+  uint64_t header[2];
+  if (data.size() < sizeof(header)) return false;
+  memcpy(header, data.data(), sizeof(header));
+  size_t words = (data.size() - sizeof(header)) / sizeof(uint64_t);
+  if (words == 0 || words % BLOOM_BLOCK_WORDS != 0) return false;
+  _capacity = header[0];
+  _count = header[1];
+  _bits.resize(words);
+  memcpy(_bits.data(), data.data() + sizeof(header), words * sizeof(uint64_t));
+  return true;
+}
@@ -0,0 +1,63 @@
+#include "base/HyperLogLog.h"
+#include <cmath>
+
+GHyperLogLog::GHyperLogLog(uint8_t precision)
+:_precision(precision)
+{
+  if (_precision < 4) _precision = 4;
+  if (_precision > 18) _precision = 18;
+  _registers.resize((size_t)1 << _precision, 0);
+}
+
+uint64_t GHyperLogLog::hash(const void* key, size_t len)
+{
+  // FNV-1a with a murmur finalizer, the high bits select register
+  const uint8_t* ptr = (const uint8_t*)key;
+  uint64_t h = 0xcbf29ce484222325ULL;
+  for (size_t idx = 0; idx < len; ++idx) {
+    h ^= ptr[idx];
+    h *= 0x100000001b3ULL;
+  }
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+void GHyperLogLog::add(const void* key, size_t len)
+{
+  uint64_t h = hash(key, len);
+  size_t index = h >> (64 - _precision);
+  // rank is position of the first 1 bit in the rest bits
+  uint64_t rest = (h << _precision) | ((uint64_t)1 << (_precision - 1));
+  uint8_t rank = 1;
+  for (; (rest & 0x8000000000000000ULL) == 0; rest <<= 1) ++rank;
+  if (_registers[index] < rank) _registers[index] = rank;
+}
+
+bool GHyperLogLog::merge(const GHyperLogLog& other)
+{
+  if (other._precision != _precision) return false;
+  for (size_t idx = 0; idx < _registers.size(); ++idx) {
+    if (_registers[idx] < other._registers[idx]) _registers[idx] = other._registers[idx];
+  }
+  return true;
+}
+
+size_t GHyperLogLog::estimate() const
+{
+  double m = (double)_registers.size();
+  double alpha = 0.7213 / (1 + 1.079 / m);
+  double sum = 0;
+  size_t zeros = 0;
+  for (uint8_t r : _registers) {
+    sum += std::ldexp(1.0, -(int)r);
+    if (r == 0) ++zeros;
+  }
+  double e = alpha * m * m / sum;
+  // linear counting is more accurate for small cardinality
+  if (e <= 2.5 * m && zeros) e = m * std::log(m / zeros);
+  return (size_t)(e + 0.5);
+}
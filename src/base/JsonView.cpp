@@ -0,0 +1,146 @@
+#include "base/JsonView.h"
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define JSON_VIEW_SSE2
+#endif
+
+namespace {
+  inline bool is_structural(char c, bool inString) {
+    if (inString) return c == '"' || c == '\\';
+    switch (c) {
+    case '"': case '{': case '}': case '[': case ']': case ',': case ':':
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  /**
+   * find next structural character. In a string, only quote and backslash are structural.
+   */
+  const char* next_structural(const char* p, const char* end, bool inString) {
+#ifdef JSON_VIEW_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i slash = _mm_set1_epi8('\\');
+    const __m128i colon = _mm_set1_epi8(':');
+    const __m128i comma = _mm_set1_epi8(',');
+    // '[' | 0x20 == '{' and ']' | 0x20 == '}'
+    const __m128i upper = _mm_set1_epi8(0x20);
+    const __m128i open = _mm_set1_epi8('{');
+    const __m128i close = _mm_set1_epi8('}');
+    while (p + 16 <= end) {
+      __m128i block = _mm_loadu_si128((const __m128i*)p);
+      __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, slash));
+      if (!inString) {
+        __m128i lower = _mm_or_si128(block, upper);
+        hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, colon));
+        hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, comma));
+        hits = _mm_or_si128(hits, _mm_cmpeq_epi8(lower, open));
+        hits = _mm_or_si128(hits, _mm_cmpeq_epi8(lower, close));
+      }
+      int mask = _mm_movemask_epi8(hits);
+      if (mask) {
+        // backslash is out of string only in invalid text, it is rejected by caller
+        for (; mask; mask &= mask - 1) {
+          int offset = __builtin_ctz(mask);
+          if (is_structural(p[offset], inString) || p[offset] == '\\') return p + offset;
+        }
+      }
+      p += 16;
+    }
+#endif
+    for (; p < end; ++p) {
+      if (is_structural(*p, inString) || *p == '\\') return p;
+    }
+    return end;
+  }
+}
+
+GJsonView::GJsonView(const char* data, size_t len)
+:_valid(false)
+{
+  index(data, data + len);
+}
+
+void GJsonView::index(const char* begin, const char* end)
+{
+  int depth = 0;
+  bool expectKey = false;
+  const char* key = nullptr;
+  size_t keyLen = 0;
+  const char* value = nullptr;
+  const char* p = begin;
+  while ((p = next_structural(p, end, false)) < end) {
+    switch (*p) {
+    case '"':
+    {
+      const char* q = p + 1;
+      bool escaped = false;
+      while ((q = next_structural(q, end, true)) < end && *q == '\\') {
+        escaped = true;
+        q += 2;
+      }
+      if (q >= end) return;
+      if (depth == 1 && expectKey) {
+        if (escaped) return;
+        key = p + 1;
+        keyLen = q - key;
+        expectKey = false;
+      }
+      p = q;
+    }
+      break;
+    case '{':
+    case '[':
+      if (depth == 0 && *p != '{') return;
+      if (++depth == 1) expectKey = true;
+      break;
+    case '}':
+    case ']':
+      if (depth == 1) {
+        if (value) _fields.push_back({ key, keyLen, value, (size_t)(p - value) });
+        _valid = true;
+        return;
+      }
+      --depth;
+      break;
+    case ':':
+      if (depth == 1) value = p + 1;
+      break;
+    case ',':
+      if (depth == 1) {
+        if (!value) return;
+        _fields.push_back({ key, keyLen, value, (size_t)(p - value) });
+        value = nullptr;
+        expectKey = true;
+      }
+      break;
+    default:
+      // backslash out of string
+      return;
+    }
+    ++p;
+  }
+}
+
+const GJsonView::Field* GJsonView::find(const std::string& key) const
+{
+  for (auto& field : _fields) {
+    if (field._keyLen == key.size() && memcmp(field._key, key.data(), key.size()) == 0) return &field;
+  }
+  return nullptr;
+}
+
+bool GJsonView::has(const std::string& key) const
+{
+  return find(key) != nullptr;
+}
+
+bool GJsonView::get(const std::string& key, nlohmann::json& value) const
+{
+  const Field* field = find(key);
+  if (!field) return false;
+  value = nlohmann::json::parse(field->_value, field->_value + field->_valueLen);
+  return true;
+}
@@ -0,0 +1,85 @@
+#include "base/QuantileSketch.h"
+#include <algorithm>
+#include <cmath>
+
+GQuantileSketch::GQuantileSketch(uint32_t k)
+:_k(k < 8 ? 8 : k)
+,_count(0)
+,_seed(0x9e3779b97f4a7c15ULL)
+{
+  _levels.resize(1);
+}
+
+uint32_t GQuantileSketch::capacity(size_t level) const
+{
+  // lower levels are smaller, and the top level has k items
+  size_t depth = _levels.size() - 1 - level;
+  uint32_t cap = (uint32_t)std::ceil(_k * std::pow(2.0 / 3.0, (double)depth));
+  return cap < 2 ? 2 : cap;
+}
+
+void GQuantileSketch::add(double value)
+{
+  _levels[0].push_back(value);
+  ++_count;
+  if (_levels[0].size() >= capacity(0)) compress();
+}
+
+void GQuantileSketch::merge(const GQuantileSketch& other)
+{
+  if (_levels.size() < other._levels.size()) _levels.resize(other._levels.size());
+  for (size_t level = 0; level < other._levels.size(); ++level) {
+    _levels[level].insert(_levels[level].end(), other._levels[level].begin(), other._levels[level].end());
+  }
+  _count += other._count;
+  compress();
+}
+
+void GQuantileSketch::compress()
+{
+  for (size_t level = 0; level < _levels.size(); ++level) {
+    if (_levels[level].size() < capacity(level)) continue;
+    if (level + 1 == _levels.size()) _levels.emplace_back();
+    std::vector<double>& items = _levels[level];
+    std::sort(items.begin(), items.end());
+    // an odd item stays, so that weight is not lost
+    double rest = 0;
+    bool odd = items.size() % 2;
+    if (odd) {
+      rest = items.back();
+      items.pop_back();
+    }
+    _seed ^= _seed << 13;
+    _seed ^= _seed >> 7;
+    _seed ^= _seed << 17;
+    size_t offset = _seed & 1;
+    std::vector<double>& upper = _levels[level + 1];
+    for (size_t idx = offset; idx < items.size(); idx += 2) {
+      upper.push_back(items[idx]);
+    }
+    items.clear();
+    if (odd) items.push_back(rest);
+  }
+}
+
+double GQuantileSketch::quantile(double q) const
+{
+  std::vector<std::pair<double, uint64_t>> items;
+  uint64_t total = 0;
+  for (size_t level = 0; level < _levels.size(); ++level) {
+    for (double value : _levels[level]) {
+      items.emplace_back(value, (uint64_t)1 << level);
+      total += (uint64_t)1 << level;
+    }
+  }
+  if (items.empty()) return NAN;
+  std::sort(items.begin(), items.end());
+  q = std::min(std::max(q, 0.0), 1.0);
+  double target = q * total;
+  uint64_t weight = 0;
+  for (auto& item : items) {
+    weight += item.second;
+    if (weight >= target) return item.first;
+  }
+  return items.back().first;
+}
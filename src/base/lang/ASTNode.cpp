@@ -53,6 +53,7 @@ void FreeNodeImpl(GListNode* node) {
     DELETE_OBJECT(GroupStatement);
     DELETE_OBJECT(MemberExpression);
     DELETE_OBJECT(DumpStatement);
+    DELETE_OBJECT(IndexStatement);
     DELETE_OBJECT(LambdaExpression);
     DELETE_OBJECT(BlockStatement);
     DELETE_OBJECT(VariableDeclaration);
@@ -107,6 +108,7 @@ std::string NodeType2String(NodeType nt) {
     RETURN_CASE_NODE_TYPE(GQLExpression);
     RETURN_CASE_NODE_TYPE(CallExpression);
     RETURN_CASE_NODE_TYPE(CreationStatement);
+    RETURN_CASE_NODE_TYPE(IndexStatement);
     RETURN_CASE_NODE_TYPE(UpsetStatement);
     RETURN_CASE_NODE_TYPE(QueryStatement);
     RETURN_CASE_NODE_TYPE(VertexDeclaration);
@@ -441,6 +443,12 @@ VisitFlow accept(GListNode* node, GVisitor* visitor, std::list<NodeType>& path)
       vf = visitor->apply(ptr, path);
     }
     break;
+    case NodeType::IndexStatement:
+    {
+      GTypeTraits<NodeType::IndexStatement>::type* ptr = reinterpret_cast<GTypeTraits<NodeType::IndexStatement>::type*>(node->_value);
+      vf = visitor->apply(ptr, path);
+    }
+    break;
     case NodeType::RemoveStatement:
     {
       GTypeTraits<NodeType::RemoveStatement>::type* value = reinterpret_cast<GTypeTraits<NodeType::RemoveStatement>::type*>(node->_value);
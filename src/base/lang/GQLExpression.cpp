@@ -2,9 +2,10 @@
 #include "base/lang/GQLExpression.h"
 #include "base/lang/ASTNode.h"
 
-GGQLExpression::GGQLExpression(CMDType type, const std::string& params)
+GGQLExpression::GGQLExpression(CMDType type, const std::string& params, const std::vector<std::string>& args)
   :_cmdType(type)
   ,_params(params)
+  ,_args(args)
 {
 }
 
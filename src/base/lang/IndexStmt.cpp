@@ -1,3 +1,21 @@
 #include "base/lang/IndexStmt.h"
+#include "base/lang/ASTNode.h"
 
-GIndexStmt::GIndexStmt() {}
+GIndexStmt::GIndexStmt(const std::string& graph, const std::string& index, GListNode* includes, uint64_t interval)
+:_graph(graph)
+,_includes(includes)
+,_interval(interval)
+{
+  size_t pos = index.find('.');
+  if (pos != std::string::npos) {
+    _group = index.substr(0, pos);
+    _attr = index.substr(pos + 1);
+  }
+  else {
+    _attr = index;
+  }
+}
+
+GIndexStmt::~GIndexStmt() {
+  FreeNode(_includes);
+}
@@ -1,14 +1,16 @@
 #include "base/lang/QueryStmt.h"
 #include "base/lang/ASTNode.h"
 
-GQueryStmt::GQueryStmt(GListNode* query, GListNode* graph, GListNode* conditions)
+GQueryStmt::GQueryStmt(GListNode* query, GListNode* graph, GListNode* conditions, GListNode* options)
 :_query(query)
 ,_graph(graph)
-,_conditions(conditions){
+,_conditions(conditions)
+,_options(options){
 }
 
 GQueryStmt::~GQueryStmt() {
   FreeNode(_query);
   FreeNode(_graph);
   FreeNode(_conditions);
+  FreeNode(_options);
 }
\ No newline at end of file
@@ -20,4 +20,10 @@ GEdgeRemoveStmt::GEdgeRemoveStmt(const std::string& name, GListNode* array)
 : GRemoveStmt(name, array)
 {
   _type = Edge;
+}
+
+GExpireStmt::GExpireStmt(const std::string& name, GListNode* condition)
+: GRemoveStmt(name, condition)
+{
+  _type = Expire;
 }
\ No newline at end of file
@@ -47,6 +47,12 @@ EntityNode* GWalkVisitor::makeNodeCondition(const std::string& str) {
   return node;
 }
 
+EntityNode* GWalkVisitor::makeNodeCondition(GListNode* condition) {
+  EntityNode* node = new EntityNode;
+  node->_condition = condition;
+  return node;
+}
+
 VisitFlow GWalkVisitor::apply(GWalkDeclaration* walk, std::list<NodeType>& _) {
   auto order = walk->order();
   EntityNode* node = nullptr;
@@ -57,7 +63,8 @@ VisitFlow GWalkVisitor::apply(GWalkDeclaration* walk, std::list<NodeType>& _) {
       accept(element, this, _);
     }
     else {
-      std::string str = GetString(element);
+      // endpoint is a filter of vertexes' attributes
+      std::string str = (element->_nodetype == NodeType::ArrayExpression) ? "" : GetString(element);
       int dir = 0;
 
       if (str == "--" || str == "->") {
@@ -67,7 +74,7 @@ VisitFlow GWalkVisitor::apply(GWalkDeclaration* walk, std::list<NodeType>& _) {
         makeEdgeCondition(order, nullptr, node, 1);
       }
       else {
-        node = makeNodeCondition(str);
+        node = (element->_nodetype == NodeType::ArrayExpression) ? makeNodeCondition(element) : makeNodeCondition(str);
         auto& edges = _graph->_edges;
         if (edges.size()) {
           auto& lastEdge = edges.back();
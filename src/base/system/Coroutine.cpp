@@ -26,7 +26,8 @@ void __coroutine_entry(transfer_t t) {
   GCoroutine* c = schedule->_coroutines[id];
   c->_func(c);
   c->_status = GCoroutine::Status::Finish;
-  jump_fcontext(t.fctx, t.data);
+  // coroutine may be resumed by another context after it yield
+  jump_fcontext(schedule->_main, t.data);
 }
 
 void GCoroutine::init(std::function<void(GCoroutine*)> const& func) {
@@ -66,7 +67,8 @@ void GCoroutine::yield() {
   if (_status == Status::Running) {
     _status = Status::Suspend;
     transfer_t t = jump_fcontext(_schedule->_main, nullptr);
-    _ctx = t.fctx;
+    // context of caller that resume it
+    _schedule->_main = t.fctx;
   }
 }
 
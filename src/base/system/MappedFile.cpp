@@ -0,0 +1,88 @@
+#include "base/system/MappedFile.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+GMappedFile::GMappedFile()
+:_data(nullptr)
+,_size(0)
+#ifdef _WIN32
+,_file(INVALID_HANDLE_VALUE)
+,_mapping(nullptr)
+#else
+,_fd(-1)
+#endif
+{
+}
+
+GMappedFile::~GMappedFile()
+{
+  close();
+}
+
+bool GMappedFile::open(const std::string& path)
+{
+  close();
+#ifdef _WIN32
+  _file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (_file == INVALID_HANDLE_VALUE) return false;
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(_file, &size)) {
+    close();
+    return false;
+  }
+  _size = (size_t)size.QuadPart;
+  if (_size == 0) return true;
+  _mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (_mapping == nullptr) {
+    close();
+    return false;
+  }
+  _data = (const char*)MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+  _fd = ::open(path.c_str(), O_RDONLY);
+  if (_fd < 0) return false;
+  struct stat st;
+  if (fstat(_fd, &st) != 0) {
+    close();
+    return false;
+  }
+  _size = (size_t)st.st_size;
+  if (_size == 0) return true;
+  void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _fd, 0);
+  if (data == MAP_FAILED) {
+    close();
+    return false;
+  }
+  // file is read from begin to end by every chunk
+  madvise(data, _size, MADV_SEQUENTIAL);
+  _data = (const char*)data;
+#endif
+  if (_data == nullptr) {
+    close();
+    return false;
+  }
+  return true;
+}
+
+void GMappedFile::close()
+{
+#ifdef _WIN32
+  if (_data) UnmapViewOfFile(_data);
+  if (_mapping) CloseHandle(_mapping);
+  if (_file != INVALID_HANDLE_VALUE) CloseHandle(_file);
+  _mapping = nullptr;
+  _file = INVALID_HANDLE_VALUE;
+#else
+  if (_data) munmap((void*)_data, _size);
+  if (_fd >= 0) ::close(_fd);
+  _fd = -1;
+#endif
+  _data = nullptr;
+  _size = 0;
+}
@@ -102,19 +102,21 @@ void emit() {}
 %token <__c> VAR_BASE64 LITERAL_STRING VAR_NAME LITERAL_PATH
 %token <__f> VAR_INTEGER
 %token <__datetime> VAR_DATETIME
+%token <__int> VAR_PARAMETER
 %token <node> KW_VERTEX KW_EDGE
 %token QUOTE STAR
 %token KW_AST KW_ID KW_GRAPH KW_COMMIT
 %token KW_CREATE KW_DROP KW_IN KW_REMOVE KW_UPSET left_arrow right_arrow KW_BIDIRECT_RELATION KW_REST KW_DELETE
 %token OP_QUERY KW_INDEX OP_WHERE OP_GEOMETRY neighbor
-%token group dump import
-%token CMD_SHOW 
+%token group dump import include KW_INTERVAL KW_EXPIRE KW_INTO
+%token CMD_SHOW CMD_VERIFY
 %token OP_GREAT_THAN OP_LESS_THAN OP_GREAT_THAN_EQUAL OP_LESS_THAN_EQUAL equal AND OR OP_NEAR
 %token SKIP
 %token FUNCTION_ARROW RETURN IF ELSE LET
-%token limit profile property
+%token limit profile property KW_SKIP KW_ORDER KW_BY
 
 %type <var_name> a_edge
+%type <__c> property_key
 %type <node> a_graph_expr
 %type <node> normal_json
 %type <node> normal_value number right_value simple_value geometry_condition range_comparable datetime_comparable range_comparable_obj
@@ -125,14 +127,14 @@ void emit() {}
 %type <node> where_expr a_walk vertex_start_walk edge_start_walk a_simple_graph condition_vertex a_walk_range
 %type <node> normal_property condition_property
 %type <node> gql
-%type <node> creation dump_graph
+%type <node> creation dump_graph create_index
 %type <node> upset_vertexes vertex_list vertexes vertex
 %type <node> a_simple_query query_kind_expr a_match match_expr
-%type <node> query_kind
-%type <node> a_graph_properties graph_property graph_properties
+%type <node> query_kind query_options query_option
+%type <node> a_graph_properties graph_property graph_properties aggregate_expr
 %type <node> a_value
 %type <node> a_group group_list groups vertex_group edge_group
-%type <node> drop_graph remove_vertexes remove_edges
+%type <node> drop_graph remove_vertexes remove_edges expire_vertexes
 %type <node> upset_edges edge_pattern connection a_link_condition
 %type <node> links link condition_links condition_link_item condition_link
 %type <node> key string_list strings intergers a_vector number_list
@@ -151,8 +153,11 @@ line_list: line_list line ';' {}
 comment: SKIP{};
 line: gql
           {
-            stm._errorCode = stm.execAST($1);
-            FreeNode($1);
+            // a statement that is being created keeps AST, and executes it later
+            if (!stm.keepAST($1)) {
+              stm._errorCode = stm.execAST($1);
+              FreeNode($1);
+            }
           }
         | utility_cmd { stm._cmdtype = GQL_Util; }
         ;
@@ -181,6 +186,7 @@ gql: creation
           }
         | remove_vertexes { $$ = $1; stm._cmdtype = GQL_Remove; }
         | remove_edges { $$ = $1; stm._cmdtype = GQL_Remove; }
+        | expire_vertexes { $$ = $1; stm._cmdtype = GQL_Remove; }
         | drop_graph
           {
             GGQLExpression* expr = new GGQLExpression();
@@ -193,6 +199,12 @@ gql: creation
             $$ = MakeNode(NodeType::GQLExpression, expr, $1);
             stm._cmdtype = GQL_Util;
           }
+        | create_index
+          {
+            GGQLExpression* expr = new GGQLExpression();
+            $$ = MakeNode(NodeType::GQLExpression, expr, $1);
+            stm._cmdtype = GQL_Creation;
+          }
         ;
 utility_cmd: CMD_SHOW KW_GRAPH
           {
@@ -211,6 +223,21 @@ utility_cmd: CMD_SHOW KW_GRAPH
             stm._errorCode = stm.execCommand(ast);
             FreeNode(ast);
           }
+        | CMD_VERIFY KW_INDEX
+          {
+            GGQLExpression* expr = new GGQLExpression(GGQLExpression::CMDType::VERIFY_INDEX);
+            auto ast = MakeNode(NodeType::GQLExpression, expr, nullptr);
+            stm._errorCode = stm.execCommand(ast);
+            FreeNode(ast);
+          }
+        | CMD_VERIFY KW_INDEX LITERAL_STRING
+          {
+            GGQLExpression* expr = new GGQLExpression(GGQLExpression::CMDType::VERIFY_INDEX, $3);
+            free($3);
+            auto ast = MakeNode(NodeType::GQLExpression, expr, nullptr);
+            stm._errorCode = stm.execCommand(ast);
+            FreeNode(ast);
+          }
         | KW_AST gql
           {
             fmt::print("AST:\n");
@@ -222,9 +249,31 @@ utility_cmd: CMD_SHOW KW_GRAPH
             stm._cmdtype = GQL_Util;
           }
         | profile gql {}
-        | import LITERAL_PATH
+        | import LITERAL_STRING KW_INTO LITERAL_STRING
           {
+            GGQLExpression* expr = new GGQLExpression(GGQLExpression::CMDType::IMPORT, $2, { $4 });
             free($2);
+            free($4);
+            auto ast = MakeNode(NodeType::GQLExpression, expr, nullptr);
+            stm._errorCode = stm.execCommand(ast);
+            FreeNode(ast);
+            stm._cmdtype = GQL_Util;
+          }
+        | import LITERAL_STRING KW_INTO LITERAL_STRING '(' strings ')'
+          {
+            // names of columns, such as `id`, `from`, `to` or attribute
+            std::vector<std::string> args = { $4 };
+            GArrayExpression* array = (GArrayExpression*)$6->_value;
+            for (auto itr = array->begin(); itr != array->end(); ++itr) {
+              args.emplace_back(((GLiteral*)(*itr)->_value)->raw());
+            }
+            GGQLExpression* expr = new GGQLExpression(GGQLExpression::CMDType::IMPORT, $2, args);
+            free($2);
+            free($4);
+            FreeNode($6);
+            auto ast = MakeNode(NodeType::GQLExpression, expr, nullptr);
+            stm._errorCode = stm.execCommand(ast);
+            FreeNode(ast);
             stm._cmdtype = GQL_Util;
           }
         ;
@@ -240,6 +289,30 @@ creation: '{' KW_CREATE ':' LITERAL_STRING ',' groups '}'
                 free($4);
               }
         ;
+create_index: '{' KW_CREATE ':' LITERAL_STRING ',' KW_INDEX ':' LITERAL_STRING '}'
+              {
+                GIndexStmt* stmt = new GIndexStmt($4, $8);
+                free($4);
+                free($8);
+                $$ = MakeNode(NodeType::IndexStatement, stmt, nullptr);
+                stm._errorCode = ECode_Success;
+              }
+        | '{' KW_CREATE ':' LITERAL_STRING ',' KW_INDEX ':' LITERAL_STRING ',' include ':' string_list '}'
+              {
+                GIndexStmt* stmt = new GIndexStmt($4, $8, $12);
+                free($4);
+                free($8);
+                $$ = MakeNode(NodeType::IndexStatement, stmt, nullptr);
+                stm._errorCode = ECode_Success;
+              }
+        | '{' KW_CREATE ':' LITERAL_STRING ',' KW_INDEX ':' LITERAL_STRING ',' KW_INTERVAL ':' VAR_INTEGER '}'
+              {
+                GIndexStmt* stmt = new GIndexStmt($4, $8, nullptr, (uint64_t)$12);
+                free($4);
+                free($8);
+                $$ = MakeNode(NodeType::IndexStatement, stmt, nullptr);
+                stm._errorCode = ECode_Success;
+              };
 dump_graph: '{' dump ':' LITERAL_STRING '}'
               {
                 GDumpStmt* stmt = new GDumpStmt($4);
@@ -279,6 +352,12 @@ remove_edges: '{' KW_REMOVE ':' LITERAL_STRING ',' KW_EDGE ':' condition_links '
                 free($4);
                 $$ = MakeNode(NodeType::RemoveStatement, rmStmt, nullptr);
               };
+expire_vertexes: '{' KW_EXPIRE ':' LITERAL_STRING ',' where_expr '}'
+              {
+                GRemoveStmt* rmStmt = new GExpireStmt($4, $6);
+                free($4);
+                $$ = MakeNode(NodeType::RemoveStatement, rmStmt, nullptr);
+              };
 upset_edges: '{' KW_UPSET ':' LITERAL_STRING ',' KW_EDGE ':' link '}'
               {
                 GUpsetStmt* upsetStmt = new GUpsetStmt($4, $8);
@@ -376,6 +455,61 @@ a_simple_query:
                   GQueryStmt* queryStmt = new GQueryStmt($2, $4, $6);
                   $$ = MakeNode(NodeType::QueryStatement, queryStmt, nullptr);
                   stm._errorCode = ECode_Success;
+                }
+        |  '{' query_kind ',' a_graph_expr ',' query_options '}'
+                {
+                  GQueryStmt* queryStmt = new GQueryStmt($2, $4, nullptr, $6);
+                  $$ = MakeNode(NodeType::QueryStatement, queryStmt, nullptr);
+                  stm._errorCode = ECode_Success;
+                }
+        | '{' query_kind ',' a_graph_expr ',' where_expr ',' query_options '}'
+                {
+                  GQueryStmt* queryStmt = new GQueryStmt($2, $4, $6, $8);
+                  $$ = MakeNode(NodeType::QueryStatement, queryStmt, nullptr);
+                  stm._errorCode = ECode_Success;
+                };
+query_options: query_option
+                {
+                  GArrayExpression* options = new GArrayExpression();
+                  options->addElement($1);
+                  $$ = MakeNode(NodeType::ArrayExpression, options, nullptr);
+                }
+        | query_options ',' query_option
+                {
+                  GArrayExpression* options = (GArrayExpression*)$1->_value;
+                  options->addElement($3);
+                  $$ = $1;
+                };
+query_option: limit ':' VAR_INTEGER
+                {
+                  GProperty* prop = new GProperty("limit", INIT_NUMBER_AST($3, AttributeKind::Integer));
+                  $$ = MakeNode(NodeType::Property, prop, nullptr);
+                }
+        | KW_SKIP ':' VAR_INTEGER
+                {
+                  GProperty* prop = new GProperty("skip", INIT_NUMBER_AST($3, AttributeKind::Integer));
+                  $$ = MakeNode(NodeType::Property, prop, nullptr);
+                }
+        | KW_ORDER ':' LITERAL_STRING
+                {
+                  GProperty* order = new GProperty($3, INIT_STRING_AST("asc"));
+                  free($3);
+                  GProperty* prop = new GProperty("order", MakeNode(NodeType::Property, order, nullptr));
+                  $$ = MakeNode(NodeType::Property, prop, nullptr);
+                }
+        | KW_ORDER ':' '{' VAR_NAME ':' LITERAL_STRING '}'
+                {
+                  GProperty* order = new GProperty($4, INIT_STRING_AST($6));
+                  free($4);
+                  free($6);
+                  GProperty* prop = new GProperty("order", MakeNode(NodeType::Property, order, nullptr));
+                  $$ = MakeNode(NodeType::Property, prop, nullptr);
+                }
+        | KW_BY ':' LITERAL_STRING
+                {
+                  GProperty* prop = new GProperty("by", INIT_STRING_AST($3));
+                  free($3);
+                  $$ = MakeNode(NodeType::Property, prop, nullptr);
                 };
 a_simple_graph: a_walk_range
                 {
@@ -494,6 +628,7 @@ number: VAR_DECIMAL { $$ = INIT_NUMBER_AST($1, AttributeKind::Number); }
         | VAR_INTEGER { $$ = INIT_NUMBER_AST($1, AttributeKind::Integer); };
 a_graph_properties:
           graph_property { $$ = $1; }
+        | aggregate_expr { $$ = $1; }
         | '[' graph_properties ']' { $$ = $2; }
         | error ']'
           {
@@ -511,6 +646,18 @@ graph_properties:
                 $$ = MakeNode(NodeType::ArrayExpression, array, nullptr);
               }
         | graph_properties ',' graph_property
+              {
+                GArrayExpression* array = (GArrayExpression*)$1->_value;
+                array->addElement($3);
+                $$ = $1;
+              }
+        | aggregate_expr
+              {
+                GArrayExpression* array = new GArrayExpression();
+                array->addElement($1);
+                $$ = MakeNode(NodeType::ArrayExpression, array, nullptr);
+              }
+        | graph_properties ',' aggregate_expr
               {
                 GArrayExpression* array = (GArrayExpression*)$1->_value;
                 array->addElement($3);
@@ -537,6 +684,43 @@ graph_property:
                 free($1);
               }
         ;
+aggregate_expr:
+          VAR_NAME '(' VAR_NAME ')'
+              {
+                // aggregate of rows, such as `count(g)`
+                GObjectFunction* obj = new GObjectFunction();
+                obj->setFunctionName($1, "");
+                obj->addFunctionParam(INIT_STRING_AST($3));
+                free($3);
+                free($1);
+                $$ = MakeNode(NodeType::CallExpression, obj, nullptr);
+              }
+        |  VAR_NAME '(' VAR_NAME '.' VAR_NAME ')'
+              {
+                // aggregate of attribute, such as `avg(g.rating)`
+                GObjectFunction* obj = new GObjectFunction();
+                obj->setFunctionName($1, "");
+                GMemberExpression* expr = new GMemberExpression(INIT_STRING_AST($3), INIT_STRING_AST($5));
+                obj->addFunctionParam(MakeNode(NodeType::MemberExpression, expr, nullptr));
+                free($5);
+                free($3);
+                free($1);
+                $$ = MakeNode(NodeType::CallExpression, obj, nullptr);
+              }
+        |  VAR_NAME '(' VAR_NAME '.' VAR_NAME ',' number ')'
+              {
+                // aggregate of attribute with a parameter, such as `approx_quantile(g.rating, 0.5)`
+                GObjectFunction* obj = new GObjectFunction();
+                obj->setFunctionName($1, "");
+                GMemberExpression* expr = new GMemberExpression(INIT_STRING_AST($3), INIT_STRING_AST($5));
+                obj->addFunctionParam(MakeNode(NodeType::MemberExpression, expr, nullptr));
+                obj->addFunctionParam($7);
+                free($5);
+                free($3);
+                free($1);
+                $$ = MakeNode(NodeType::CallExpression, obj, nullptr);
+              }
+        ;
 vertex_list: '[' vertexes ']'
               {
                 $$ = $2;
@@ -569,6 +753,11 @@ vertex: '[' LITERAL_STRING ',' normal_json ']'
                 GVertexDeclaration* decl = new GVertexDeclaration(INIT_NUMBER_AST($2, AttributeKind::Integer), $4);
                 $$ = MakeNode(NodeType::VertexDeclaration, decl, nullptr);
               }
+        | '[' VAR_PARAMETER ',' normal_json ']'
+              {
+                GVertexDeclaration* decl = new GVertexDeclaration(stm.makeParameter($2), $4);
+                $$ = MakeNode(NodeType::VertexDeclaration, decl, nullptr);
+              }
         | key
               {
                 GVertexDeclaration* decl = new GVertexDeclaration($1, nullptr);
@@ -669,7 +858,8 @@ simple_value: VAR_BASE64
         | number
               {
                 $$ = $1;
-              };
+              }
+        | VAR_PARAMETER { $$ = stm.makeParameter($1); };
 normal_object: '{' normal_properties '}'
             {
               $$ = $2;
@@ -709,25 +899,25 @@ condition_properties: condition_property
                 props->addElement($3);
                 $$ = $1;
               };
-normal_property: VAR_NAME ':' simple_value
+normal_property: property_key ':' simple_value
               {
                 GProperty* prop = new GProperty($1, $3);
                 free($1);
                 $$ = MakeNode(NodeType::Property, prop, nullptr);
               }
-        | VAR_NAME ':' normal_value
+        | property_key ':' normal_value
               {
                 GProperty* prop = new GProperty($1, $3);
                 free($1);
                 $$ = MakeNode(NodeType::Property, prop, nullptr);
               };
-condition_property: VAR_NAME ':' right_value
+condition_property: property_key ':' right_value
               {
                 GProperty* prop = new GProperty($1, $3);
                 free($1);
                 $$ = MakeNode(NodeType::Property, prop, nullptr);
               }
-        | VAR_NAME ':' STAR
+        | property_key ':' STAR
               {
                 GProperty* prop = new GProperty($1, INIT_STRING_AST("*"));
                 free($1);
@@ -764,6 +954,16 @@ condition_property: VAR_NAME ':' right_value
                 GProperty* prop = new GProperty("near", $4);
                 $$ = MakeNode(NodeType::ObjectExpression, prop, nullptr);
               };
+/* option keywords are still valid attribute names */
+property_key: VAR_NAME { $$ = $1; }
+        | KW_SKIP { $$ = strdup("skip"); }
+        | KW_BY { $$ = strdup("by"); }
+        | KW_ORDER { $$ = strdup("order"); }
+        | KW_INTO { $$ = strdup("into"); }
+        | KW_INTERVAL { $$ = strdup("interval"); }
+        | KW_EXPIRE { $$ = strdup("expire"); }
+        | include { $$ = strdup("include"); }
+        | CMD_VERIFY { $$ = strdup("verify"); };
 range_comparable: OP_GREAT_THAN_EQUAL ':' range_comparable_obj
               {
                 GProperty* prop = new GProperty("gte", $3);
@@ -785,6 +985,7 @@ range_comparable: OP_GREAT_THAN_EQUAL ':' range_comparable_obj
                 $$ = MakeNode(NodeType::ObjectExpression, prop, nullptr);
               };
 range_comparable_obj: number { $$ = $1; }
+        | VAR_PARAMETER { $$ = stm.makeParameter($1); }
         | lambda_expr { $$ = $1; };
 datetime_comparable: OP_GREAT_THAN_EQUAL ':' VAR_DATETIME
               {
@@ -914,7 +1115,8 @@ a_value:  LITERAL_STRING
         | VAR_DECIMAL { $$ = INIT_NUMBER_AST($1, AttributeKind::Number); }
         | VAR_INTEGER { $$ = INIT_NUMBER_AST($1, AttributeKind::Integer); };
 key: VAR_INTEGER { $$ = INIT_NUMBER_AST($1, AttributeKind::Integer); }
-        | LITERAL_STRING { $$ = INIT_STRING_AST($1); free($1);};
+        | LITERAL_STRING { $$ = INIT_STRING_AST($1); free($1);}
+        | VAR_PARAMETER { $$ = stm.makeParameter($1); };
 /* ---------------- Graph Script --------------- */
 call_expr
         : VAR_NAME function_arg_stmt
@@ -2,6 +2,9 @@
 #include "GQliteImpl.h"
 #include <atomic>
 #include "VirtualEngine.h"
+#include "Statement.h"
+#include "BulkLoader.h"
+#include "Snapshot.h"
 #include "Error.h"
 #include "Memory.h"
 #include "json.hpp"
@@ -16,6 +19,9 @@
 #define Group_Not_Exist_ERROR   "group is not exist"
 #define Index_Not_Exist_ERROR   "index %s is not exist"
 #define GRAMMAR_ARRAY_ERROR     "input array seems not correct"
+#define GRAMMAR_PARAMETER_ERROR "parameter is only used in prepared statement"
+#define Parameter_Not_Exist_ERROR "parameter is not exist"
+#define Parameter_Not_Bound_ERROR "parameter is not bound"
 
 std::atomic<bool> _gqlite_g_close_flag_(false);
 
@@ -32,6 +38,13 @@ namespace {
     }
   }
 
+  gkey_t to_key(const gqlite_vertex* vertex) {
+    gkey_t key;
+    if (vertex->type == gqlite_id_type::bytes) key = std::string(vertex->cid);
+    else key = vertex->uid;
+    return key;
+  }
+
   char* simple_message(const char* message) {
     size_t len = strlen(message) + 1;
     char* msg = (char*)GMemory::allocate(len);
@@ -102,14 +115,186 @@ SYMBOL_EXPORT int gqlite_version(gqlite* ppDb, int* major, int* minor, int* patc
 SYMBOL_EXPORT int gqlite_create(gqlite* pDb, const char* gql, gqlite_statement** statement)
 {
   CHECK_NULL_PTR(pDb);
+  CHECK_NULL_PTR(gql);
+  CHECK_NULL_PTR(statement);
   GQLiteImpl* impl = (GQLiteImpl*)pDb;
-  return 0;
+  GStatement* ptr = nullptr;
+  int ret = impl->prepare(gql, false, ptr);
+  *statement = (gqlite_statement*)ptr;
+  return ret;
+}
+
+SYMBOL_EXPORT int gqlite_prepare(gqlite* pDb, const char* gql, gqlite_statement** statement)
+{
+  CHECK_NULL_PTR(pDb);
+  CHECK_NULL_PTR(gql);
+  CHECK_NULL_PTR(statement);
+  GQLiteImpl* impl = (GQLiteImpl*)pDb;
+  GStatement* ptr = nullptr;
+  int ret = impl->prepare(gql, true, ptr);
+  *statement = (gqlite_statement*)ptr;
+  return ret;
+}
+
+SYMBOL_EXPORT int gqlite_bind_int(gqlite* pDb, gqlite_statement* statement, int index, int64_t value)
+{
+  CHECK_NULL_PTR(pDb);
+  CHECK_NULL_PTR(statement);
+  return ((GStatement*)statement)->bind(index, value);
+}
+
+SYMBOL_EXPORT int gqlite_bind_double(gqlite* pDb, gqlite_statement* statement, int index, double value)
+{
+  CHECK_NULL_PTR(pDb);
+  CHECK_NULL_PTR(statement);
+  return ((GStatement*)statement)->bind(index, value);
+}
+
+SYMBOL_EXPORT int gqlite_bind_text(gqlite* pDb, gqlite_statement* statement, int index, const char* text, int len)
+{
+  CHECK_NULL_PTR(pDb);
+  CHECK_NULL_PTR(statement);
+  CHECK_NULL_PTR(text);
+  size_t size = len < 0 ? strlen(text) : (size_t)len;
+  return ((GStatement*)statement)->bind(index, text, size);
 }
 
 SYMBOL_EXPORT int gqlite_execute(gqlite* pDb, gqlite_statement* statement)
 {
   CHECK_NULL_PTR(pDb);
-  return 0;
+  CHECK_NULL_PTR(statement);
+  return ((GStatement*)statement)->execute();
+}
+
+SYMBOL_EXPORT int gqlite_next(gqlite* pDb, gqlite_statement* statement, gqlite_result** result)
+{
+  CHECK_NULL_PTR(pDb);
+  CHECK_NULL_PTR(statement);
+  CHECK_NULL_PTR(result);
+  return ((GStatement*)statement)->next(result);
+}
+
+SYMBOL_EXPORT int gqlite_prefetch(gqlite* pDb, gqlite_statement* statement, uint32_t count)
+{
+  CHECK_NULL_PTR(pDb);
+  CHECK_NULL_PTR(statement);
+  ((GStatement*)statement)->setPrefetch(count);
+  return ECode_Success;
+}
+
+SYMBOL_EXPORT int gqlite_zero_copy(gqlite* pDb, gqlite_statement* statement, bool enable)
+{
+  CHECK_NULL_PTR(pDb);
+  CHECK_NULL_PTR(statement);
+  ((GStatement*)statement)->setZeroCopy(enable);
+  return ECode_Success;
+}
+
+SYMBOL_EXPORT int gqlite_columnar(gqlite* pDb, gqlite_statement* statement, bool enable)
+{
+  CHECK_NULL_PTR(pDb);
+  CHECK_NULL_PTR(statement);
+  ((GStatement*)statement)->setColumnar(enable);
+  return ECode_Success;
+}
+
+SYMBOL_EXPORT int gqlite_bulk_begin(gqlite* pDb, const char* group, gqlite_bulk** bulk)
+{
+  CHECK_NULL_PTR(pDb);
+  CHECK_NULL_PTR(group);
+  CHECK_NULL_PTR(bulk);
+  GQLiteImpl* impl = (GQLiteImpl*)pDb;
+  GStorageEngine* storage = impl->engine()->storage();
+  CHECK_NULL_PTR(storage);
+  GBulkLoader* loader = new GBulkLoader(storage, group);
+  int ret = loader->begin();
+  if (ret != ECode_Success) {
+    delete loader;
+    loader = nullptr;
+  }
+  *bulk = (gqlite_bulk*)loader;
+  return ret;
+}
+
+SYMBOL_EXPORT int gqlite_bulk_vertex(gqlite* pDb, gqlite_bulk* bulk, const gqlite_vertex* vertex, const gqlite_field* fields, uint32_t count)
+{
+  CHECK_NULL_PTR(pDb);
+  CHECK_NULL_PTR(bulk);
+  CHECK_NULL_PTR(vertex);
+  if (vertex->type == gqlite_id_type::bytes) CHECK_NULL_PTR(vertex->cid);
+  return ((GBulkLoader*)bulk)->addVertex(to_key(vertex), GBulkLoader::toRow(fields, fields ? count : 0));
+}
+
+SYMBOL_EXPORT int gqlite_bulk_edge(gqlite* pDb, gqlite_bulk* bulk, const gqlite_vertex* from, const gqlite_vertex* to, bool direction, const gqlite_field* fields, uint32_t count)
+{
+  CHECK_NULL_PTR(pDb);
+  CHECK_NULL_PTR(bulk);
+  CHECK_NULL_PTR(from);
+  CHECK_NULL_PTR(to);
+  if (from->type == gqlite_id_type::bytes) CHECK_NULL_PTR(from->cid);
+  if (to->type == gqlite_id_type::bytes) CHECK_NULL_PTR(to->cid);
+  return ((GBulkLoader*)bulk)->addEdge(to_key(from), to_key(to), direction, GBulkLoader::toRow(fields, fields ? count : 0));
+}
+
+SYMBOL_EXPORT int gqlite_bulk_end(gqlite* pDb, gqlite_bulk* bulk)
+{
+  CHECK_NULL_PTR(pDb);
+  CHECK_NULL_PTR(bulk);
+  GBulkLoader* loader = (GBulkLoader*)bulk;
+  int ret = loader->end();
+  delete loader;
+  return ret;
+}
+
+SYMBOL_EXPORT int gqlite_snapshot(gqlite* pDb, const char* path)
+{
+  CHECK_NULL_PTR(pDb);
+  CHECK_NULL_PTR(path);
+  GQLiteImpl* impl = (GQLiteImpl*)pDb;
+  GStorageEngine* storage = impl->engine()->storage();
+  CHECK_NULL_PTR(storage);
+  GSnapshot snapshot(storage);
+  return snapshot.dump(path);
+}
+
+SYMBOL_EXPORT int gqlite_restore(gqlite* pDb, const char* path)
+{
+  CHECK_NULL_PTR(pDb);
+  CHECK_NULL_PTR(path);
+  GQLiteImpl* impl = (GQLiteImpl*)pDb;
+  GStorageEngine* storage = impl->engine()->storage();
+  CHECK_NULL_PTR(storage);
+  GSnapshot snapshot(storage);
+  return snapshot.restore(path);
+}
+
+SYMBOL_EXPORT int gqlite_backup(gqlite* pDb, const char* path, bool compact)
+{
+  CHECK_NULL_PTR(pDb);
+  CHECK_NULL_PTR(path);
+  GQLiteImpl* impl = (GQLiteImpl*)pDb;
+  GStorageEngine* storage = impl->engine()->storage();
+  CHECK_NULL_PTR(storage);
+  return storage->backup(path, compact);
+}
+
+SYMBOL_EXPORT gqlite_result* gqlite_copy_result(const gqlite_result* result)
+{
+  if (!result) return nullptr;
+  return GStatement::copyResult(result);
+}
+
+SYMBOL_EXPORT void gqlite_free_result(gqlite_result* result)
+{
+  GStatement::releaseResult(result);
+}
+
+SYMBOL_EXPORT int gqlite_finalize(gqlite* pDb, gqlite_statement* statement)
+{
+  CHECK_NULL_PTR(pDb);
+  GQLiteImpl* impl = (GQLiteImpl*)pDb;
+  impl->finalize((GStatement*)statement);
+  return ECode_Success;
 }
 
 SYMBOL_EXPORT char* gqlite_error(gqlite* pDb, int error)
@@ -143,6 +328,15 @@ SYMBOL_EXPORT char* gqlite_error(gqlite* pDb, int error)
   case GQL_GRAMMAR_ARRAY_FAIL:
     msg = simple_message(GRAMMAR_ARRAY_ERROR);
     break;
+  case GQL_GRAMMAR_PARAMETER_FAIL:
+    msg = simple_message(GRAMMAR_PARAMETER_ERROR);
+    break;
+  case ECode_GQL_Parameter_Not_Exist:
+    msg = simple_message(Parameter_Not_Exist_ERROR);
+    break;
+  case ECode_GQL_Parameter_Not_Bound:
+    msg = simple_message(Parameter_Not_Bound_ERROR);
+    break;
   case ECode_GQL_Type_Not_Match:
     break;
   case ECode_Fail:
@@ -152,6 +152,55 @@ namespace gql {
     return snowflake2(id);
   }
 
+  std::string to_ordered_key(double value)
+  {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(double));
+    // flip all bits of negative number, and only sign bit of positive number
+    if (bits & 0x8000000000000000ull) bits = ~bits;
+    else bits |= 0x8000000000000000ull;
+    char buf[sizeof(uint64_t)];
+    for (int i = sizeof(uint64_t) - 1; i >= 0; --i) {
+      buf[i] = (char)(bits & 0xff);
+      bits >>= 8;
+    }
+    return std::string(buf, sizeof(uint64_t));
+  }
+
+  double from_ordered_key(const char* key)
+  {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < sizeof(uint64_t); ++i) {
+      bits = (bits << 8) | (uint8_t)key[i];
+    }
+    if (bits & 0x8000000000000000ull) bits &= ~0x8000000000000000ull;
+    else bits = ~bits;
+    double value;
+    memcpy(&value, &bits, sizeof(double));
+    return value;
+  }
+
+  uint32_t crc32(const void* data, size_t len, uint32_t crc)
+  {
+    static const std::vector<uint32_t> table = []() {
+      std::vector<uint32_t> t(256);
+      for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k) {
+          c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+        }
+        t[i] = c;
+      }
+      return t;
+    }();
+    const uint8_t* p = (const uint8_t*)data;
+    crc = ~crc;
+    for (size_t i = 0; i < len; ++i) {
+      crc = table[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+  }
+
   std::string normalize(const std::string& gql)
   {
     std::string result(gql);
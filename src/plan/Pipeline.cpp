@@ -0,0 +1,87 @@
+#include "plan/Pipeline.h"
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+GPipeline::GPipeline(size_t capacity)
+:_capacity(capacity)
+{
+}
+
+void GPipeline::run(const Sink& sink)
+{
+  // queue[i] is the input of operator i, and the last queue is the input of sink
+  std::vector<std::unique_ptr<Queue>> queues;
+  for (size_t idx = 0; idx <= _operators.size(); ++idx) {
+    queues.emplace_back(new Queue(_capacity, 1));
+  }
+  std::mutex failing;
+  std::exception_ptr failure;
+  auto stopAll = [&queues]() {
+    for (auto& queue : queues) queue->close();
+  };
+  auto guard = [&](const std::function<void()>& stage) {
+    try {
+      stage();
+    }
+    catch (...) {
+      std::unique_lock<std::mutex> lock(failing);
+      if (!failure) failure = std::current_exception();
+      stopAll();
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (size_t idx = 0; idx < _operators.size(); ++idx) {
+    Queue* input = queues[idx].get();
+    Queue* output = queues[idx + 1].get();
+    const Operator& op = _operators[idx];
+    workers.emplace_back([&, input, output]() {
+      guard([&]() {
+        PipelineRow row;
+        while (input->pop(row)) {
+          if (!op(row)) continue;
+          if (!output->push(std::move(row))) break;
+        }
+      });
+      output->done();
+      });
+  }
+
+  Queue* first = queues.front().get();
+  Queue* last = queues.back().get();
+  bool stopped = false;
+  // consume output rows. If `wait` is true, wait a while for the first row.
+  auto drain = [&](bool wait) {
+    PipelineRow row;
+    while (!stopped && last->pop(row, std::chrono::milliseconds(wait ? PIPELINE_WAIT_MS : 0))) {
+      if (!sink(row)) stopped = true;
+      wait = false;
+    }
+  };
+  guard([&]() {
+    if (_source) {
+      _source([&](PipelineRow&& row) {
+        while (true) {
+          drain(false);
+          if (stopped || first->closed()) return false;
+          if (first->tryPush(row)) return true;
+          // operators are busy
+          drain(true);
+        }
+        });
+    }
+    first->done();
+    PipelineRow row;
+    while (!stopped && last->pop(row)) {
+      if (!sink(row)) stopped = true;
+    }
+  });
+  // operators that are blocked by full queues return
+  stopAll();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  if (failure) std::rethrow_exception(failure);
+}
@@ -1,9 +1,11 @@
 #include "plan/mutate/RemovePlan.h"
 #include <stdio.h>
+#include <cmath>
 #include "Context.h"
 #include "base/lang/RemoveStmt.h"
 #include "plan/query/ScanPlan.h"
 #include "StorageEngine.h"
+#include "IndexWriter.h"
 #include "gutil.h"
 
 namespace {
@@ -26,6 +28,7 @@ GRemovePlan::GRemovePlan(GContext* context, GRemoveStmt* stmt)
   :GPlan(context->_graph, context->_storage, context->_schedule)
 {
   _group = stmt->name();
+  _expire = stmt->type() == GRemoveStmt::Expire;
   _scan = new GScanPlan(context, stmt->node(), _group);
 }
 
@@ -34,34 +37,51 @@ GRemovePlan::~GRemovePlan()
   delete _scan;
 }
 
+int GRemovePlan::prepare()
+{
+  if (_store->isViewPinned()) return ECode_TRANSTION_Busy;
+  return ECode_Success;
+}
 
 int GRemovePlan::execute(GVM* gvm, const std::function<ExecuteStatus(KeyType, const std::string& key, nlohmann::json& value, int status)>& processor)
 {
+  // rows are removed by scan if they can't be expired by buckets
+  if (_expire && expire() == ECode_Success) return ECode_Success;
   std::vector<std::string> keys;
-  _scan->execute(gvm, [&keys](KeyType, const std::string& key, nlohmann::json& value, int status) {
+  // rows are used to remove their postings from indexes
+  std::vector<nlohmann::json> rows;
+  _scan->execute(gvm, [&keys, &rows](KeyType, const std::string& key, nlohmann::json& value, int status) {
     if (status != ECode_Success) return ExecuteStatus::Stop;
 
     keys.emplace_back(key);
+    rows.emplace_back(value);
     return ExecuteStatus::Continue;
     });
   if (keys.size() == 0) return ECode_Success;
 
+  GIndexWriter writer(_store, _group);
   KeyType type = _store->getKeyType(_group);
   switch (type) {
   case KeyType::Integer:
-    for (auto itr = keys.begin(), end = keys.end(); itr != end; ++itr)
+    for (size_t idx = 0; idx < keys.size(); ++idx)
     {
-      uint64_t k = *(uint64_t*)(itr->data());
+      uint64_t k = *(uint64_t*)(keys[idx].data());
       if (_store->del(_group, k) == ECode_Success) {
+        gkey_t key;
+        key = k;
+        writer.remove(key, rows[idx]);
         RemoveEdges(_store, _group, k);
       }
     }
     break;
   case KeyType::Byte:
-    for (auto itr = keys.begin(), end = keys.end(); itr != end; ++itr)
+    for (size_t idx = 0; idx < keys.size(); ++idx)
     {
-      if (_store->del(_group, itr->data()) == ECode_Success) {
-        RemoveEdges(_store, _group, itr->data());
+      if (_store->del(_group, keys[idx].data()) == ECode_Success) {
+        gkey_t key;
+        key = keys[idx];
+        writer.remove(key, rows[idx]);
+        RemoveEdges(_store, _group, keys[idx].data());
       }
     }
     break;
@@ -78,3 +98,51 @@ int GRemovePlan::execute(GVM* gvm, const std::function<ExecuteStatus(KeyType, co
   }
   return 0;
 }
+
+int GRemovePlan::expire()
+{
+  AttributeCondition condition;
+  if (!((GScanPlan*)_scan)->getCondition(condition)) return ECode_Fail;
+  if (condition._op != CompareOperator::LessThan && condition._op != CompareOperator::LessEqual) return ECode_Fail;
+  std::string index = _group + ":" + condition._attr;
+  if (!_store->isBucketIndex(index) || !_store->isIndexReady(index)) return ECode_Fail;
+  bool isNumber = condition._value.visit(
+    [](std::string) { return false; },
+    [](double) { return true; });
+  if (!isNumber) return ECode_Fail;
+  KeyType type = _store->getKeyType(_group);
+  if (type != KeyType::Integer && type != KeyType::Byte) return ECode_Fail;
+
+  double bound = condition._value.Get<double>();
+  // times of entries are integers, so expired entries are less than `time`
+  uint64_t time = 0;
+  if (bound >= 0) {
+    time = condition._op == CompareOperator::LessEqual ? (uint64_t)std::floor(bound) + 1 : (uint64_t)std::ceil(bound);
+  }
+  std::vector<std::string> keys;
+  if (_store->expireBucket(index, time, keys) != ECode_Success) return ECode_Fail;
+
+  // other indexes of group are maintained row by row
+  GIndexWriter writer(_store, _group);
+  writer.exclude(index);
+  for (auto& k : keys) {
+    gkey_t key;
+    std::string value;
+    int ret = ECode_Success;
+    if (type == KeyType::Integer) {
+      uint64_t id = *(uint64_t*)k.data();
+      key = id;
+      if (writer.indexes().size()) ret = _store->read(_group, id, value);
+      if (ret != ECode_Success || _store->del(_group, id) != ECode_Success) continue;
+      RemoveEdges(_store, _group, id);
+    }
+    else {
+      key = k;
+      if (writer.indexes().size()) ret = _store->read(_group, k, value);
+      if (ret != ECode_Success || _store->del(_group, k) != ECode_Success) continue;
+      RemoveEdges(_store, _group, k);
+    }
+    if (value.size()) writer.remove(key, nlohmann::json::parse(value));
+  }
+  return ECode_Success;
+}
@@ -22,7 +22,7 @@ GUpsetPlan::GUpsetPlan(GContext* context, GUpsetStmt* ast)
   UpsetVisitor visitor(*this);
   std::list<NodeType> ln;
   accept(ast->node(), &visitor, ln);
-  _indexes = _store->getIndexes();
+  _writer = new GIndexWriter(_store, _class);
 }
 
 GUpsetPlan::~GUpsetPlan()
@@ -34,12 +34,14 @@ GUpsetPlan::~GUpsetPlan()
     delete hnsw.second;
   }
   if (_scan) delete _scan;
+  delete _writer;
 }
 
 int GUpsetPlan::prepare() {
   // check graph is create or not.
   auto schema = _store->getSchema();
   if (schema.empty()) return ECode_Fail;
+  if (_store->isViewPinned()) return ECode_TRANSTION_Busy;
 
   if (_scan) return _scan->prepare();
   return ECode_Success;
@@ -55,6 +57,7 @@ int GUpsetPlan::execute(GVM* gvm, const std::function<ExecuteStatus(KeyType, con
       _scan->execute(gvm, [&](KeyType type, const std::string& key, nlohmann::json& value, int status) {
         if (status != ECode_Success) return ExecuteStatus::Stop;
 
+        nlohmann::json old = value;
         for (auto& item : _props.items()) {
           std::string k = item.key();
           value[k] = item.value();
@@ -63,18 +66,14 @@ int GUpsetPlan::execute(GVM* gvm, const std::function<ExecuteStatus(KeyType, con
         if (type == KeyType::Integer) {
           uint64_t upsetKey = *(uint64_t*)key.data();
           if (_store->write(_class, upsetKey, value) == ECode_Success) {
-            for (auto& item : _props.items()) {
-              upsetIndex(item, upsetKey);
-            }
+            upsetIndex(value, upsetKey, old);
             return ExecuteStatus::Stop;
           }
         }
         else if (type == KeyType::Byte) {
           std::string upsetKey(key.data(), key.size());
           if (_store->write(_class, upsetKey, value) == ECode_Success) {
-            for (auto& item : _props.items()) {
-              upsetIndex(item, upsetKey);
-            }
+            upsetIndex(value, upsetKey, old);
             return ExecuteStatus::Stop;
           }
         }
@@ -96,11 +95,12 @@ bool GUpsetPlan::upsetVertex()
           fmt::print(fmt::fg(fmt::color::red), "ERROR: upset fail!\nInput key type is string, but require integer\n");
           return ECode_Fail;
         }
+        nlohmann::json old = readVertex(k);
         if (_store->write(_class, k, itr->second) != ECode_Success)
           return ECode_Fail;
         
-        if (!_indexes.empty()) {
-          upsetIndex(itr->second, k);
+        if (!_writer->indexes().empty()) {
+          upsetIndex(itr->second, k, old);
         }
 
         auto relations = _store->getRelations(_class);
@@ -112,10 +112,11 @@ bool GUpsetPlan::upsetVertex()
           fmt::print(fmt::fg(fmt::color::red), "ERROR: upset fail!\nInput key type is integer, but require string\n");
           return ECode_Fail;
         }
+        nlohmann::json old = readVertex(k);
         if (_store->write(_class, k, itr->second) == ECode_Success){
           // printf("write: %s\n", itr->second.dump().c_str());
-          if (!_indexes.empty()) {
-            upsetIndex(itr->second, k);
+          if (!_writer->indexes().empty()) {
+            upsetIndex(itr->second, k, old);
             return ECode_Success;
           }
         }
@@ -131,6 +132,9 @@ bool GUpsetPlan::upsetEdge()
   _store->tryInitKeyType(_class, KeyType::Edge);
   for (auto itr = _edges.begin(), end = _edges.end(); itr != end; ++itr) {
     std::string sid = gql::to_string(itr->first);
+    // most of edges are new, so this lookup is answered by filter of group
+    std::string old;
+    if (_store->read(_class, sid, old) == ECode_Success && old == itr->second) continue;
     _store->write(_class, sid, (void*)itr->second.data(), itr->second.size());
   }
   return ECode_Success;
@@ -155,62 +159,6 @@ GVirtualNetwork* GUpsetPlan::generateNetwork(const std::string& branch)
   return _network[branch];
 }
 
-bool GUpsetPlan::upsetIndex(const std::string& index, const std::string& value, const std::string& id)
-{
-  std::string data;
-  _store->read(index, value, data);
-  std::vector<std::string> v = gql::split(data, '\0');
-  addUniqueDataAndSort(v, id);
-  data.clear();
-  for (auto& datum : v) {
-    data += datum + '\0';
-  }
-  data.pop_back();
-  _store->write(index, value, (void*)data.data(), data.size() * sizeof(char));
-  _store->updateIndexType(index, IndexType::Word);
-  return true;
-}
-
-bool GUpsetPlan::upsetIndex(const std::string& index, double value, uint64_t id)
-{
-  std::string bin((char*)&value, sizeof(double));
-  std::string data;
-  _store->read(index, bin, data);
-  std::vector<uint64_t> v((uint64_t*)data.data(), (uint64_t*)data.data() + data.size() / sizeof(uint64_t));
-  addUniqueDataAndSort(v, id);
-  _store->write(index, bin, v.data(), v.size());
-  _store->updateIndexType(index, IndexType::Number);
-  return true;
-}
-
-bool GUpsetPlan::upsetIndex(const std::string& index, const std::string& value, uint64_t id)
-{
-  std::string data;
-  _store->read(index, value, data);
-  std::vector<uint64_t> v((uint64_t*)data.data(), (uint64_t*)data.data() + data.size() / sizeof(uint64_t));
-  addUniqueDataAndSort(v, id);
-  _store->write(index, value, v.data(), v.size());
-  _store->updateIndexType(index, IndexType::Word);
-  return true;
-}
-
-bool GUpsetPlan::upsetIndex(const std::string& index, double value, const std::string& id)
-{
-  std::string bin((char*)&value, sizeof(double));
-  std::string data;
-  _store->read(index, bin, data);
-  std::vector<std::string> v = gql::split(data, '\0');
-  addUniqueDataAndSort(v, id);
-  data.clear();
-  for (auto& datum : v) {
-    data += datum + '\0';
-  }
-  data.pop_back();
-  _store->write(index, bin, (void*)data.data(), data.size() * sizeof(char));
-  _store->updateIndexType(index, IndexType::Number);
-  return true;
-}
-
 VisitFlow GUpsetPlan::UpsetVisitor::apply(GEdgeDeclaration* stmt, std::list<NodeType>& path)
 {
   _plan._vertex = false;
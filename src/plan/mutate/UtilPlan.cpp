@@ -3,6 +3,7 @@
 #include "gqlite.h"
 #include "VirtualNetwork.h"
 #include "StorageEngine.h"
+#include "IndexBuilder.h"
 #include "base/lang/AST.h"
 #include <fmt/printf.h>
 #include "gutil.h"
@@ -72,9 +73,30 @@ GUtilPlan::GUtilPlan(GContext* context, GDumpStmt* stmt)
   _var = stmt->name();
 }
 
+GUtilPlan::GUtilPlan(GContext* context, GIndexStmt* stmt)
+:GPlan(context->_graph, context->_storage, context->_schedule)
+{
+  _type = UtilType::Index;
+  _var = stmt->name();
+  _vParams1.emplace_back(stmt->group());
+  std::vector<std::string> includes;
+  GListNode* node = stmt->includes();
+  if (node && node->_nodetype == NodeType::ArrayExpression) {
+    GArrayExpression* array = reinterpret_cast<GArrayExpression*>(node->_value);
+    for (auto item: *array) {
+      includes.emplace_back(GetString(item));
+    }
+  }
+  _vParams2.emplace_back(includes);
+  _vParams3.emplace_back(stmt->group() + ":" + stmt->attribute());
+  _interval = stmt->interval();
+}
+
 int GUtilPlan::prepare()
 {
   int ret = ECode_Success;
+  // rows of zero-copy statement are in pages of current transaction
+  if (_type != UtilType::Dump && _store && _store->isViewPinned()) return ECode_TRANSTION_Busy;
   switch (_type)
   {
   case GUtilPlan::UtilType::Creation:
@@ -83,6 +105,15 @@ int GUtilPlan::prepare()
     break;
   case GUtilPlan::UtilType::Dump:
     break;
+  case GUtilPlan::UtilType::Index:
+  {
+    auto& schema = _store->getSchema();
+    if (schema.empty() || std::get<std::string>(_var) != schema[SCHEMA_GRAPH_NAME]) {
+      return ECode_Graph_Not_Exist;
+    }
+    if (!_store->isMapExist(std::get<std::string>(_vParams1[0]))) return ECode_Group_Not_Exist;
+  }
+    break;
   default:
     break;
   }
@@ -106,7 +137,9 @@ int GUtilPlan::execute(GVM*, const std::function<ExecuteStatus(KeyType, const st
     for (auto& item : _vParams3) {
       std::string v = std::get<std::string>(item);
       //printf("add index: %s\n", v.c_str());
+      bool exist = _store->isIndexExist(v);
       _store->addIndex(v);
+      if (!exist) GIndexBuilder::start(_store, v);
     }
   }
     break;
@@ -150,7 +183,8 @@ int GUtilPlan::execute(GVM*, const std::function<ExecuteStatus(KeyType, const st
           std::string prefIndx(name + ":");
           for (auto& indx : indexes) {
             size_t pos = std::string(indx).find(prefIndx);
-            if (pos != std::string::npos) {
+            // bucket index is dumped with its interval
+            if (pos != std::string::npos && !_store->isBucketIndex(indx)) {
               sIndexes += "'" + indx.substr(prefIndx.size(), indx.size() - prefIndx.size()) + "',";
             }
           }
@@ -166,6 +200,25 @@ int GUtilPlan::execute(GVM*, const std::function<ExecuteStatus(KeyType, const st
     groupsName.pop_back();
 
     fmt::printf("{create: '%s', group: [%s]};\n", graph, groupsName);
+    for (auto& indx : indexes) {
+      auto includes = _store->getIndexIncludes(indx);
+      if (includes.empty()) continue;
+      std::string sIncludes;
+      for (auto& attr : includes) {
+        sIncludes += "'" + attr + "',";
+      }
+      sIncludes.pop_back();
+      size_t pos = indx.find(':');
+      fmt::printf("{create: '%s', index: '%s.%s', include: [%s]};\n", graph,
+        indx.substr(0, pos), indx.substr(pos + 1), sIncludes);
+    }
+    for (auto& indx : indexes) {
+      uint64_t interval = _store->getBucketInterval(indx);
+      if (interval == 0) continue;
+      size_t pos = indx.find(':');
+      fmt::printf("{create: '%s', index: '%s.%s', interval: %d};\n", graph,
+        indx.substr(0, pos), indx.substr(pos + 1), interval);
+    }
 
     // upset group
     for (auto itr = groups.begin(); itr != groups.end(); ++itr) {
@@ -204,6 +257,16 @@ int GUtilPlan::execute(GVM*, const std::function<ExecuteStatus(KeyType, const st
     }
   }
     break;
+  case UtilType::Index:
+  {
+    std::string index = std::get<std::string>(_vParams3[0]);
+    // buckets of exist index can't be regrouped by another interval
+    if (!_store->isIndexExist(index)) _store->setBucketInterval(index, _interval);
+    _store->addIndex(index, _vParams2[0]);
+    // exist rows are indexed step by step after statement
+    GIndexBuilder::start(_store, index);
+  }
+    break;
   default:
     break;
   }
@@ -0,0 +1,196 @@
+#include "plan/query/Aggregator.h"
+#include "base/type.h"
+
+namespace {
+  bool to_number(const nlohmann::json& value, double& number) {
+    if (value.is_number()) {
+      number = value.get<double>();
+      return true;
+    }
+    if (value.is_object() && value.count(OBJECT_TYPE_NAME) &&
+      AttributeKind(value[OBJECT_TYPE_NAME]) == AttributeKind::Datetime) {
+      number = value["value"].get<double>();
+      return true;
+    }
+    return false;
+  }
+}
+
+std::string AggregateSpec::name() const
+{
+  std::string func;
+  switch (_kind) {
+  case AggregateKind::Count: func = "count"; break;
+  case AggregateKind::Sum: func = "sum"; break;
+  case AggregateKind::Avg: func = "avg"; break;
+  case AggregateKind::Min: func = "min"; break;
+  case AggregateKind::Max: func = "max"; break;
+  case AggregateKind::ApproxCountDistinct: func = "approx_count_distinct"; break;
+  case AggregateKind::ApproxQuantile:
+    return "approx_quantile(" + _attr + ", " + nlohmann::json(_param).dump() + ")";
+  default: break;
+  }
+  return func + "(" + (_attr.empty() ? "*" : _attr) + ")";
+}
+
+GAggregator::GAggregator(const std::vector<AggregateSpec>& specs, const std::string& groupBy)
+:_specs(specs)
+,_groupBy(groupBy)
+{}
+
+GAggregator::Group& GAggregator::group(const nlohmann::json& value)
+{
+  auto itr = _groups.find(value.dump());
+  if (itr != _groups.end()) return itr->second;
+  Group& g = _groups[value.dump()];
+  g._value = value;
+  g._states.resize(_specs.size());
+  return g;
+}
+
+void GAggregator::add(const nlohmann::json& row)
+{
+  nlohmann::json value;
+  if (_groupBy.size()) {
+    auto itr = row.find(_groupBy);
+    if (itr != row.end()) value = *itr;
+  }
+  Group& g = group(value);
+  for (size_t idx = 0; idx < _specs.size(); ++idx) {
+    const AggregateSpec& spec = _specs[idx];
+    State& state = g._states[idx];
+    if (spec._attr.empty()) {
+      ++state._count;
+      continue;
+    }
+    auto itr = row.find(spec._attr);
+    if (itr == row.end() || itr->is_null()) continue;
+    if (spec._kind == AggregateKind::Count) {
+      ++state._count;
+      continue;
+    }
+    if (spec._kind == AggregateKind::ApproxCountDistinct) {
+      if (!state._distinct) state._distinct.reset(new GHyperLogLog());
+      // every element of array is a value
+      if (itr->is_array()) {
+        for (auto& elem : *itr) state._distinct->add(elem.dump());
+      }
+      else state._distinct->add(itr->dump());
+      continue;
+    }
+    double number = 0;
+    if (!to_number(*itr, number)) continue;
+    ++state._count;
+    state._sum += number;
+    state._min = std::min(state._min, number);
+    state._max = std::max(state._max, number);
+    if (spec._kind == AggregateKind::ApproxQuantile) {
+      if (!state._quantile) state._quantile.reset(new GQuantileSketch());
+      state._quantile->add(number);
+    }
+  }
+}
+
+void GAggregator::addCount(size_t spec, size_t count)
+{
+  if (spec >= _specs.size()) return;
+  Group& g = group(nlohmann::json());
+  g._states[spec]._count += count;
+}
+
+void GAggregator::merge(GAggregator& other)
+{
+  for (auto& item : other._groups) {
+    Group& g = group(item.second._value);
+    for (size_t idx = 0; idx < _specs.size(); ++idx) {
+      State& state = g._states[idx];
+      const State& part = item.second._states[idx];
+      state._count += part._count;
+      state._sum += part._sum;
+      state._min = std::min(state._min, part._min);
+      state._max = std::max(state._max, part._max);
+      if (part._distinct) {
+        if (!state._distinct) state._distinct.reset(new GHyperLogLog());
+        state._distinct->merge(*part._distinct);
+      }
+      if (part._quantile) {
+        if (!state._quantile) state._quantile.reset(new GQuantileSketch());
+        state._quantile->merge(*part._quantile);
+      }
+    }
+  }
+  other._groups.clear();
+}
+
+std::vector<nlohmann::json> GAggregator::result() const
+{
+  std::vector<nlohmann::json> rows;
+  for (auto& item : _groups) {
+    nlohmann::json row = nlohmann::json::object();
+    if (_groupBy.size()) row[_groupBy] = item.second._value;
+    for (size_t idx = 0; idx < _specs.size(); ++idx) {
+      const State& state = item.second._states[idx];
+      nlohmann::json& value = row[_specs[idx].name()];
+      switch (_specs[idx]._kind) {
+      case AggregateKind::Count:
+        value = state._count;
+        break;
+      case AggregateKind::Sum:
+        value = state._sum;
+        break;
+      case AggregateKind::Avg:
+        if (state._count) value = state._sum / state._count;
+        break;
+      case AggregateKind::Min:
+        if (state._count) value = state._min;
+        break;
+      case AggregateKind::Max:
+        if (state._count) value = state._max;
+        break;
+      case AggregateKind::ApproxCountDistinct:
+        // count is set from statistics of index if sketch is not used
+        value = state._distinct ? state._distinct->estimate() : state._count;
+        break;
+      case AggregateKind::ApproxQuantile:
+        if (state._quantile) value = state._quantile->quantile(_specs[idx]._param);
+        break;
+      default:
+        break;
+      }
+    }
+    rows.emplace_back(std::move(row));
+  }
+  // count of an empty group is 0
+  if (rows.empty() && _groupBy.empty()) {
+    nlohmann::json row = nlohmann::json::object();
+    for (auto& spec : _specs) {
+      bool zero = (spec._kind == AggregateKind::Count || spec._kind == AggregateKind::Sum || spec._kind == AggregateKind::ApproxCountDistinct);
+      row[spec.name()] = zero ? nlohmann::json(0) : nlohmann::json();
+    }
+    rows.emplace_back(std::move(row));
+  }
+  return rows;
+}
+
+std::vector<std::string> GAggregator::attributes() const
+{
+  std::vector<std::string> attrs;
+  if (_groupBy.size()) attrs.push_back(_groupBy);
+  for (auto& spec : _specs) {
+    if (spec._attr.size()) attrs.push_back(spec._attr);
+  }
+  return attrs;
+}
+
+bool GAggregator::parseKind(const std::string& name, AggregateKind& kind)
+{
+  if (name == "count") kind = AggregateKind::Count;
+  else if (name == "sum") kind = AggregateKind::Sum;
+  else if (name == "avg") kind = AggregateKind::Avg;
+  else if (name == "min") kind = AggregateKind::Min;
+  else if (name == "max") kind = AggregateKind::Max;
+  else if (name == "approx_count_distinct") kind = AggregateKind::ApproxCountDistinct;
+  else if (name == "approx_quantile") kind = AggregateKind::ApproxQuantile;
+  else return false;
+  return true;
+}
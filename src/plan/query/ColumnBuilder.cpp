@@ -0,0 +1,402 @@
+#include "plan/query/ColumnBuilder.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include "base/Arena.h"
+#include "StorageEngine.h"
+#include "gutil.h"
+
+namespace {
+  /**
+   * A page has its own arena. Every schema and array of page holds a reference of it,
+   * so a child that is moved by consumer is still valid after its parent is released.
+   */
+  struct PageMemory {
+    GArena _arena;
+    std::atomic<size_t> _refs{ 0 };
+  };
+
+  void unref(void* data) {
+    PageMemory* page = (PageMemory*)data;
+    if (page && --page->_refs == 0) delete page;
+  }
+
+  void release_schema(struct ArrowSchema* schema) {
+    for (int64_t idx = 0; idx < schema->n_children; ++idx) {
+      struct ArrowSchema* child = schema->children[idx];
+      if (child->release) child->release(child);
+    }
+    void* page = schema->private_data;
+    // schema may be in arena of page
+    schema->release = nullptr;
+    unref(page);
+  }
+
+  void release_array(struct ArrowArray* array) {
+    for (int64_t idx = 0; idx < array->n_children; ++idx) {
+      struct ArrowArray* child = array->children[idx];
+      if (child->release) child->release(child);
+    }
+    void* page = array->private_data;
+    array->release = nullptr;
+    unref(page);
+  }
+
+  void own(struct ArrowSchema* schema, PageMemory* page) {
+    schema->private_data = page;
+    ++page->_refs;
+    for (int64_t idx = 0; idx < schema->n_children; ++idx) own(schema->children[idx], page);
+  }
+
+  void own(struct ArrowArray* array, PageMemory* page) {
+    array->private_data = page;
+    ++page->_refs;
+    for (int64_t idx = 0; idx < array->n_children; ++idx) own(array->children[idx], page);
+  }
+
+  void init_schema(struct ArrowSchema* schema, const char* format, const char* name, int64_t children, GArena& arena) {
+    schema->format = format;
+    schema->name = name;
+    schema->metadata = nullptr;
+    schema->flags = ARROW_FLAG_NULLABLE;
+    schema->n_children = children;
+    schema->children = children ? arena.allocate<struct ArrowSchema*>(children) : nullptr;
+    for (int64_t idx = 0; idx < children; ++idx) {
+      schema->children[idx] = arena.allocate<struct ArrowSchema>();
+    }
+    schema->dictionary = nullptr;
+    schema->release = release_schema;
+    schema->private_data = nullptr;
+  }
+
+  void init_array(struct ArrowArray* array, int64_t length, int64_t buffers, int64_t children, GArena& arena) {
+    array->length = length;
+    array->null_count = 0;
+    array->offset = 0;
+    array->n_buffers = buffers;
+    array->n_children = children;
+    array->buffers = buffers ? arena.allocate<const void*>(buffers) : nullptr;
+    for (int64_t idx = 0; idx < buffers; ++idx) {
+      array->buffers[idx] = nullptr;
+    }
+    array->children = children ? arena.allocate<struct ArrowArray*>(children) : nullptr;
+    for (int64_t idx = 0; idx < children; ++idx) {
+      array->children[idx] = arena.allocate<struct ArrowArray>();
+    }
+    array->dictionary = nullptr;
+    array->release = release_array;
+    array->private_data = nullptr;
+  }
+
+  template<typename T>
+  const void* copy_buffer(GArena& arena, const std::vector<T>& values) {
+    T* buffer = arena.allocate<T>(values.size());
+    if (values.size()) memcpy(buffer, values.data(), sizeof(T) * values.size());
+    return buffer;
+  }
+}
+
+GColumnBuilder::GColumnBuilder()
+:_edge(false)
+,_rows(0)
+{
+}
+
+bool GColumnBuilder::accept(KeyType type) const
+{
+  return _rows == 0 || _edge == (type == KeyType::Edge);
+}
+
+void GColumnBuilder::add(KeyType type, const std::string& key, const nlohmann::json& row)
+{
+  if (_rows == 0) _edge = (type == KeyType::Edge);
+  if (_edge) {
+    auto id = gql::to_edge_id(key);
+    appendId(column("from"), id._from_type, id._value, id._from_len);
+    appendId(column("to"), id._to_type, id._value + id._from_len, id._len - id._from_len);
+    append(column("direction"), nlohmann::json((bool)id._direction));
+    gql::release_edge_id(id);
+  }
+  else {
+    appendId(column("id"), type == KeyType::Integer ? 0 : 1, key.data(), key.size());
+  }
+  size_t ids = _edge ? 3 : 1;
+  if (row.is_object()) {
+    for (auto itr = row.begin(); itr != row.end(); ++itr) {
+      std::string name = itr.key();
+      // an attribute can't replace id columns
+      auto index = _index.find(name);
+      if (index != _index.end() && index->second < ids) name = "@" + name;
+      Column& col = column(name);
+      if (col._valid.size() > _rows) continue;
+      append(col, itr.value());
+    }
+  }
+  ++_rows;
+  // attributes that row doesn't have
+  for (auto& col : _columns) {
+    if (col._valid.size() < _rows) appendNull(col);
+  }
+}
+
+void GColumnBuilder::clear()
+{
+  _rows = 0;
+  _columns.clear();
+  _index.clear();
+}
+
+GColumnBuilder::Column& GColumnBuilder::column(const std::string& name)
+{
+  auto itr = _index.find(name);
+  if (itr != _index.end()) return _columns[itr->second];
+  _index[name] = _columns.size();
+  _columns.emplace_back();
+  Column& col = _columns.back();
+  col._name = name;
+  // former rows don't have it
+  for (size_t idx = 0; idx < _rows; ++idx) appendNull(col);
+  return col;
+}
+
+void GColumnBuilder::appendId(Column& col, uint8_t type, const char* id, size_t len)
+{
+  if (type == 0) {
+    uint64_t uid = 0;
+    memcpy(&uid, id, sizeof(uint64_t));
+    if (col._kind == ColumnKind::Null) setKind(col, ColumnKind::UInt64);
+    if (col._kind == ColumnKind::UInt64) {
+      col._ints.push_back((int64_t)uid);
+      col._valid.push_back(true);
+    }
+    else appendText(col, std::to_string(uid));
+    return;
+  }
+  if (col._kind != ColumnKind::Utf8) toText(col);
+  appendText(col, std::string(id, len));
+}
+
+void GColumnBuilder::append(Column& col, const nlohmann::json& value)
+{
+  if (value.is_null()) {
+    appendNull(col);
+    return;
+  }
+  if (value.is_boolean()) {
+    if (col._kind == ColumnKind::Null) setKind(col, ColumnKind::Bool);
+    if (col._kind == ColumnKind::Bool) {
+      col._ints.push_back(value.get<bool>() ? 1 : 0);
+      col._valid.push_back(true);
+      return;
+    }
+  }
+  else if (value.is_number_integer()) {
+    if (col._kind == ColumnKind::Null) setKind(col, ColumnKind::Int64);
+    if (col._kind == ColumnKind::Int64) {
+      col._ints.push_back(value.get<int64_t>());
+      col._valid.push_back(true);
+      return;
+    }
+    if (col._kind == ColumnKind::Double) {
+      col._doubles.push_back(value.get<double>());
+      col._valid.push_back(true);
+      return;
+    }
+  }
+  else if (value.is_number_float()) {
+    if (col._kind == ColumnKind::Null) setKind(col, ColumnKind::Double);
+    if (col._kind == ColumnKind::Int64) {
+      col._doubles.assign(col._ints.begin(), col._ints.end());
+      col._ints.clear();
+      col._kind = ColumnKind::Double;
+    }
+    if (col._kind == ColumnKind::Double) {
+      col._doubles.push_back(value.get<double>());
+      col._valid.push_back(true);
+      return;
+    }
+  }
+  else if (value.is_array() && value.size() && std::all_of(value.begin(), value.end(), [](const nlohmann::json& item) { return item.is_number(); })) {
+    if (col._kind == ColumnKind::Null) setKind(col, ColumnKind::Vector, value.size());
+    if (col._kind == ColumnKind::Vector && col._width == value.size()) {
+      for (auto& item : value) col._doubles.push_back(item.get<double>());
+      col._valid.push_back(true);
+      return;
+    }
+  }
+  // value doesn't fit type of column
+  if (col._kind != ColumnKind::Utf8) toText(col);
+  appendText(col, value.is_string() ? value.get<std::string>() : value.dump());
+}
+
+void GColumnBuilder::appendText(Column& col, const std::string& text)
+{
+  col._bytes.append(text);
+  col._offsets.push_back((int32_t)col._bytes.size());
+  col._valid.push_back(true);
+}
+
+void GColumnBuilder::appendNull(Column& col)
+{
+  col._valid.push_back(false);
+  pushDefault(col);
+}
+
+void GColumnBuilder::pushDefault(Column& col)
+{
+  switch (col._kind) {
+  case ColumnKind::Bool:
+  case ColumnKind::Int64:
+  case ColumnKind::UInt64:
+    col._ints.push_back(0);
+    break;
+  case ColumnKind::Double:
+    col._doubles.push_back(0);
+    break;
+  case ColumnKind::Vector:
+    col._doubles.insert(col._doubles.end(), col._width, 0);
+    break;
+  case ColumnKind::Utf8:
+    col._offsets.push_back((int32_t)col._bytes.size());
+    break;
+  default:
+    break;
+  }
+}
+
+void GColumnBuilder::setKind(Column& col, ColumnKind kind, size_t width)
+{
+  // column is null before
+  col._kind = kind;
+  col._width = width;
+  if (kind == ColumnKind::Utf8) col._offsets.assign(1, 0);
+  for (size_t idx = 0; idx < col._valid.size(); ++idx) pushDefault(col);
+}
+
+void GColumnBuilder::toText(Column& col)
+{
+  if (col._kind == ColumnKind::Null) {
+    setKind(col, ColumnKind::Utf8);
+    return;
+  }
+  std::vector<std::string> texts(col._valid.size());
+  for (size_t idx = 0; idx < col._valid.size(); ++idx) {
+    if (!col._valid[idx]) continue;
+    switch (col._kind) {
+    case ColumnKind::Bool:
+      texts[idx] = col._ints[idx] ? "true" : "false";
+      break;
+    case ColumnKind::Int64:
+      texts[idx] = std::to_string(col._ints[idx]);
+      break;
+    case ColumnKind::UInt64:
+      texts[idx] = std::to_string((uint64_t)col._ints[idx]);
+      break;
+    case ColumnKind::Double:
+      texts[idx] = nlohmann::json(col._doubles[idx]).dump();
+      break;
+    case ColumnKind::Vector:
+    {
+      auto begin = col._doubles.begin() + idx * col._width;
+      texts[idx] = nlohmann::json(std::vector<double>(begin, begin + col._width)).dump();
+    }
+      break;
+    default:
+      break;
+    }
+  }
+  col._ints.clear();
+  col._doubles.clear();
+  col._bytes.clear();
+  col._offsets.assign(1, 0);
+  col._kind = ColumnKind::Utf8;
+  col._width = 0;
+  for (auto& text : texts) {
+    col._bytes.append(text);
+    col._offsets.push_back((int32_t)col._bytes.size());
+  }
+}
+
+void GColumnBuilder::build(struct ArrowSchema* schema, struct ArrowArray* array) const
+{
+  PageMemory* page = new PageMemory();
+  GArena& arena = page->_arena;
+  init_schema(schema, "+s", "", _columns.size(), arena);
+  init_array(array, _rows, 1, _columns.size(), arena);
+  for (size_t idx = 0; idx < _columns.size(); ++idx) {
+    build(arena, _columns[idx], schema->children[idx], array->children[idx]);
+  }
+  own(schema, page);
+  own(array, page);
+}
+
+void GColumnBuilder::build(GArena& arena, const Column& col, struct ArrowSchema* schema, struct ArrowArray* array) const
+{
+  const char* name = arena.copy(col._name.data(), col._name.size());
+  if (col._kind == ColumnKind::Null) {
+    init_schema(schema, "n", name, 0, arena);
+    init_array(array, _rows, 0, 0, arena);
+    array->null_count = _rows;
+    return;
+  }
+  // validity bitmap is omitted if all values are valid
+  uint8_t* validity = nullptr;
+  int64_t nulls = std::count(col._valid.begin(), col._valid.end(), false);
+  if (nulls) {
+    size_t size = (_rows + 7) / 8;
+    validity = arena.allocate<uint8_t>(size);
+    memset(validity, 0, size);
+    for (size_t idx = 0; idx < _rows; ++idx) {
+      if (col._valid[idx]) validity[idx / 8] |= (uint8_t)(1 << (idx % 8));
+    }
+  }
+  switch (col._kind) {
+  case ColumnKind::Bool:
+  {
+    init_schema(schema, "b", name, 0, arena);
+    init_array(array, _rows, 2, 0, arena);
+    size_t size = (_rows + 7) / 8;
+    uint8_t* values = arena.allocate<uint8_t>(size);
+    memset(values, 0, size);
+    for (size_t idx = 0; idx < _rows; ++idx) {
+      if (col._ints[idx]) values[idx / 8] |= (uint8_t)(1 << (idx % 8));
+    }
+    array->buffers[1] = values;
+  }
+    break;
+  case ColumnKind::Int64:
+  case ColumnKind::UInt64:
+    init_schema(schema, col._kind == ColumnKind::Int64 ? "l" : "L", name, 0, arena);
+    init_array(array, _rows, 2, 0, arena);
+    array->buffers[1] = copy_buffer(arena, col._ints);
+    break;
+  case ColumnKind::Double:
+    init_schema(schema, "g", name, 0, arena);
+    init_array(array, _rows, 2, 0, arena);
+    array->buffers[1] = copy_buffer(arena, col._doubles);
+    break;
+  case ColumnKind::Vector:
+  {
+    std::string format = "+w:" + std::to_string(col._width);
+    init_schema(schema, arena.copy(format.data(), format.size()), name, 1, arena);
+    init_schema(schema->children[0], "g", "item", 0, arena);
+    init_array(array, _rows, 1, 1, arena);
+    init_array(array->children[0], _rows * col._width, 2, 0, arena);
+    array->children[0]->buffers[1] = copy_buffer(arena, col._doubles);
+  }
+    break;
+  case ColumnKind::Utf8:
+  {
+    init_schema(schema, "u", name, 0, arena);
+    init_array(array, _rows, 3, 0, arena);
+    array->buffers[1] = copy_buffer(arena, col._offsets);
+    char* bytes = arena.copy(col._bytes.data(), col._bytes.size());
+    array->buffers[2] = bytes;
+  }
+    break;
+  default:
+    break;
+  }
+  array->null_count = nulls;
+  array->buffers[0] = validity;
+}
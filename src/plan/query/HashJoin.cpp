@@ -0,0 +1,31 @@
+#include "plan/query/HashJoin.h"
+
+void GHashJoin::build(const std::string& key, nlohmann::json& row)
+{
+  _rows[key] = std::move(row);
+  _sealed = false;
+}
+
+void GHashJoin::seal()
+{
+  _bitmap = GBloomFilter(_rows.size());
+  for (auto& item : _rows) {
+    _bitmap.add(item.first.data(), item.first.size());
+  }
+  _sealed = true;
+}
+
+void GHashJoin::clear()
+{
+  _rows.clear();
+  _sealed = false;
+}
+
+const nlohmann::json* GHashJoin::probe(const std::string& key) const
+{
+  if (_rows.empty()) return nullptr;
+  if (_sealed && !_bitmap.mayContain(key.data(), key.size())) return nullptr;
+  auto itr = _rows.find(key);
+  if (itr == _rows.end()) return nullptr;
+  return &itr->second;
+}
@@ -0,0 +1,198 @@
+#include "plan/query/Optimizer.h"
+#include "gutil.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <set>
+
+namespace {
+  bool is_number(const attribute_t& value) {
+    return value.visit(
+      [](std::string) { return false; },
+      [](double) { return true; });
+  }
+}
+
+GOptimizer::GOptimizer(GStorageEngine* store, const std::string& group)
+:_store(store)
+,_group(group)
+{
+  _rows = (double)_store->count(_group);
+}
+
+AccessPath GOptimizer::choose(const std::vector<AttributeCondition>& conditions, const std::string& covering, const std::string& bucket)
+{
+  std::vector<AccessPath> paths = enumerate(conditions, covering, bucket);
+  auto best = std::min_element(paths.begin(), paths.end(), [](const AccessPath& left, const AccessPath& right) {
+    return left._cost < right._cost;
+    });
+  return *best;
+}
+
+std::vector<AccessPath> GOptimizer::enumerate(const std::vector<AttributeCondition>& conditions, const std::string& covering, const std::string& bucket)
+{
+  std::vector<AccessPath> paths;
+  AccessPath scan;
+  scan._rows = _rows;
+  scan._cost = _rows * (COST_SEQUENTIAL_ROW + COST_DECODE_ROW);
+  paths.push_back(scan);
+
+  // every index that can be seeked is a path, and they are intersected from the most selective one
+  std::vector<AccessPath> seeks;
+  std::set<std::string> visited;
+  for (auto& cond : conditions) {
+    std::string index = _group + ":" + cond._attr;
+    if (!visited.insert(index).second) continue;
+    if (!_store->isIndexExist(index) || !_store->isIndexReady(index) || _store->isBucketIndex(index)) continue;
+    std::string lower, upper;
+    if (!range(_store->getIndexType(index), cond._attr, conditions, lower, upper)) continue;
+    AccessPath path;
+    path._kind = AccessKind::Index;
+    path._indexes.push_back(index);
+    path._rows = estimate(index, lower, upper);
+    path._cost = path._rows * (COST_INDEX_ENTRY + COST_RANDOM_ROW + COST_DECODE_ROW);
+    seeks.push_back(path);
+  }
+  std::sort(seeks.begin(), seeks.end(), [](const AccessPath& left, const AccessPath& right) {
+    return left._rows < right._rows;
+    });
+  paths.insert(paths.end(), seeks.begin(), seeks.end());
+  if (seeks.size() > 1 && _rows > 0) {
+    // attributes are assumed to be independent
+    AccessPath intersection;
+    intersection._kind = AccessKind::Intersection;
+    double postings = 0;
+    double selectivity = 1;
+    for (auto& seek : seeks) {
+      intersection._indexes.push_back(seek._indexes[0]);
+      postings += seek._rows;
+      selectivity *= std::min(1.0, seek._rows / _rows);
+      AccessPath path = intersection;
+      path._rows = _rows * selectivity;
+      path._cost = postings * COST_INDEX_ENTRY + path._rows * (COST_RANDOM_ROW + COST_DECODE_ROW);
+      if (path._indexes.size() > 1) paths.push_back(path);
+    }
+  }
+
+  if (!covering.empty()) {
+    AccessPath path;
+    path._kind = AccessKind::Covering;
+    path._indexes.push_back(covering);
+    std::string attr = covering.substr(_group.size() + 1);
+    std::string lower, upper;
+    // entries of covering index are ordered by encoded value, so it is seeked by equal or range
+    path._rows = _rows;
+    if (range(_store->getIndexType(covering), attr, conditions, lower, upper)) {
+      path._rows = estimate(covering, lower, upper);
+    }
+    path._cost = path._rows * (COST_SEQUENTIAL_ROW + COST_INDEX_ENTRY);
+    paths.push_back(path);
+  }
+
+  if (!bucket.empty()) {
+    AccessPath path;
+    path._kind = AccessKind::Bucket;
+    path._indexes.push_back(bucket);
+    path._rows = estimateBucket(bucket, conditions);
+    path._cost = path._rows * (COST_INDEX_ENTRY + COST_RANDOM_ROW + COST_DECODE_ROW);
+    paths.push_back(path);
+  }
+  return paths;
+}
+
+bool GOptimizer::range(IndexType type, const std::string& attr, const std::vector<AttributeCondition>& conditions, std::string& lower, std::string& upper)
+{
+  if (type == IndexType::Word) {
+    // strings are seeked by equal only
+    for (auto& cond : conditions) {
+      if (cond._attr != attr || cond._op != CompareOperator::Equal || is_number(cond._value)) continue;
+      lower = cond._value.Get<std::string>();
+      upper = lower;
+      return true;
+    }
+    return false;
+  }
+  if (type != IndexType::Number) return false;
+  double from = std::numeric_limits<double>::lowest();
+  double to = std::numeric_limits<double>::max();
+  bool bounded = false;
+  for (auto& cond : conditions) {
+    if (cond._attr != attr || !is_number(cond._value)) continue;
+    double value = cond._value.Get<double>();
+    switch (cond._op) {
+    case CompareOperator::Equal:
+      from = std::max(from, value);
+      to = std::min(to, value);
+      bounded = true;
+      break;
+    case CompareOperator::GreatThan:
+    case CompareOperator::GreatEqual:
+      from = std::max(from, value);
+      bounded = true;
+      break;
+    case CompareOperator::LessThan:
+    case CompareOperator::LessEqual:
+      to = std::min(to, value);
+      break;
+    default:
+      break;
+    }
+  }
+  // keys of number index are encoded by `to_ordered_key`, so they are compared as bytes
+  if (!bounded) return false;
+  lower = gql::to_ordered_key(from);
+  if (to != std::numeric_limits<double>::max()) upper = gql::to_ordered_key(to);
+  else upper.clear();
+  if (to < from) upper = lower;
+  return true;
+}
+
+size_t GOptimizer::values(GStorageEngine::cursor& from, const std::string& lower, const std::string& upper, GStorageEngine::cursor& to)
+{
+  auto first = from.move(mdbx::cursor::key_lowerbound, mdbx::slice(lower.data(), lower.size()), false);
+  if (!first) return 0;
+  std::string key((char*)first.key.byte_ptr(), first.key.size());
+  if (upper == lower) return key == lower ? 1 : 0;
+  auto last = upper.empty() ? to.to_last(false) :
+    to.move(mdbx::cursor::key_lowerbound, mdbx::slice(upper.data(), upper.size()), false);
+  size_t extra = 0;
+  if (!last) {
+    last = to.to_last(false);
+    extra = 1;
+  }
+  else if (upper.empty() || std::string((char*)last.key.byte_ptr(), last.key.size()) == upper) extra = 1;
+  ptrdiff_t distance = mdbx::estimate(from, to);
+  return distance < 0 ? 0 : (size_t)distance + extra;
+}
+
+double GOptimizer::estimate(const std::string& index, const std::string& lower, const std::string& upper)
+{
+  size_t distinct = _store->count(index);
+  if (distinct == 0) return 0;
+  GStorageEngine::cursor from = _store->getIndexCursor(index);
+  GStorageEngine::cursor to = _store->getIndexCursor(index);
+  // rows of a value are assumed to be average
+  return values(from, lower, upper, to) * _rows / distinct;
+}
+
+double GOptimizer::estimateBucket(const std::string& index, const std::vector<AttributeCondition>& conditions)
+{
+  std::string attr = index.substr(_group.size() + 1);
+  std::string lower, upper;
+  if (!range(IndexType::Number, attr, conditions, lower, upper)) return _rows;
+  // every entry of bucket map is a row, and its key begins with bucket and time
+  uint64_t interval = _store->getBucketInterval(index);
+  if (interval == 0) return _rows;
+  GStorageEngine::BucketEntry entry{ (uint64_t)std::ceil(std::max(gql::from_ordered_key(lower.data()), 0.0)), std::string() };
+  std::string bucketLower = GStorageEngine::encodeBucket(entry._time - entry._time % interval, &entry);
+  std::string bucketUpper;
+  if (!upper.empty()) {
+    double to = gql::from_ordered_key(upper.data());
+    if (to < 0) return 0;
+    entry._time = (uint64_t)std::floor(to) + 1;
+    bucketUpper = GStorageEngine::encodeBucket(entry._time - entry._time % interval, &entry);
+  }
+  GStorageEngine::cursor from = _store->getBucketCursor(index);
+  GStorageEngine::cursor to = _store->getBucketCursor(index);
+  return values(from, bucketLower, bucketUpper, to);
+}
@@ -0,0 +1,183 @@
+#include "plan/query/PredicateProgram.h"
+#include "StorageEngine.h"
+#include "base/type.h"
+#include <algorithm>
+
+GPredicateProgram::GPredicateProgram()
+:_compiled(false)
+{}
+
+bool GPredicateProgram::compile(const QueryCondition& where)
+{
+  _compiled = false;
+  _and.clear();
+  _or.clear();
+  for (int index = 0; index < (long)LogicalPredicate::Max; ++index) {
+    auto& pattern = where._patterns[index];
+    if (pattern._edges.size()) return false;
+    std::vector<Op>& ops = (index == (long)LogicalPredicate::And ? _and : _or);
+    size_t cond = 0, key = 0;
+    for (auto& pred : pattern._node_predicates) {
+      Op op{ OpKind::Function, CompareOperator::Other, "", 0, "", 0, false, nullptr, SELECTIVITY_OTHER };
+      bool isKey = pred.visit(
+        [](std::function<bool(const gkey_t&)>) { return true; },
+        [](std::function<bool(const attribute_t&)>) { return false; });
+      if (isKey) {
+        if (key >= pattern._key_values.size()) return false;
+        op._kind = OpKind::Key;
+        op._op = CompareOperator::Equal;
+        op._string = pattern._key_values[key++];
+        op._integer = strtoull(op._string.c_str(), nullptr, 10);
+        op._isInteger = (std::to_string(op._integer) == op._string);
+        op._selectivity = SELECTIVITY_KEY;
+        ops.emplace_back(std::move(op));
+        continue;
+      }
+      if (cond >= pattern._node_conditions.size()) return false;
+      auto& condition = pattern._node_conditions[cond++];
+      op._attr = condition._attr;
+      op._op = condition._op;
+      if (condition._op == CompareOperator::Other) {
+        if (condition._value.empty()) {
+          op._kind = OpKind::Exists;
+          op._selectivity = SELECTIVITY_EXISTS;
+        }
+        else {
+          op._func = pred.Get<std::function<bool(const attribute_t&)>>();
+        }
+        ops.emplace_back(std::move(op));
+        continue;
+      }
+      op._selectivity = (condition._op == CompareOperator::Equal ? SELECTIVITY_EQUAL : SELECTIVITY_RANGE);
+      condition._value.visit(
+        [&op](std::string value) {
+          op._kind = OpKind::String;
+          op._string = value;
+        },
+        [&op](double value) {
+          op._kind = OpKind::Number;
+          op._number = value;
+        });
+      ops.emplace_back(std::move(op));
+    }
+    if (cond != pattern._node_conditions.size()) return false;
+  }
+  // and: the op most likely to fail is checked first. or: the op most likely to succeed is checked first
+  std::stable_sort(_and.begin(), _and.end(), [](const Op& left, const Op& right) {
+    return left._selectivity < right._selectivity;
+    });
+  std::stable_sort(_or.begin(), _or.end(), [](const Op& left, const Op& right) {
+    return left._selectivity > right._selectivity;
+    });
+  _compiled = true;
+  return true;
+}
+
+bool GPredicateProgram::match(KeyType type, const gkey_t& key, const nlohmann::json& row) const
+{
+  for (auto& op : _and) {
+    if (!eval(op, type, key, row)) return false;
+  }
+  if (_or.empty()) return true;
+  for (auto& op : _or) {
+    if (eval(op, type, key, row)) return true;
+  }
+  return false;
+}
+
+void GPredicateProgram::select(KeyType type, const std::vector<gkey_t>& keys, const std::vector<nlohmann::json>& rows, std::vector<uint32_t>& selection) const
+{
+  selection.resize(rows.size());
+  for (uint32_t idx = 0; idx < (uint32_t)rows.size(); ++idx) selection[idx] = idx;
+  for (auto& op : _and) {
+    size_t count = 0;
+    for (uint32_t idx : selection) {
+      if (eval(op, type, keys[idx], rows[idx])) selection[count++] = idx;
+    }
+    selection.resize(count);
+    if (selection.empty()) return;
+  }
+  if (_or.empty()) return;
+  size_t count = 0;
+  for (uint32_t idx : selection) {
+    for (auto& op : _or) {
+      if (eval(op, type, keys[idx], rows[idx])) {
+        selection[count++] = idx;
+        break;
+      }
+    }
+  }
+  selection.resize(count);
+}
+
+bool GPredicateProgram::eval(const Op& op, KeyType type, const gkey_t& key, const nlohmann::json& row) const
+{
+  if (op._kind == OpKind::Key) {
+    if (type == KeyType::Integer) return op._isInteger && key.Get<uint64_t>() == op._integer;
+    return key.Get<std::string>() == op._string;
+  }
+  auto itr = row.find(op._attr);
+  if (itr == row.end()) return false;
+  const nlohmann::json& attr = *itr;
+  switch (op._kind) {
+  case OpKind::Number:
+    if (attr.is_number()) return compare(op._op, attr.get<double>(), op._number);
+    if (attr.is_object() && attr.count(OBJECT_TYPE_NAME) &&
+      AttributeKind(attr[OBJECT_TYPE_NAME]) == AttributeKind::Datetime) {
+      return compare(op._op, attr["value"].get<double>(), op._number);
+    }
+    return false;
+  case OpKind::String:
+    if (attr.is_string()) return compare(op._op, attr.get_ref<const std::string&>(), op._string);
+    return false;
+  case OpKind::Exists:
+    if (attr.is_number() || attr.is_string()) return true;
+    if (attr.is_object() && attr.count(OBJECT_TYPE_NAME)) {
+      AttributeKind kind = AttributeKind(attr[OBJECT_TYPE_NAME]);
+      return kind == AttributeKind::Datetime || kind == AttributeKind::Vector;
+    }
+    return false;
+  case OpKind::Function:
+    return call(op._func, attr);
+  default:
+    return false;
+  }
+}
+
+bool GPredicateProgram::call(const std::function<bool(const attribute_t&)>& op, const nlohmann::json& attr)
+{
+  bool ret = false;
+  switch ((nlohmann::json::value_t)attr) {
+  case nlohmann::json::value_t::number_float:
+  case nlohmann::json::value_t::number_integer:
+  case nlohmann::json::value_t::number_unsigned:
+    ret = op((double)attr);
+    break;
+  case nlohmann::json::value_t::string:
+    ret = op((std::string)attr);
+    break;
+  case nlohmann::json::value_t::object:
+    if (attr.count(OBJECT_TYPE_NAME)) {
+      switch (AttributeKind(attr[OBJECT_TYPE_NAME])) {
+      case AttributeKind::Datetime:
+      {
+        ret = op((double)attr["value"]);
+      }
+      break;
+      case AttributeKind::Vector:
+      {
+        std::vector<double> dv = attr["value"];
+        attribute_t a = dv;
+        ret = op(a);
+      }
+      break;
+      default:
+        break;
+      }
+    }
+    break;
+  default:
+    break;
+  }
+  return ret;
+}
@@ -1,34 +1,56 @@
 #include "plan/query/QueryPlan.h"
+#include <cstring>
+#include <string_view>
 #include "Context.h"
 #include "plan/query/ScanPlan.h"
 #include "StorageEngine.h"
 #include "gutil.h"
 #include "base/gvm/GVM.h"
+#include "plan/Pipeline.h"
 
 namespace {
-  void init_vertex(gqlite_vertex* vertex, uint8_t type, std::string& sID) {
+  gqlite_vertex* init_vertex(GArena& arena, uint8_t type, const char* id, size_t len) {
+    gqlite_vertex* vertex = arena.allocate<gqlite_vertex>();
     if (type == 0) {
       vertex->type = gqlite_id_type::integer;
-      vertex->uid = *(uint64_t*)sID.data();
+      memcpy(&vertex->uid, id, sizeof(uint64_t));
     }
     else {
       vertex->type = gqlite_id_type::bytes;
-      sID += "\0";
-      vertex->cid = (char*)sID.data();
+      vertex->cid = arena.copy(id, len);
     }
     vertex->properties = nullptr;
+    vertex->len = 0;
+    return vertex;
+  }
+
+  /**
+   * @brief stored text without typed attributes is same as its beautified text.
+   */
+  bool is_plain(const char* text, size_t len) {
+    std::string_view view(text, len);
+    return view.find("\"" OBJECT_TYPE_NAME "\"") == std::string_view::npos && view.find("\"subtype\"") == std::string_view::npos;
   }
 }
 
 GQueryPlan::GQueryPlan(GContext* context, GQueryStmt* stmt, gqlite_callback cb, void* cbHandle)
   :GPlan(context->_graph, context->_storage, context->_schedule)
   , _cb(cb), _handle(cbHandle)
+  , _page(nullptr), _pageCount(0)
+  , _zeroCopy(context->_zeroCopy)
+  , _columnar(context->_columnar)
 {
+  _schema.release = nullptr;
+  _array.release = nullptr;
+  _pageColumns.schema = &_schema;
+  _pageColumns.array = &_array;
   _scan = new GScanPlan(context, stmt);
+  _scan->setRaw(_zeroCopy && !_columnar);
 }
 
 GQueryPlan::~GQueryPlan()
 {
+  releaseColumns();
   delete _scan;
 }
 
@@ -44,24 +66,69 @@ void GQueryPlan::addCompiler(Compiler* c) {
 
 int GQueryPlan::execute(GVM* gvm, const std::function<ExecuteStatus(KeyType, const std::string& key, nlohmann::json& value, int status)>& processor)
 {
-  if (_cb) {
+  if (_cb && _scan->isAggregate()) {
+    // every group is returned as a json row
+    _scan->execute(gvm, nullptr);
+    std::vector<std::string> infos;
+    for (auto& row : _scan->aggregates()) {
+      beautify(row);
+      infos.emplace_back(row.dump());
+    }
+    gqlite_result result;
+    init_result_info(result, infos);
+    result.errcode = ECode_Success;
+    _cb(&result, _handle);
+    release_result_info(result);
+  }
+  else if (_cb && !_zeroCopy && !_columnar && _scan->estimateRows() >= PIPELINE_MIN_ROWS) {
+    // scan and serialization of rows are overlapped, and rows are returned in caller's thread
+    GPipeline pipeline;
+    pipeline.source([this, gvm](const GPipeline::Emit& emit) {
+      _scan->execute(gvm, [this, &emit](KeyType type, const std::string& key, nlohmann::json& value, int status) {
+        if (!emit({ type, key, std::move(value), std::string(), status })) {
+          _scan->stop();
+          return ExecuteStatus::Stop;
+        }
+        return ExecuteStatus::Continue;
+        });
+      });
+    pipeline.then([this](PipelineRow& row) {
+      row._text = serialize(row._type, row._value);
+      return true;
+      });
+    pipeline.run([this](PipelineRow& row) {
+      return output(row._type, row._key, row._text.data(), row._text.size(), row._status, true) != ECode_Query_Stop;
+      });
+    flush();
+  }
+  else if (_cb) {
     _scan->execute(gvm, [this](KeyType type, const std::string& key, nlohmann::json& value, int status) {
-      gqlite_result result;
-      result.count = 1;
-      result.type = gqlite_result_type_node;
-      result.errcode = status;
-      result.nodes = new gqlite_node;
-      result.nodes->_next = nullptr;
-      if (type != KeyType::Edge) {
-        convert_vertex(type, key, value, result);
+      int ret = ECode_Success;
+      const mdbx::slice& raw = _scan->raw();
+      if (status == ECode_Success && _columnar) {
+        ret = append(type, key, value);
+      }
+      else if (status == ECode_Success && raw.size() && (type == KeyType::Edge || is_plain((const char*)raw.data(), raw.size()))) {
+        // stored value is returned without decoding and copying
+        ret = output(type, key, (const char*)raw.data(), raw.size(), status, false);
+      }
+      else if (status == ECode_Success && raw.size()) {
+        // datetime, vector and binary attributes are formatted as copy mode
+        nlohmann::json row = nlohmann::json::parse((const char*)raw.data(), (const char*)raw.data() + raw.size());
+        std::string text = serialize(type, row);
+        ret = output(type, key, text.data(), text.size(), status, true);
       }
       else {
-        convert_edge(key, value, result);
+        std::string text = serialize(type, value);
+        ret = output(type, key, text.data(), text.size(), status, true);
+      }
+      if (ret == ECode_Query_Stop) {
+        _scan->stop();
+        return ExecuteStatus::Stop;
       }
-      delete result.nodes;
       return ExecuteStatus::Continue;
     });
-    
+    flush();
   }
   return 0;
 }
@@ -101,72 +168,111 @@ void GQueryPlan::beautify(nlohmann::json& input)
   }
 }
 
-void GQueryPlan::convert_vertex(KeyType type, const std::string& key, nlohmann::json& jsn, gqlite_result& result)
+std::string GQueryPlan::serialize(KeyType type, nlohmann::json& value)
 {
-  if (result.errcode != ECode_Success) {
+  if (type != KeyType::Edge) beautify(value);
+  return value.dump();
+}
+
+int GQueryPlan::output(KeyType type, const std::string& key, const char* value, size_t len, int status, bool copy)
+{
+  if (status != ECode_Success) {
+    // rows before error are returned first
+    int ret = flush();
+    if (ret == ECode_Query_Stop) return ret;
     gqlite_result err;
-    err.errcode = result.errcode;
+    err.errcode = status;
     err.type = gqlite_result_type::gqlite_result_type_info;
     err.count = 1;
     const char* p[1] = { key.c_str() };
     err.infos = (char**)p;
-    _cb(&err, _handle);
-    return;
+    return _cb(&err, _handle);
   }
-
-  beautify(jsn);
-  std::string value = jsn.dump();
-
-  result.nodes->_type = gqlite_node_type::gqlite_node_type_vertex;
-  result.nodes->_vertex = new gqlite_vertex;
-  if (type == KeyType::Integer) {
-    result.nodes->_vertex->type = gqlite_id_type::integer;
-    result.nodes->_vertex->uid = *(uint64_t*)key.data();
+  if (!_page) {
+    _page = _arena.allocate<gqlite_node>(QUERY_PAGE_SIZE);
+  }
+  gqlite_node& node = _page[_pageCount];
+  node._next = nullptr;
+  if (_pageCount) _page[_pageCount - 1]._next = &node;
+  if (type != KeyType::Edge) {
+    convert_vertex(type, key, value, len, copy, node);
   }
   else {
-    result.nodes->_vertex->type = gqlite_id_type::bytes;
-    result.nodes->_vertex->cid = (char*)key.data();
+    convert_edge(key, value, len, copy, node);
   }
-  
-  size_t len = value.size();
-  result.nodes->_vertex->properties = new char[len + 1];
-  memcpy(result.nodes->_vertex->properties, value.data(), sizeof(char) * len + 1);
-  _cb(&result, _handle);
-  delete[] result.nodes->_vertex->properties;
-  delete result.nodes->_vertex;
+  if (++_pageCount < QUERY_PAGE_SIZE) return ECode_Success;
+  return flush();
 }
 
-void GQueryPlan::convert_edge(const std::string& key, nlohmann::json& jsn, gqlite_result& result)
+int GQueryPlan::append(KeyType type, const std::string& key, nlohmann::json& value)
 {
-  result.nodes->_type = gqlite_node_type::gqlite_node_type_edge;
-  result.nodes->_edge = new gqlite_edge;
+  // vertexes and edges are returned in different pages
+  if (!_columns.accept(type) && flush() == ECode_Query_Stop) return ECode_Query_Stop;
+  if (type != KeyType::Edge) beautify(value);
+  _columns.add(type, key, value);
+  if (_columns.size() < QUERY_PAGE_SIZE) return ECode_Success;
+  return flush();
+}
 
-  auto id = gql::to_edge_id(key);
-  std::string idFrom(id._value, id._from_len);
-  result.nodes->_edge->from = new gqlite_vertex;
-  init_vertex(result.nodes->_edge->from, id._from_type, idFrom);
-  result.nodes->_edge->to = new gqlite_vertex;
-  std::string idTo(id._value + id._from_len, id._len - id._from_len);
-  init_vertex(result.nodes->_edge->to, id._to_type, idTo);
-  result.nodes->_edge->direction = id._direction;
-
-  std::string value = jsn.dump();
-  size_t len = value.size();
-  if (value != "null") {
-    result.nodes->_edge->properties = new char[len + 1];
-    memcpy(result.nodes->_edge->properties, value.data(), sizeof(char) * len + 1);
-    result.nodes->_edge->len = len;
-  }
-  else {
-    result.nodes->_edge->properties = nullptr;
-    result.nodes->_edge->len = 0;
+int GQueryPlan::flush()
+{
+  if (_columns.size()) {
+    releaseColumns();
+    _columns.build(&_schema, &_array);
+    gqlite_result result;
+    result.count = _columns.size();
+    result.type = gqlite_result_type_column;
+    result.errcode = ECode_Success;
+    result.columns = &_pageColumns;
+    int ret = _cb(&result, _handle);
+    _columns.clear();
+    return ret;
   }
+  if (_pageCount == 0) return ECode_Success;
+  gqlite_result result;
+  result.count = _pageCount;
+  result.type = gqlite_result_type_node;
+  result.errcode = ECode_Success;
+  result.nodes = _page;
+  int ret = _cb(&result, _handle);
+  _arena.reset();
+  _page = nullptr;
+  _pageCount = 0;
+  return ret;
+}
+
+void GQueryPlan::releaseColumns()
+{
+  // a moved page is released by its consumer
+  if (_schema.release) _schema.release(&_schema);
+  if (_array.release) _array.release(&_array);
+}
+
+void GQueryPlan::convert_vertex(KeyType type, const std::string& key, const char* value, size_t len, bool copy, gqlite_node& node)
+{
+  node._type = gqlite_node_type::gqlite_node_type_vertex;
+  node._vertex = init_vertex(_arena, type == KeyType::Integer ? 0 : 1, key.data(), key.size());
+  node._vertex->properties = copy ? _arena.copy(value, len) : (char*)value;
+  node._vertex->len = len;
+}
 
-  _cb(&result, _handle);
+void GQueryPlan::convert_edge(const std::string& key, const char* value, size_t len, bool copy, gqlite_node& node)
+{
+  node._type = gqlite_node_type::gqlite_node_type_edge;
+  node._edge = _arena.allocate<gqlite_edge>();
 
-  if (result.nodes->_edge->properties) delete[] result.nodes->_edge->properties;
-  delete result.nodes->_edge->to;
-  delete result.nodes->_edge->from;
+  auto id = gql::to_edge_id(key);
+  node._edge->from = init_vertex(_arena, id._from_type, id._value, id._from_len);
+  node._edge->to = init_vertex(_arena, id._to_type, id._value + id._from_len, id._len - id._from_len);
+  node._edge->direction = id._direction;
   gql::release_edge_id(id);
-  delete result.nodes->_edge;
+
+  if (len != 4 || memcmp(value, "null", 4) != 0) {
+    node._edge->properties = copy ? _arena.copy(value, len) : (char*)value;
+    node._edge->len = len;
+  }
+  else {
+    node._edge->properties = nullptr;
+    node._edge->len = 0;
+  }
 }
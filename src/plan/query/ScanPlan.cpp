@@ -12,13 +12,20 @@
 #include <float.h>
 #include <fmt/core.h>
 #include <fmt/color.h>
+#include <cmath>
 #include <set>
+#include <unordered_set>
 #include "json.hpp"
 #include "gutil.h"
 #include "Type/Datetime.h"
 #include "base/math/Distance.h"
 #include "base/gvm/GVM.h"
 #include "base/gvm/Compiler.h"
+#include "base/parallel/BoundedQueue.h"
+#include "base/JsonView.h"
+#include "plan/query/PredicateProgram.h"
+#include "plan/query/Aggregator.h"
+#include <mutex>
 
 #if __cplusplus > 201700
 #include <filesystem>
@@ -32,6 +39,10 @@ using namespace std::experimental;
 GScanPlan::GScanPlan(GContext* context, GQueryStmt* stmt)
 :GPlan(context->_graph, context->_storage, context->_schedule)
 , _queryType(QueryType::SimpleScan)
+, _limit(std::numeric_limits<size_t>::max())
+, _skip(0)
+, _descend(false)
+, _aggregator(nullptr)
 , _state(ScanState::Stop)
 {
   auto* ptr = stmt->graph();
@@ -46,12 +57,18 @@ GScanPlan::GScanPlan(GContext* context, GQueryStmt* stmt)
   auto* query = stmt->query();
   parseGroup(query);
   parseConditions(stmt->where());
+  parseOptions(stmt->options());
+  initJoins(context);
 }
 
 GScanPlan::GScanPlan(GContext* context, GListNode* condition, const std::string& group)
 :GPlan(context->_graph, context->_storage, context->_schedule)
   , _queryType(QueryType::SimpleScan)
   ,_group(group)
+  , _limit(std::numeric_limits<size_t>::max())
+  , _skip(0)
+  , _descend(false)
+  , _aggregator(nullptr)
 {
   auto jsn = _store->getSchema();
   _graph = jsn[SCHEMA_GRAPH_NAME];
@@ -62,6 +79,11 @@ GScanPlan::GScanPlan(GContext* context, GListNode* condition, const std::string&
 
 GScanPlan::~GScanPlan()
 {
+  delete _aggregator;
+  for (auto& join : _joins) {
+    delete join._plan;
+  }
+  _joins.clear();
   for (IObserver* observer: _observers)
   {
     delete observer;
@@ -101,10 +123,23 @@ int GScanPlan::prepare()
     return ECode_Graph_Not_Exist;
   }
   if (!_store->isMapExist(_group)) return ECode_Group_Not_Exist;
+  for (auto& join : _joins) {
+    if (!join._plan) continue;
+    int ret = join._plan->prepare();
+    if (ret != ECode_Success) return ret;
+  }
+  if (_aggregates.size() && !_aggregator) _aggregator = new GAggregator(_aggregates, _groupBy);
+  initDecodes();
+  // lambda of query is run by interpreted predicates
+  if (!_compiler && !_scanAll) _program.compile(_where);
   switch (_queryType)
   {
   case QueryType::SimpleScan:
   {
+    _access = chooseAccessPath();
+    if (_access._kind == AccessKind::Covering) _coverIndex = _access._indexes[0];
+    else if (_access._kind == AccessKind::Bucket) _bucketIndex = _access._indexes[0];
+    if (_access._kind != AccessKind::Scan) break;
     // check if index exist
     for (int index = 0; index < (long)LogicalPredicate::Max; ++index) {
       ScanPlans plans;
@@ -113,7 +148,10 @@ int GScanPlan::prepare()
         auto begin = pattern._nodes[0]->_attrs.begin();
         auto end = pattern._nodes[0]->_attrs.end();
         for (auto ptr = begin; ptr != end; ++ptr) {
-          plans.push_back({ 0, _group + ":" + *ptr});
+          std::string index = _group + ":" + *ptr;
+          // building index can't be used, and bucket index is only scanned by time range
+          if (!_store->isIndexReady(index) || _store->isBucketIndex(index)) continue;
+          plans.push_back({ 0, index });
         }
       }
       plans.insert(plans.end(), _queries[index].begin(), _queries[index].end());
@@ -135,11 +173,52 @@ int GScanPlan::prepare()
 int GScanPlan::execute(GVM* gvm, const std::function<ExecuteStatus(KeyType, const std::string& key, nlohmann::json& value, int status)>& processor) {
   _interrupt.store(false);
   start();
+  _skipped = 0;
+  _produced = 0;
+  // skipped rows are not returned, and scan is stopped when enough rows are returned
+  auto limited = [this, &processor](KeyType type, const std::string& key, nlohmann::json& value, int status) {
+    if (status != ECode_Success) return processor ? processor(type, key, value, status) : ExecuteStatus::Continue;
+    if (_skipped < _skip) {
+      ++_skipped;
+      return ExecuteStatus::Continue;
+    }
+    if (_produced >= _limit) {
+      stop();
+      return ExecuteStatus::Continue;
+    }
+    ExecuteStatus ret = processor ? processor(type, key, value, status) : ExecuteStatus::Continue;
+    if (++_produced >= _limit) stop();
+    return ret;
+  };
 #ifdef GQLITE_MULTI_THREAD
   _worker = std::thread(&GScanPlan::scan, this);
 #else
   _gvm = gvm;
-  scan(processor);
+  // no row is returned, so nothing is scanned
+  if (_limit == 0 && !_aggregator) {
+    stop();
+    return ECode_Success;
+  }
+  buildJoins(gvm);
+  if (_aggregator) aggregate();
+  else if (_order.size() && !isIndexOrdered()) {
+    // keep the first rows in a bounded heap, then return them in order
+    GTopK heap(_order, _descend, topK());
+    scan([this, &heap, &processor](KeyType type, const std::string& key, nlohmann::json& value, int status) {
+      if (status != ECode_Success) return processor ? processor(type, key, value, status) : ExecuteStatus::Continue;
+      heap.push(type, key, value);
+      return ExecuteStatus::Continue;
+      });
+    _state = ScanState::Scanning;
+    bool projected = _projection.empty() || std::find(_projection.begin(), _projection.end(), _order) != _projection.end();
+    for (auto& row : heap.sorted()) {
+      if (!projected) row._value.erase(_order);
+      limited(row._type, row._key, row._value, ECode_Success);
+      if (stopExit()) break;
+    }
+  }
+  else if (_limit == std::numeric_limits<size_t>::max() && _skip == 0) scan(processor);
+  else scan(limited);
 #endif
   return ECode_Success;
 }
@@ -176,9 +255,26 @@ void GScanPlan::stop()
 int GScanPlan::scan(const std::function<ExecuteStatus(KeyType, const std::string& key, nlohmann::json& value, int status)>& cb)
 {
   if (_queries[0].size() == 0 && _queries[1].size() == 0) return ECode_Success;
+  if (!_coverIndex.empty()) return scanCovering(cb);
+  if (!_bucketIndex.empty()) return scanBucket(cb);
+  if (_access._kind == AccessKind::Index || _access._kind == AccessKind::Intersection) return scanIndex(cb);
   int ret = scan();
   if (ret == ECode_Query_Pause || ret == ECode_Query_Stop) return ECode_Success;
   if (ret != ECode_Success) return ECode_Fail;
+  std::map<std::string, size_t> parallels;
+  for (int index = 0; index < (long)LogicalPredicate::Max; ++index) {
+    for (auto& plan : _queries[index]) {
+      size_t workers = parallelism(plan._group);
+      if (workers > 1) parallels[plan._group] = workers;
+    }
+  }
+  // workers read the last committed snapshot, so writes of session are committed first.
+  // Transaction pinned by a suspended statement can't be committed, so it is scanned by session.
+  if (_store->isTransPinned()) parallels.clear();
+  if (parallels.size() && _store->isTransDirty()) _store->commitTrans();
+  // a row is returned as stored bytes if it is not projected, joined or sorted
+  bool raw = _rawEnable && _projection.empty() && _decodes.empty() && _observers.empty()
+    && _joins.empty() && _order.empty() && !_aggregator;
   for (int index = 0; index < (long)LogicalPredicate::Max; ++index) {
     if (_scanRecord._op != (LogicalPredicate)index) continue;
     ScanPlans::iterator itr = _queries[index].begin();
@@ -192,26 +288,40 @@ int GScanPlan::scan(const std::function<ExecuteStatus(KeyType, const std::string
     {
       std::string group = itr->_group;
       KeyType type = _store->getKeyType(group);
-      while (data)
+      auto parallel = parallels.find(group);
+      if (parallel != parallels.end()) {
+        ret = scanParallel(group, parallel->second, cb);
+        if (ret != ECode_Success) return ret;
+        if (stopExit()) return ECode_Success;
+      }
+      while (parallel == parallels.end() && data)
       {
-        std::string str((char*)data.value.byte_ptr(), data.value.size());
-        //printf("scan: %s\n", str.c_str());
+        if (_scanAll && _order.empty() && !_aggregator && _skipped < _skip) {
+          // every row matches, so skipped rows are not decoded
+          ++_skipped;
+          data = cursor.to_next(false);
+          continue;
+        }
         switch (_queryType)
         {
         case QueryType::SimpleScan:
         {
           gkey_t vKey = getKey(type, data.key);
-          nlohmann::json jsn = nlohmann::json::parse(str);
+          nlohmann::json jsn = (raw && _scanAll) ? nlohmann::json() : decode(data.value);
           try {
             if (_scanAll || (!_scanAll && predict(type, vKey, jsn))) {
               std::string k((char*)data.key.byte_ptr(), data.key.size());
               for (IObserver* observer : _observers) {
                 observer->update(type, k, jsn);
               }
+              project(type, jsn);
+              if (raw) _raw = data.value;
               if (cb) cb(type, k, jsn, ECode_Success);
+              _raw = mdbx::slice();
             }
           }
           catch (gql::variant_bad_cast& e) {
+            _raw = mdbx::slice();
             if (cb) cb(type, e.what(), jsn, ECode_GQL_Type_Not_Match);
             else {
               fmt::print(fmt::fg(fmt::color::yellow), "{}", e.what());
@@ -243,6 +353,201 @@ int GScanPlan::scan(const std::function<ExecuteStatus(KeyType, const std::string
   return ECode_Success;
 }
 
+size_t GScanPlan::parallelism(const std::string& group)
+{
+  if (_queryType != QueryType::SimpleScan || !_store->isMapExist(group)) return 1;
+  // rows of a page should be in order of keys if they are not ordered by attribute
+  if ((_limit != std::numeric_limits<size_t>::max() || _skip) && _order.empty() && !_aggregator) return 1;
+  KeyType type = _store->getKeyType(group);
+  if (type != KeyType::Integer && type != KeyType::Byte) return 1;
+  size_t rows = _store->estimate(group);
+  if (rows < SCAN_PARALLEL_MIN_ROWS) return 1;
+  size_t workers = std::min<size_t>(std::thread::hardware_concurrency(), rows / SCAN_PARTITION_ROWS);
+  return workers > 1 ? workers : 1;
+}
+
+std::vector<std::string> GScanPlan::partition(const std::string& group, size_t parts)
+{
+  std::vector<std::string> bounds;
+  KeyType type = _store->getKeyType(group);
+  // key is mapped to a number, integer key is itself and byte key is its first 8 bytes
+  auto to_point = [type](const mdbx::slice& key) -> uint64_t {
+    if (type == KeyType::Integer) return *(uint64_t*)key.byte_ptr();
+    uint64_t point = 0;
+    for (size_t idx = 0; idx < sizeof(uint64_t); ++idx) {
+      point = (point << 8) | (idx < key.size() ? key.byte_ptr()[idx] : 0);
+    }
+    return point;
+  };
+  auto to_key = [type](uint64_t point) -> std::string {
+    if (type == KeyType::Integer) return std::string((char*)&point, sizeof(uint64_t));
+    std::string key;
+    for (int idx = sizeof(uint64_t) - 1; idx >= 0; --idx) {
+      key.push_back((char)((point >> (idx * 8)) & 0xFF));
+    }
+    while (key.size() > 1 && key.back() == 0) key.pop_back();
+    return key;
+  };
+  GStorageEngine::cursor first = _store->getMapCursor(group);
+  GStorageEngine::cursor last = _store->getMapCursor(group);
+  auto begin = first.to_first(false);
+  auto end = last.to_last(false);
+  if (!begin || !end) return bounds;
+  ptrdiff_t total = mdbx::estimate(first, last);
+  uint64_t low = to_point(begin.key);
+  uint64_t high = to_point(end.key);
+  GStorageEngine::cursor probe = _store->getMapCursor(group);
+  for (size_t part = 1; part < parts; ++part) {
+    ptrdiff_t target = total * part / parts;
+    // binary search the smallest point whose distance from first key is not less than target
+    uint64_t from = low, to = high;
+    while (from < to) {
+      uint64_t mid = from + (to - from) / 2;
+      std::string key = to_key(mid);
+      probe.move(mdbx::cursor::key_lowerbound, mdbx::slice(key.data(), key.size()), false);
+      if (mdbx::estimate(first, probe) < target) from = mid + 1;
+      else to = mid;
+    }
+    if (from == low) continue;
+    std::string bound = to_key(from);
+    if (bounds.empty() || bounds.back() != bound) bounds.emplace_back(bound);
+    low = from;
+  }
+  return bounds;
+}
+
+int GScanPlan::scanParallel(const std::string& group, size_t workers, const std::function<ExecuteStatus(KeyType, const std::string& key, nlohmann::json& value, int status)>& cb)
+{
+  KeyType type = _store->getKeyType(group);
+  // ranges are [bounds[i], bounds[i + 1]), and empty bound means no limit
+  std::vector<std::string> bounds = partition(group, workers);
+  bounds.insert(bounds.begin(), std::string());
+  bounds.push_back(std::string());
+  auto less = [type](const mdbx::slice& key, const std::string& bound) -> bool {
+    if (type == KeyType::Integer) return *(uint64_t*)key.byte_ptr() < *(uint64_t*)bound.data();
+    int cmp = memcmp(key.byte_ptr(), bound.data(), std::min(key.size(), bound.size()));
+    return cmp < 0 || (cmp == 0 && key.size() < bound.size());
+  };
+
+  struct Row {
+    std::string _key;
+    nlohmann::json _value;
+    int _status;
+  };
+  GBoundedQueue<Row> queue(SCAN_QUEUE_SIZE, bounds.size() - 1);
+  std::mutex merging;
+  // first error of workers. Other workers stop when it is set
+  std::atomic<int> failure(ECode_Success);
+  auto worker = [&](size_t part) {
+    const std::string& lower = bounds[part];
+    const std::string& upper = bounds[part + 1];
+    // an ordered query only sends the first rows of every worker
+    GTopK heap(_order, _descend, topK());
+    // an aggregate query only merges partial aggregates of every worker
+    GAggregator partial(_aggregates, _groupBy);
+    auto emit = [&](Row&& row) -> bool {
+      if (_aggregator && row._status == ECode_Success) {
+        partial.add(row._value);
+        return true;
+      }
+      if (_order.empty() || row._status != ECode_Success) return queue.push(std::move(row));
+      heap.push(type, row._key, row._value);
+      return true;
+    };
+    try {
+      mdbx::txn_managed txn = _store->startSnapshot();
+      GStorageEngine::cursor cursor = GStorageEngine::getSnapshotCursor(txn, group);
+      GVM gvm(_store);
+      auto data = lower.empty() ? cursor.to_first(false) :
+        cursor.move(mdbx::cursor::key_lowerbound, mdbx::slice(lower.data(), lower.size()), false);
+      if (_program.compiled()) {
+        // rows are read in batch, and compiled predicates select rows of batch
+        std::vector<std::string> strKeys;
+        std::vector<gkey_t> keys;
+        std::vector<nlohmann::json> rows;
+        std::vector<uint32_t> selection;
+        bool finished = false;
+        while (!finished && data && !_interrupt && failure == ECode_Success) {
+          strKeys.clear();
+          keys.clear();
+          rows.clear();
+          for (; data && rows.size() < SCAN_BATCH_SIZE; data = cursor.to_next(false)) {
+            if (!upper.empty() && !less(data.key, upper)) {
+              finished = true;
+              break;
+            }
+            strKeys.emplace_back((char*)data.key.byte_ptr(), data.key.size());
+            keys.emplace_back(getKey(type, data.key));
+            rows.emplace_back(decode(data.value));
+          }
+          _program.select(type, keys, rows, selection);
+          for (uint32_t idx : selection) {
+            project(type, rows[idx]);
+            if (!emit({ std::move(strKeys[idx]), std::move(rows[idx]), ECode_Success })) {
+              finished = true;
+              break;
+            }
+          }
+        }
+      }
+      while (!_program.compiled() && data && !_interrupt && failure == ECode_Success) {
+        if (!upper.empty() && !less(data.key, upper)) break;
+        Row row{ std::string((char*)data.key.byte_ptr(), data.key.size()), decode(data.value), ECode_Success };
+        bool matched = true;
+        try {
+          matched = _scanAll || predict(type, getKey(type, data.key), row._value, &gvm);
+          if (matched) project(type, row._value);
+        }
+        catch (gql::variant_bad_cast& e) {
+          row._key = e.what();
+          row._status = ECode_GQL_Type_Not_Match;
+        }
+        if (matched && !emit(std::move(row))) break;
+        data = cursor.to_next(false);
+      }
+    }
+    catch (std::exception& err) {
+      // rows of partition are not all read, so scan fails
+      int success = ECode_Success;
+      failure.compare_exchange_strong(success, ECode_Fail);
+    }
+    if (_aggregator) {
+      std::unique_lock<std::mutex> lock(merging);
+      _aggregator->merge(partial);
+    }
+    for (auto& row : heap.sorted()) {
+      if (!queue.push({ std::move(row._key), std::move(row._value), ECode_Success })) break;
+    }
+    queue.done();
+  };
+  std::vector<std::thread> threads;
+  for (size_t part = 0; part + 1 < bounds.size(); ++part) {
+    threads.emplace_back(worker, part);
+  }
+  Row row;
+  while (queue.pop(row)) {
+    if (row._status != ECode_Success) {
+      if (cb) cb(type, row._key, row._value, row._status);
+      else {
+        fmt::print(fmt::fg(fmt::color::yellow), "{}", row._key);
+      }
+      continue;
+    }
+    for (IObserver* observer : _observers) {
+      observer->update(type, row._key, row._value);
+    }
+    if (cb) cb(type, row._key, row._value, ECode_Success);
+    if (stopExit()) {
+      queue.close();
+      break;
+    }
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  return failure;
+}
+
 int GScanPlan::scan()
 {
   if (_queries[0].size() == 0 && _queries[1].size() == 0) return ECode_Success;
@@ -278,11 +583,11 @@ int GScanPlan::scan()
           {
             double from = 0;
             double to = 100;
-            std::string sf((char*)&from, sizeof(double));
-            std::string st((char*)&to, sizeof(double));
+            std::string sf = gql::to_ordered_key(from);
+            std::string st = gql::to_ordered_key(to);
             auto data = cursor.to_first(false);
             while (data) {
-              double value = *(double*)data.key.byte_ptr();
+              double value = gql::from_ordered_key((const char*)data.key.byte_ptr());
               if (value >= from && value < to) {
 
               }
@@ -313,10 +618,434 @@ int GScanPlan::scan()
   return ECode_Success;
 }
 
+int GScanPlan::scanCovering(const std::function<ExecuteStatus(KeyType, const std::string& key, nlohmann::json& value, int status)>& cb)
+{
+  std::string attr = _coverIndex.substr(_group.size() + 1);
+  // scan range of encoded value
+  std::string equal, lower, upper;
+  for (auto& cond : _where._patterns[(long)LogicalPredicate::And]._node_conditions) {
+    if (cond._attr != attr || cond._op == CompareOperator::Other) continue;
+    std::string encoded = cond._value.visit(
+      [](std::string value) { return GStorageEngine::encodeCovering(value); },
+      [](double value) { return GStorageEngine::encodeCovering(value); });
+    switch (cond._op) {
+    case CompareOperator::Equal:
+      equal = encoded;
+      break;
+    case CompareOperator::GreatThan:
+    case CompareOperator::GreatEqual:
+      if (lower.empty() || encoded > lower) lower = encoded;
+      break;
+    case CompareOperator::LessThan:
+    case CompareOperator::LessEqual:
+      if (upper.empty() || encoded < upper) upper = encoded;
+      break;
+    default:
+      break;
+    }
+  }
+  if (!equal.empty()) {
+    lower = equal;
+    upper = equal;
+  }
+
+  KeyType type = _store->getKeyType(_group);
+  // a row may have many entries if its attribute is array
+  std::unordered_set<std::string> visited;
+  GStorageEngine::cursor cursor = _store->getCoveringCursor(_coverIndex);
+  auto data = lower.empty() ? cursor.to_first(false) :
+    cursor.move(mdbx::cursor::key_lowerbound, mdbx::slice(lower.data(), lower.size()), false);
+  while (data) {
+    std::string value, k;
+    nlohmann::json row;
+    GStorageEngine::parseCovering(data.key, data.value, value, k, row);
+    if (!upper.empty() && value > upper) break;
+    if (equal.empty() && visited.count(k)) {
+      data = cursor.to_next(false);
+      continue;
+    }
+    try {
+      nlohmann::json jsnIndex = row;
+      if (row.count(attr) && row[attr].is_array()) {
+        // element of array is indexed, so compare with the element
+        jsnIndex[attr] = value.substr(0, value.size() - 1);
+      }
+      if (predictCovering(jsnIndex)) {
+        // row is returned once. It is not visited until an element of it matches
+        if (equal.empty()) visited.insert(k);
+        nlohmann::json jsn;
+        for (auto& name : _projection) {
+          if (row.count(name)) jsn[name] = row[name];
+        }
+        for (IObserver* observer : _observers) {
+          observer->update(type, k, jsn);
+        }
+        if (cb) cb(type, k, jsn, ECode_Success);
+      }
+    }
+    catch (gql::variant_bad_cast& e) {
+      if (cb) cb(type, e.what(), row, ECode_GQL_Type_Not_Match);
+      else {
+        fmt::print(fmt::fg(fmt::color::yellow), "{}", e.what());
+      }
+    }
+    data = cursor.to_next(false);
+    if (stopExit()) break;
+  }
+  return ECode_Success;
+}
+
+std::string GScanPlan::chooseCoveringIndex()
+{
+  if (_projection.empty() || _scanAll || _compiler) return "";
+  if (_queries[0].size() != 1 || _queries[1].size()) return "";
+  auto& andPattern = _where._patterns[(long)LogicalPredicate::And];
+  auto& orPattern = _where._patterns[(long)LogicalPredicate::Or];
+  if (andPattern._edges.size() || orPattern._edges.size() || orPattern._node_predicates.size()) return "";
+  // predicate of key can't be checked by covering index
+  auto& conditions = andPattern._node_conditions;
+  if (conditions.empty() || conditions.size() != andPattern._node_predicates.size()) return "";
+
+  std::string choice;
+  for (auto& cond : conditions) {
+    if (cond._op == CompareOperator::Other) continue;
+    std::string index = _group + ":" + cond._attr;
+    if (!_store->isCoveringIndex(index) || !_store->isIndexReady(index)) continue;
+    auto includes = _store->getIndexIncludes(index);
+    std::set<std::string> covered(includes.begin(), includes.end());
+    covered.insert(cond._attr);
+    bool isCover = true;
+    for (auto& name : _projection) {
+      if (!covered.count(name)) isCover = false;
+    }
+    for (auto& item : conditions) {
+      if (!covered.count(item._attr)) isCover = false;
+    }
+    if (!isCover) continue;
+    if (cond._op == CompareOperator::Equal) return index;
+    if (choice.empty()) choice = index;
+  }
+  return choice;
+}
+
+int GScanPlan::scanBucket(const std::function<ExecuteStatus(KeyType, const std::string& key, nlohmann::json& value, int status)>& cb)
+{
+  std::string attr = _bucketIndex.substr(_group.size() + 1);
+  // time range, bounds are checked by predicates again
+  double lower = 0;
+  double upper = std::numeric_limits<double>::max();
+  for (auto& cond : _where._patterns[(long)LogicalPredicate::And]._node_conditions) {
+    if (cond._attr != attr) continue;
+    bool isNumber = cond._value.visit(
+      [](std::string) { return false; },
+      [](double) { return true; });
+    if (!isNumber) continue;
+    double value = cond._value.Get<double>();
+    switch (cond._op) {
+    case CompareOperator::Equal:
+      lower = std::max(lower, value);
+      upper = std::min(upper, value);
+      break;
+    case CompareOperator::GreatThan:
+    case CompareOperator::GreatEqual:
+      lower = std::max(lower, value);
+      break;
+    case CompareOperator::LessThan:
+    case CompareOperator::LessEqual:
+      upper = std::min(upper, value);
+      break;
+    default:
+      break;
+    }
+  }
+  if (upper < lower) return ECode_Success;
+
+  KeyType type = _store->getKeyType(_group);
+  uint64_t interval = _store->getBucketInterval(_bucketIndex);
+  GStorageEngine::BucketEntry entry{ (uint64_t)std::ceil(lower), std::string() };
+  std::string from = GStorageEngine::encodeBucket(entry._time - entry._time % interval, &entry);
+  GStorageEngine::cursor cursor = _store->getBucketCursor(_bucketIndex);
+  uint64_t bucket = 0;
+  for (auto data = cursor.move(mdbx::cursor::key_lowerbound, mdbx::slice(from.data(), from.size()), false);
+    data; data = cursor.to_next(false)) {
+    if (!GStorageEngine::parseBucket(data.key, bucket, entry)) continue;
+    if ((double)entry._time > upper) break;
+    std::string value;
+    int ret = (type == KeyType::Integer) ?
+      _store->read(_group, *(uint64_t*)entry._key.data(), value) : _store->read(_group, entry._key, value);
+    if (ret != ECode_Success) continue;
+    mdbx::slice k(entry._key.data(), entry._key.size());
+    gkey_t vKey = getKey(type, k);
+    nlohmann::json jsn = decode(mdbx::slice(value.data(), value.size()));
+    try {
+      if (predict(type, vKey, jsn)) {
+        for (IObserver* observer : _observers) {
+          observer->update(type, entry._key, jsn);
+        }
+        project(type, jsn);
+        if (cb) cb(type, entry._key, jsn, ECode_Success);
+      }
+    }
+    catch (gql::variant_bad_cast& e) {
+      if (cb) cb(type, e.what(), jsn, ECode_GQL_Type_Not_Match);
+      else {
+        fmt::print(fmt::fg(fmt::color::yellow), "{}", e.what());
+      }
+    }
+    if (stopExit()) return ECode_Success;
+  }
+  return ECode_Success;
+}
+
+AccessPath GScanPlan::chooseAccessPath()
+{
+  AccessPath scan;
+  if (_scanAll || _compiler) return scan;
+  if (_queries[0].size() != 1 || _queries[1].size()) return scan;
+  auto& andPattern = _where._patterns[(long)LogicalPredicate::And];
+  auto& orPattern = _where._patterns[(long)LogicalPredicate::Or];
+  if (andPattern._edges.size() || orPattern._edges.size() || orPattern._node_predicates.size()) return scan;
+  GOptimizer optimizer(_store, _group);
+  return optimizer.choose(andPattern._node_conditions, chooseCoveringIndex(), chooseBucketIndex());
+}
+
+std::vector<std::string> GScanPlan::readPostings(const std::string& index)
+{
+  std::vector<std::string> keys;
+  std::string lower, upper;
+  auto& conditions = _where._patterns[(long)LogicalPredicate::And]._node_conditions;
+  if (!GOptimizer::range(_store->getIndexType(index), index.substr(_group.size() + 1), conditions, lower, upper)) return keys;
+  KeyType type = _store->getKeyType(_group);
+  GStorageEngine::cursor cursor = _store->getIndexCursor(index);
+  auto data = cursor.move(mdbx::cursor::key_lowerbound, mdbx::slice(lower.data(), lower.size()), false);
+  while (data) {
+    std::string value((char*)data.key.byte_ptr(), data.key.size());
+    if (!upper.empty() && (upper == lower ? value != upper : value > upper)) break;
+    std::string ids((char*)data.value.byte_ptr(), data.value.size());
+    if (type == KeyType::Integer) {
+      for (size_t offset = 0; offset + sizeof(uint64_t) <= ids.size(); offset += sizeof(uint64_t)) {
+        keys.emplace_back(ids.substr(offset, sizeof(uint64_t)));
+      }
+    }
+    else {
+      for (auto& id : gql::split(ids, '\0')) keys.emplace_back(id);
+    }
+    if (upper == lower) break;
+    data = cursor.to_next(false);
+  }
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  return keys;
+}
+
+int GScanPlan::scanIndex(const std::function<ExecuteStatus(KeyType, const std::string& key, nlohmann::json& value, int status)>& cb)
+{
+  std::vector<std::string> keys;
+  for (size_t idx = 0; idx < _access._indexes.size(); ++idx) {
+    std::vector<std::string> postings = readPostings(_access._indexes[idx]);
+    if (idx == 0) {
+      keys = std::move(postings);
+      continue;
+    }
+    std::vector<std::string> both;
+    std::set_intersection(keys.begin(), keys.end(), postings.begin(), postings.end(), std::back_inserter(both));
+    keys = std::move(both);
+    if (keys.empty()) break;
+  }
+  KeyType type = _store->getKeyType(_group);
+  // rows are returned in order of keys as scan does
+  if (type == KeyType::Integer) {
+    std::sort(keys.begin(), keys.end(), [](const std::string& left, const std::string& right) {
+      return *(uint64_t*)left.data() < *(uint64_t*)right.data();
+      });
+  }
+  for (auto& key : keys) {
+    std::string value;
+    int ret = (type == KeyType::Integer) ?
+      _store->read(_group, *(uint64_t*)key.data(), value) : _store->read(_group, key, value);
+    if (ret != ECode_Success) continue;
+    mdbx::slice k(key.data(), key.size());
+    gkey_t vKey = getKey(type, k);
+    nlohmann::json jsn = decode(mdbx::slice(value.data(), value.size()));
+    try {
+      if (predict(type, vKey, jsn)) {
+        for (IObserver* observer : _observers) {
+          observer->update(type, key, jsn);
+        }
+        project(type, jsn);
+        if (cb) cb(type, key, jsn, ECode_Success);
+      }
+    }
+    catch (gql::variant_bad_cast& e) {
+      if (cb) cb(type, e.what(), jsn, ECode_GQL_Type_Not_Match);
+      else {
+        fmt::print(fmt::fg(fmt::color::yellow), "{}", e.what());
+      }
+    }
+    if (stopExit()) break;
+  }
+  return ECode_Success;
+}
+
+std::string GScanPlan::chooseBucketIndex()
+{
+  if (_scanAll || _compiler) return "";
+  if (_queries[0].size() != 1 || _queries[1].size()) return "";
+  auto& andPattern = _where._patterns[(long)LogicalPredicate::And];
+  auto& orPattern = _where._patterns[(long)LogicalPredicate::Or];
+  if (andPattern._edges.size() || orPattern._edges.size() || orPattern._node_predicates.size()) return "";
+  for (auto& cond : andPattern._node_conditions) {
+    if (cond._op == CompareOperator::Other) continue;
+    std::string index = _group + ":" + cond._attr;
+    if (!_store->isBucketIndex(index) || !_store->isIndexReady(index)) continue;
+    bool isNumber = cond._value.visit(
+      [](std::string) { return false; },
+      [](double) { return true; });
+    if (isNumber) return index;
+  }
+  return "";
+}
+
+bool GScanPlan::getCondition(AttributeCondition& condition) const
+{
+  auto& andPattern = _where._patterns[(long)LogicalPredicate::And];
+  auto& orPattern = _where._patterns[(long)LogicalPredicate::Or];
+  if (orPattern._node_predicates.size() || andPattern._edges.size()) return false;
+  if (andPattern._node_predicates.size() != 1 || andPattern._node_conditions.size() != 1) return false;
+  condition = andPattern._node_conditions[0];
+  return true;
+}
+
+bool GScanPlan::predictCovering(const nlohmann::json& row)
+{
+  auto& pattern = _where._patterns[(long)LogicalPredicate::And];
+  for (size_t idx = 0; idx < pattern._node_predicates.size(); ++idx) {
+    const std::string& attr = pattern._node_conditions[idx]._attr;
+    if (row.count(attr) == 0) return false;
+    bool result = pattern._node_predicates[idx].visit(
+      [](std::function<bool(const gkey_t&)> op) {
+        return false;
+      },
+      [&row, &attr, this](std::function<bool(const attribute_t&)> op) {
+        return predict(op, row[attr]);
+      });
+    if (!result) return false;
+  }
+  return true;
+}
+
+void GScanPlan::initDecodes()
+{
+  _decodes.clear();
+  // lambda and observers may use any attribute
+  if (_compiler || _observers.size()) return;
+  if (_aggregator) {
+    auto attrs = _aggregator->attributes();
+    // count of rows reads no attribute, but an empty set means all attributes
+    if (attrs.empty()) attrs.push_back(OBJECT_TYPE_NAME);
+    _decodes.insert(attrs.begin(), attrs.end());
+  }
+  else if (_projection.empty()) return;
+  else _decodes.insert(_projection.begin(), _projection.end());
+  if (_order.size()) _decodes.insert(_order);
+  for (int index = 0; index < (long)LogicalPredicate::Max; ++index) {
+    auto& pattern = _where._patterns[index];
+    if (pattern._nodes.size()) {
+      _decodes.insert(pattern._nodes[0]->_attrs.begin(), pattern._nodes[0]->_attrs.end());
+    }
+    for (auto& cond : pattern._node_conditions) {
+      _decodes.insert(cond._attr);
+    }
+  }
+}
+
+nlohmann::json GScanPlan::decode(const mdbx::slice& value) const
+{
+  const char* begin = (const char*)value.byte_ptr();
+  const char* end = begin + value.size();
+  if (_decodes.empty()) return nlohmann::json::parse(begin, end);
+  GJsonView view(begin, value.size());
+  if (view.valid()) {
+    nlohmann::json row = nlohmann::json::object();
+    for (auto& name : _decodes) {
+      nlohmann::json attr;
+      if (view.get(name, attr)) row[name] = std::move(attr);
+    }
+    return row;
+  }
+  return nlohmann::json::parse(begin, end, [this](int depth, nlohmann::json::parse_event_t event, nlohmann::json& parsed) {
+    // returning false on a key drops its value
+    if (depth == 1 && event == nlohmann::json::parse_event_t::key) {
+      return _decodes.count(parsed.get<std::string>()) != 0;
+    }
+    return true;
+  });
+}
+
+void GScanPlan::project(KeyType type, nlohmann::json& row) const
+{
+  if (_projection.empty() || type == KeyType::Edge || !row.is_object()) return;
+  nlohmann::json result = nlohmann::json::object();
+  for (auto& name : _projection) {
+    auto itr = row.find(name);
+    if (itr != row.end() && !itr->is_null()) result[name] = std::move(*itr);
+  }
+  // order attribute is removed after rows are sorted
+  if (_order.size() && row.count(_order) && !result.count(_order)) result[_order] = std::move(row[_order]);
+  row = std::move(result);
+}
+
+void GScanPlan::parseOptions(GListNode* options)
+{
+  if (!options || options->_nodetype != NodeType::ArrayExpression) return;
+  GArrayExpression* arr = (GArrayExpression*)options->_value;
+  for (auto itr = arr->begin(), end = arr->end(); itr != end; ++itr) {
+    if ((*itr)->_nodetype != NodeType::Property) continue;
+    GProperty* prop = (GProperty*)(*itr)->_value;
+    if (prop->key() == "order" && prop->value()->_nodetype == NodeType::Property) {
+      // `order: {attr: 'desc'}`
+      GProperty* order = (GProperty*)prop->value()->_value;
+      _order = order->key();
+      _descend = (GetString(order->value()) == "desc");
+      continue;
+    }
+    if (prop->key() == "by") {
+      _groupBy = GetString(prop->value());
+      continue;
+    }
+    attribute_t value;
+    if (!GetLiteral(prop->value(), value)) continue;
+    bool isNumber = value.visit(
+      [](std::string) { return false; },
+      [](double) { return true; });
+    if (!isNumber || value.Get<double>() < 0) continue;
+    if (prop->key() == "limit") _limit = (size_t)value.Get<double>();
+    else if (prop->key() == "skip") _skip = (size_t)value.Get<double>();
+  }
+}
+
+size_t GScanPlan::topK() const
+{
+  if (_limit == std::numeric_limits<size_t>::max()) return _limit;
+  return (_limit > std::numeric_limits<size_t>::max() - _skip) ? std::numeric_limits<size_t>::max() : _limit + _skip;
+}
+
+size_t GScanPlan::estimateRows() const
+{
+  size_t rows = (_access._kind == AccessKind::Scan) ? _store->count(_group) : (size_t)_access._rows;
+  return std::min(rows, topK());
+}
+
+bool GScanPlan::isIndexOrdered() const
+{
+  return !_descend && !_coverIndex.empty() && _coverIndex == _group + ":" + _order;
+}
+
 void GScanPlan::parseGroup(GListNode* query)
 {
   if (query->_nodetype == NodeType::ArrayExpression) {
     GArrayExpression* arr = reinterpret_cast<GArrayExpression*>(query->_value);
+    bool projectAll = false;
     for (auto itr = arr->begin(), end = arr->end(); itr != end; ++itr) {
       switch ((*itr)->_nodetype)
       {
@@ -325,20 +1054,111 @@ void GScanPlan::parseGroup(GListNode* query)
         GMemberExpression* expr = (GMemberExpression*)(*itr)->_value;
         _group = expr->GetObjectName();
         initQueryGroups(_group);
+        if (projectAll) break;
+        std::string prop = expr->GetPropertyName();
+        if (prop == "*") projectAll = true;
+        else _projection.emplace_back(prop);
       }
         break;
       case NodeType::Literal:
         initQueryGroups(GetString(*itr));
+        projectAll = true;
+        break;
+      case NodeType::CallExpression:
+        parseAggregate(*itr);
         break;
       default:
         break;
       }
     }
+    // result of aggregate query is aggregated attributes only
+    if (projectAll || _aggregates.size()) _projection.clear();
   }
   else if (query->_nodetype == NodeType::Literal) {
     _group = GetString(query);
     initQueryGroups(_group);
   }
+  else if (query->_nodetype == NodeType::CallExpression) {
+    parseAggregate(query);
+  }
+}
+
+void GScanPlan::parseAggregate(GListNode* call)
+{
+  GObjectFunction* func = (GObjectFunction*)call->_value;
+  AggregateSpec spec;
+  if (func->size() == 0 || !GAggregator::parseKind(func->name(), spec._kind)) return;
+  if (func->size() == 2) {
+    // rank of quantile, such as `approx_quantile(g.rating, 0.5)`
+    attribute_t value;
+    if (!GetLiteral((*func)[1], value)) return;
+    bool isNumber = value.visit(
+      [](std::string) { return false; },
+      [](double) { return true; });
+    if (!isNumber) return;
+    spec._param = value.Get<double>();
+  }
+  GListNode* param = (*func)[0];
+  std::string group;
+  if (param->_nodetype == NodeType::MemberExpression) {
+    GMemberExpression* expr = (GMemberExpression*)param->_value;
+    group = expr->GetObjectName();
+    spec._attr = expr->GetPropertyName();
+  }
+  else if (param->_nodetype == NodeType::Literal) {
+    group = GetString(param);
+  }
+  else return;
+  if (group != _group) {
+    _group = group;
+    initQueryGroups(_group);
+  }
+  _aggregates.emplace_back(spec);
+}
+
+int GScanPlan::aggregate()
+{
+  _aggregator->clear();
+  if (_scanAll && _groupBy.empty() && _observers.empty()) {
+    // count of rows is count of group map, and count of distinct values is count of index map,
+    // because every value of a word or number index is a key of index unless index is partial.
+    std::vector<std::string> maps;
+    for (auto& spec : _aggregates) {
+      std::string index = _group + ":" + spec._attr;
+      if (spec._kind == AggregateKind::Count && spec._attr.empty()) maps.push_back("");
+      else if (spec._kind == AggregateKind::ApproxCountDistinct && _queries[0].size() == 1 &&
+        _store->isIndexExist(index) && _store->isIndexReady(index) && !_store->isIndexPartial(index) && !_store->isBucketIndex(index) &&
+        _store->getIndexType(index) != IndexType::Vector) maps.push_back(index);
+      else break;
+    }
+    if (maps.size() == _aggregates.size()) {
+      for (size_t idx = 0; idx < maps.size(); ++idx) {
+        if (maps[idx].size()) {
+          _aggregator->addCount(idx, _store->count(maps[idx]));
+          continue;
+        }
+        for (auto& plan : _queries[0]) {
+          _aggregator->addCount(idx, _store->count(plan._group));
+        }
+      }
+      return ECode_Success;
+    }
+  }
+  return scan([this](KeyType type, const std::string& key, nlohmann::json& value, int status) {
+    if (status == ECode_Success) _aggregator->add(value);
+    return ExecuteStatus::Continue;
+    });
+}
+
+std::vector<nlohmann::json> GScanPlan::aggregates() const
+{
+  if (!_aggregator) return {};
+  std::vector<nlohmann::json> rows = _aggregator->result();
+  // skip and limit are applied to groups
+  if (_skip >= rows.size()) return {};
+  rows.erase(rows.begin(), rows.begin() + _skip);
+  if (rows.size() > _limit) rows.resize(_limit);
+  return rows;
 }
 
 void GScanPlan::parseConditions(GListNode* conditions)
@@ -418,12 +1238,13 @@ gkey_t GScanPlan::getKey(KeyType type, mdbx::slice& slice)
   return vKey;
 }
 
-bool GScanPlan::predictVertex(gkey_t key, nlohmann::json& row)
+bool GScanPlan::predictVertex(gkey_t key, nlohmann::json& row, GVM* gvm)
 {
   bool result = true;
   if (_compiler) {
-    if (_gvm->interpret(_compiler->_func) == ECode_Success) {
-      Value res = _gvm->result();
+    GVM* vm = gvm ? gvm : _gvm;
+    if (vm->interpret(_compiler->_func) == ECode_Success) {
+      Value res = vm->result();
     }
   }
   std::vector<std::string>::iterator aitr;
@@ -432,8 +1253,11 @@ bool GScanPlan::predictVertex(gkey_t key, nlohmann::json& row)
       aitr = _where._patterns[index]._nodes[0]->_attrs.begin();
     }
     auto& opPreds = _where._patterns[index]._node_predicates;
+    if (opPreds.empty()) continue;
+    // all of and predicates or any of or predicates
+    bool matched = (index == (long)LogicalPredicate::And);
     for (auto predItr = opPreds.begin(), end = opPreds.end(); predItr != end; ++predItr) {
-      result &= (*predItr).visit(
+      bool ret = (*predItr).visit(
         [&key](std::function<bool(const gkey_t&)> op) {
           return op(key);
         },
@@ -443,53 +1267,23 @@ bool GScanPlan::predictVertex(gkey_t key, nlohmann::json& row)
           ++aitr;
           return ret;
         });
-      if (index == 0 && !result) break;
-      if (index == 1 && result) break;
+      if (ret != matched) {
+        matched = ret;
+        break;
+      }
     }
+    result &= matched;
+    if (!result) break;
   }
   return result;
 }
 
 bool GScanPlan::predict(const std::function<bool(const attribute_t&)>& op, const nlohmann::json& attr) const
 {
-  bool ret = false;
-  switch ((nlohmann::json::value_t)attr) {
-  case nlohmann::json::value_t::number_float:
-  case nlohmann::json::value_t::number_integer:
-  case nlohmann::json::value_t::number_unsigned:
-    ret = op((double)attr);
-    break;
-  case nlohmann::json::value_t::string:
-    ret = op((std::string)attr);
-    break;
-  case nlohmann::json::value_t::object:
-    if (attr.count(OBJECT_TYPE_NAME)) {
-      switch (AttributeKind(attr[OBJECT_TYPE_NAME])) {
-      case AttributeKind::Datetime:
-      {
-        ret = op((double)attr["value"]);
-      }
-      break;
-      case AttributeKind::Vector:
-      {
-        std::vector<double> dv = attr["value"];
-        attribute_t a = dv;
-        ret = op(a);
-      }
-      break;
-      default:
-        break;
-      }
-    }
-    else {}
-    break;
-  default:
-    break;
-  }
-  return ret;
+  return GPredicateProgram::call(op, attr);
 }
 
-bool GScanPlan::predict(KeyType type, gkey_t key, nlohmann::json& row)
+bool GScanPlan::predict(KeyType type, gkey_t key, nlohmann::json& row, GVM* gvm)
 {
   switch (type)
   {
@@ -497,7 +1291,8 @@ bool GScanPlan::predict(KeyType type, gkey_t key, nlohmann::json& row)
     return predictEdge(key, row);
   }
   default:
-    return predictVertex(key, row);
+    if (_program.compiled()) return _program.match(type, key, row);
+    return predictVertex(key, row, gvm);
   }
   
 }
@@ -531,6 +1326,26 @@ bool GScanPlan::predictEdge(gkey_t key, nlohmann::json& row)
     uint64_t value = strtoull(node1.c_str(), nullptr, 10);
     return value == node2;
   };
+  // an endpoint with condition probes its hash join, and the joined vertex is kept with the endpoint's role
+  nlohmann::json joined;
+  auto match_endpoint = [&](EntityNode* node, uint8_t type, gkey_t& id, const char* role) -> bool {
+    if (!node) return true;
+    if (!node->_condition) {
+      return type ? match_node(node->_label, id.Get<std::string>()) : match_node_int(node->_label, id.Get<uint64_t>());
+    }
+    const GHashJoin* join = getJoin(node);
+    if (!join) return false;
+    std::string k;
+    if (type) k = id.Get<std::string>();
+    else {
+      uint64_t value = id.Get<uint64_t>();
+      k.assign((char*)&value, sizeof(uint64_t));
+    }
+    const nlohmann::json* vertex = join->probe(k);
+    if (!vertex) return false;
+    joined[role] = *vertex;
+    return true;
+  };
   gql::edge_id eid = gql::to_edge_id(key.Get<std::string>());
   gkey_t from, to;
   get_from_to(eid, from, to);
@@ -540,20 +1355,26 @@ bool GScanPlan::predictEdge(gkey_t key, nlohmann::json& row)
     for (auto itr = edges.begin(); itr != edges.end(); ++itr) {
       auto& edge = *itr;
       if (eid._direction == edge->_direction) {
-        auto& start = edge->_start->_label;
-        auto& end = edge->_end->_label;
-        bool from_result = eid._from_type ? match_node(start, from.Get<std::string>()) : match_node_int(start, from.Get<uint64_t>());
-        bool to_result = eid._to_type ? match_node(end, to.Get<std::string>()) : match_node_int(end, to.Get<uint64_t>());
+        bool from_result = match_endpoint(edge->_start, eid._from_type, from, "from");
+        bool to_result = match_endpoint(edge->_end, eid._to_type, to, "to");
 
         if (eid._direction == false) {
           // swap start and end
           if (!from_result || !to_result) {
-            from_result = eid._from_type ? match_node(end, from.Get<std::string>()) : match_node_int(end, from.Get<uint64_t>());
-            to_result = eid._to_type ? match_node(start, to.Get<std::string>()) : match_node_int(start, to.Get<uint64_t>());
+            joined.clear();
+            from_result = match_endpoint(edge->_end, eid._from_type, from, "to");
+            to_result = match_endpoint(edge->_start, eid._to_type, to, "from");
           }
         }
         release_edge_id(eid);
-        return from_result && to_result;
+        bool result = from_result && to_result;
+        if (result && joined.size()) {
+          if (!row.is_object()) row = nlohmann::json::object();
+          for (auto& item : joined.items()) {
+            row[item.key()] = item.value();
+          }
+        }
+        return result;
       }
     }
   }
@@ -561,6 +1382,49 @@ bool GScanPlan::predictEdge(gkey_t key, nlohmann::json& row)
   return false;
 }
 
+void GScanPlan::initJoins(GContext* context)
+{
+  std::string from, to;
+  // groups of endpoints are declared by edge group
+  bool related = _store->getRelation(_group, from, to);
+  for (int index = 0; index < (long)LogicalPredicate::Max; ++index) {
+    for (EntityEdge* edge : _where._patterns[index]._edges) {
+      EntityNode* nodes[2] = { edge->_start, edge->_end };
+      for (int side = 0; side < 2; ++side) {
+        EntityNode* node = nodes[side];
+        if (!node || !node->_condition || getJoin(node)) continue;
+        EdgeJoin join;
+        join._node = node;
+        // endpoint of an unknown group matches nothing
+        join._plan = related ? new GScanPlan(context, node->_condition, side == 0 ? from : to) : nullptr;
+        _joins.emplace_back(std::move(join));
+      }
+    }
+  }
+}
+
+void GScanPlan::buildJoins(GVM* gvm)
+{
+  for (auto& join : _joins) {
+    join._join.clear();
+    if (!join._plan) continue;
+    GHashJoin& hash = join._join;
+    join._plan->execute(gvm, [&hash](KeyType, const std::string& key, nlohmann::json& value, int status) {
+      if (status == ECode_Success) hash.build(key, value);
+      return ExecuteStatus::Continue;
+      });
+    hash.seal();
+  }
+}
+
+const GHashJoin* GScanPlan::getJoin(EntityNode* node) const
+{
+  for (auto& join : _joins) {
+    if (join._node == node) return join._plan ? &join._join : nullptr;
+  }
+  return nullptr;
+}
+
 GScanPlan::ScanPlans GScanPlan::evaluate(const ScanPlans& props)
 {
   ScanPlans indexes;
@@ -628,6 +1492,7 @@ VisitFlow GScanPlan::PatternVisitor::apply(GProperty* stmt, std::list<NodeType>&
       return input < attr;
       });
     _where._patterns[index]._node_predicates.push_back(pred);
+    _where._patterns[index]._node_conditions.push_back({ last_key, CompareOperator::LessThan, attr });
   }
   else if (key == "gt") {
     _attrs[index].push_back(last_key);
@@ -638,6 +1503,7 @@ VisitFlow GScanPlan::PatternVisitor::apply(GProperty* stmt, std::list<NodeType>&
       return input > attr;
       });
     _where._patterns[index]._node_predicates.push_back(pred);
+    _where._patterns[index]._node_conditions.push_back({ last_key, CompareOperator::GreatThan, attr });
   }
   else if (key == "lte") {
     _attrs[index].push_back(last_key);
@@ -651,6 +1517,7 @@ VisitFlow GScanPlan::PatternVisitor::apply(GProperty* stmt, std::list<NodeType>&
       return input <= attr;
       });
     _where._patterns[index]._node_predicates.push_back(pred);
+    _where._patterns[index]._node_conditions.push_back({ last_key, CompareOperator::LessEqual, attr });
   }
   else if (key == "gte") {
     _attrs[index].push_back(last_key);
@@ -662,6 +1529,7 @@ VisitFlow GScanPlan::PatternVisitor::apply(GProperty* stmt, std::list<NodeType>&
       return input >= attr;
       });
     _where._patterns[index]._node_predicates.push_back(pred);
+    _where._patterns[index]._node_conditions.push_back({ last_key, CompareOperator::GreatEqual, attr });
   }
   else if (key == "id") {
     std::string value = GetString(stmt->value());
@@ -675,6 +1543,7 @@ VisitFlow GScanPlan::PatternVisitor::apply(GProperty* stmt, std::list<NodeType>&
       return ret;
       });
     _where._patterns[index]._node_predicates.push_back(pred);
+    _where._patterns[index]._key_values.push_back(value);
   }
   else if (key == "and") {
     _isAnd = true;
@@ -731,6 +1600,7 @@ VisitFlow GScanPlan::PatternVisitor::apply(GProperty* stmt, std::list<NodeType>&
         });
       _where._patterns[index]._node_predicates.push_back(pred);
     }
+    _where._patterns[index]._node_conditions.push_back({ last_key, CompareOperator::Other, attr });
     
     _attrs[index].push_back(last_key);
   }
@@ -747,6 +1617,7 @@ VisitFlow GScanPlan::PatternVisitor::apply(GProperty* stmt, std::list<NodeType>&
             return true;
           });
           _where._patterns[index]._node_predicates.push_back(pred);
+          _where._patterns[index]._node_conditions.push_back({ last_key, CompareOperator::Other, attribute_t() });
           return;
         }
       }
@@ -759,6 +1630,7 @@ VisitFlow GScanPlan::PatternVisitor::apply(GProperty* stmt, std::list<NodeType>&
           return input == attr;
           });
         _where._patterns[index]._node_predicates.push_back(pred);
+        _where._patterns[index]._node_conditions.push_back({ last_key, CompareOperator::Equal, attr });
       }
     };
     if (value->_nodetype == NodeType::Literal) {
@@ -1,5 +1,8 @@
 #include "../include/gqlite.h"
 #include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <functional>
 #include "../tool/stdout.h"
 
 #define NORMAL "\033[m"
@@ -25,12 +28,13 @@ size_t current_count = 0;
 }
 
 #define TEST_BOOL(nogql, status)
-#define TEST_QUERY(nogql, count) \
+// count is summed by callback
+#define TEST_COUNT(nogql, callback, count) \
 {\
   ptr = nullptr;\
   printf(NORMAL"Test [%d]:\t%s\n", ++test_id, nogql);\
   current_count = 0;\
-  if (gqlite_exec(pHandle, nogql, gqlite_exec_assert_callback, nullptr, &ptr)) {\
+  if (gqlite_exec(pHandle, nogql, callback, nullptr, &ptr)) {\
     printf(RED"exec error: %s\n" NORMAL, ptr);\
   }\
   if (current_count != count) {\
@@ -38,6 +42,9 @@ size_t current_count = 0;
   }\
   if (ptr) gqlite_free(ptr);\
 }
+#define TEST_QUERY(nogql, count) TEST_COUNT(nogql, gqlite_exec_assert_callback, count)
+// count indexes whose postings are missing or stale
+#define TEST_VERIFY(cmd, broken) TEST_COUNT(cmd, gqlite_verify_callback, broken)
 
 int gqlite_exec_assert_callback(gqlite_result* params, void*)
 {
@@ -47,6 +54,69 @@ int gqlite_exec_assert_callback(gqlite_result* params, void*)
   return 0;
 }
 
+int gqlite_verify_callback(gqlite_result* params, void*)
+{
+  // row of a correct index is `group:attr: missing 0, stale 0`
+  for (size_t idx = 0; params && idx < params->count; ++idx) {
+    const char* counts = strstr(params->infos[idx], ": missing ");
+    if (counts && strcmp(counts, ": missing 0, stale 0") != 0) current_count += 1;
+  }
+  return 0;
+}
+
+/**
+ * make statement ready by `setup`, and count rows that are pulled before `pulls`.
+ * Statement is created by `gqlite_create` if `setup` is null.
+ */
+typedef std::function<int(gqlite*, const char*, gqlite_statement**)> statement_setup;
+void test_statement(gqlite* pHandle, const char* nogql, size_t expect, const statement_setup& setup = nullptr, size_t pulls = SIZE_MAX)
+{
+  printf(NORMAL"Test [%d]:\t%s\n", ++test_id, nogql);
+  gqlite_statement* stmt = nullptr;
+  size_t pulled = 0;
+  int ret = setup ? setup(pHandle, nogql, &stmt) : gqlite_create(pHandle, nogql, &stmt);
+  if (ret == ECode_Success && gqlite_execute(pHandle, stmt) == ECode_Success) {
+    gqlite_result* result = nullptr;
+    while (pulled < pulls && gqlite_next(pHandle, stmt, &result) == ECode_Success) {
+      // a page of columns has all rows of result, and a vertex refers to its properties
+      if (result->type == gqlite_result_type_column && result->columns->array->length != result->count) continue;
+      if (result->type == gqlite_result_type_node && result->nodes && result->nodes->_type == gqlite_node_type_vertex && result->nodes->_vertex->len == 0) continue;
+      pulled += result->count;
+    }
+  }
+  if (pulled != expect) {
+    printf(RED"expect result count: %zu, but pulled count: %zu\n" NORMAL, expect, pulled);
+  }
+  gqlite_finalize(pHandle, stmt);
+}
+
+/**
+ * `write` is rejected while a row of zero-copy statement is viewed, and it runs after statement is finalized.
+ */
+void test_zero_copy_write(gqlite* pHandle, const char* nogql, const char* write)
+{
+  printf(NORMAL"Test [%d]:\t%s\n", ++test_id, write);
+  gqlite_statement* stmt = nullptr;
+  gqlite_result* result = nullptr;
+  int ret = gqlite_create(pHandle, nogql, &stmt);
+  if (ret == ECode_Success) ret = gqlite_zero_copy(pHandle, stmt, true);
+  if (ret == ECode_Success) ret = gqlite_execute(pHandle, stmt);
+  if (ret == ECode_Success) ret = gqlite_next(pHandle, stmt, &result);
+  char* ptr = nullptr;
+  if (ret == ECode_Success) ret = gqlite_exec(pHandle, write, nullptr, nullptr, &ptr);
+  if (ptr) gqlite_free(ptr);
+  if (ret != ECode_TRANSTION_Busy) {
+    printf(RED"expect busy when rows are viewed, but return %d\n" NORMAL, ret);
+  }
+  gqlite_finalize(pHandle, stmt);
+  ptr = nullptr;
+  ret = gqlite_exec(pHandle, write, nullptr, nullptr, &ptr);
+  if (ptr) gqlite_free(ptr);
+  if (ret != ECode_Success) {
+    printf(RED"expect write after finalize, but return %d\n" NORMAL, ret);
+  }
+}
+
 void wrong_grammar_test(gqlite* pHandle, char* ptr) {
   TEST_GRAMMAR("{create: 'ga', noindex: 'keyword'};");
   TEST_GRAMMAR("{create: 'ga', index: b64'keyword'};");
@@ -122,11 +192,47 @@ void successful_test(gqlite* pHandle, char* ptr) {
   TEST_QUERY("{query: 'g', in: 'ga', where: {create_time: {$gt: 1, $lt: 5}}};", 1);
   TEST_QUERY("{query: 'g', in: 'ga', where: {create_time: {$gte: 1, $lt: 5}}};", 3);
   TEST_QUERY("{query: 'g', in: 'ga', where: {id: 'v1'}};", 0);
+  TEST_QUERY("{query: 'g', in: 'ga', limit: 2};", 2);
+  TEST_QUERY("{query: 'g', in: 'ga', limit: 2, skip: 5};", 1);
+  TEST_QUERY("{query: 'g', in: 'ga', limit: 0};", 0);
+  TEST_QUERY("{query: 'g', in: 'ga', order: {create_time: 'desc'}, limit: 0};", 0);
+  auto prepare = [](int64_t param) {
+    return [param](gqlite* db, const char* gql, gqlite_statement** stmt) {
+      int ret = gqlite_prepare(db, gql, stmt);
+      return ret == ECode_Success ? gqlite_bind_int(db, *stmt, 1, param) : ret;
+    };
+  };
+  auto zero_copy = [](gqlite* db, const char* gql, gqlite_statement** stmt) {
+    int ret = gqlite_create(db, gql, stmt);
+    return ret == ECode_Success ? gqlite_zero_copy(db, *stmt, true) : ret;
+  };
+  auto columnar = [](gqlite* db, const char* gql, gqlite_statement** stmt) {
+    int ret = gqlite_create(db, gql, stmt);
+    return ret == ECode_Success ? gqlite_columnar(db, *stmt, true) : ret;
+  };
+  test_statement(pHandle, "{query: 'g', in: 'ga'};", 6, nullptr, 10);
+  test_statement(pHandle, "{query: 'g', in: 'ga'};", 2, nullptr, 2);
+  test_statement(pHandle, "{query: 'g', in: 'ga', where: {create_time: {$lt: $1}}};", 3, prepare(5));
+  test_statement(pHandle, "{query: 'g', in: 'ga', where: {create_time: {$gt: $1}}};", 1, prepare(1));
+  test_statement(pHandle, "{query: 'g',  in: 'ga', where: {create_time: {$lt: $1}}};", 3, prepare(5));
+  test_statement(pHandle, "{query: 'g', in: 'ga'};", 6, zero_copy);
+  test_statement(pHandle, "{query: 'g', in: 'ga', where: {create_time: {$lt: 5}}};", 3, zero_copy);
+  test_zero_copy_write(pHandle, "{query: 'g', in: 'ga'};", "{upset: 'g', vertex: [[55, {update_time: 0d12345}]]};");
+  test_statement(pHandle, "{query: 'g', in: 'ga'};", 6, columnar);
+  test_statement(pHandle, "{query: 'g', in: 'ga', where: {create_time: {$lt: 5}}};", 3, columnar);
+  TEST_QUERY("{query: 'g', in: 'ga', where: {create_time: {$gte: 1, $lt: 5}}, skip: 1, limit: 5};", 2);
+  TEST_QUERY("{query: 'g', in: 'ga', order: {create_time: 'desc'}, limit: 2};", 2);
+  TEST_QUERY("{query: 'g', in: 'ga', where: {create_time: {$gte: 1, $lt: 5}}, order: 'create_time', skip: 2};", 1);
+  TEST_QUERY("{query: count(g), in: 'ga'};", 1);
+  TEST_QUERY("{query: [count(g), avg(g.create_time)], in: 'ga', where: {create_time: {$gte: 1, $lt: 5}}};", 1);
+  TEST_QUERY("{query: [count(g), max(g.create_time)], in: 'ga', by: 'class'};", 2);
+  TEST_QUERY("{query: [approx_count_distinct(g.keyword), approx_quantile(g.create_time, 0.5)], in: 'ga'};", 1);
   TEST_QUERY("{query: 'g', in: 'ga', where: {keyword: 'b'}};", 1);
   TEST_QUERY("{query: 'g', in: 'ga', where: {create_time: {$gt: 1}}};", 1);
   TEST_QUERY("{query: 'g', in: 'ga', where: {create_time: {$lt: 5}}};", 3);
   TEST_QUERY("{query: 'g', in: 'ga', where: {$and: [{create_time: {$lt: 5}}]}};", 3);
   TEST_QUERY("{query: 'g', in: 'ga', where: {$or: [{create_time: {$lt: 5}}]}};", 3);
+  TEST_QUERY("{query: 'g', in: 'ga', where: {$and: [{keyword: 'a'}, {create_time: {$gte: 2}}]}};", 1);
   TEST_GRAMMAR(
     "{"
       "query: 'g', in: 'ga',"
@@ -153,6 +259,27 @@ void successful_test(gqlite* pHandle, char* ptr) {
   TEST_GRAMMAR("{query: 'g', in: 'ga'};");
   TEST_GRAMMAR("{query: [g.class], in: 'ga', where: {keyword: 'b'}};");
   TEST_GRAMMAR("{query: [g.class], in: 'ga', where: {keyword: 'b'}};");
+  TEST_GRAMMAR("{create: 'ga', index: 'g.keyword', include: ['class']};");
+  TEST_QUERY("{query: [g.class], in: 'ga', where: {keyword: 'b'}};", 1);
+  TEST_QUERY("{query: [g.class], in: 'ga', where: {keyword: 'a'}};", 2);
+  TEST_GRAMMAR("{create: 'ga', index: 'g.create_time', include: ['class']};");
+  TEST_QUERY("{query: [g.class], in: 'ga', where: {create_time: {$gte: 1, $lt: 5}}};", 3);
+  TEST_QUERY("{query: [g.keyword], in: 'ga', where: {create_time: {$gte: 1, $lt: 5}}};", 3);
+  TEST_GRAMMAR("{upset: 'g', vertex: [[46, {keyword: ['b'], create_time: 2}]]};");
+  TEST_QUERY("{query: [g.class], in: 'ga', where: {keyword: 'a'}};", 1);
+  TEST_QUERY("{query: [g.class], in: 'ga', where: {keyword: 'b'}};", 2);
+  TEST_VERIFY("verify index 'g.keyword';", 0);
+  TEST_VERIFY("verify index;", 0);
+  TEST_GRAMMAR("{create: 'ga', index: 'g.ts', interval: 86400};");
+  TEST_GRAMMAR("{upset: 'g', vertex: [[70, {ts: 0d100}], [71, {ts: 0d86500}], [72, {ts: 0d172900}]]};");
+  TEST_QUERY("{query: 'g', in: 'ga', where: {ts: {$gte: 0d86400}}};", 2);
+  TEST_QUERY("{query: 'g', in: 'ga', where: {ts: {$gt: 0d50, $lt: 0d86600}}};", 2);
+  TEST_GRAMMAR("{expire: 'g', where: {ts: {$lt: 0d86600}}};");
+  TEST_QUERY("{query: 'g', in: 'ga', where: {ts: {$gte: 0}}};", 1);
+  TEST_VERIFY("verify index 'g.ts';", 0);
+  TEST_GRAMMAR("{upset: 'g', vertex: [[80, {by: 'x', skip: 1, interval: 2, include: 'y'}]]};");
+  TEST_QUERY("{query: 'g', in: 'ga', where: {by: 'x'}};", 1);
+  TEST_QUERY("{query: 'g', in: 'ga', where: {by: 'x', skip: 1}, skip: 0};", 1);
   TEST_GRAMMAR("{dump: 'ga'};");
   /*
   * EDGES & LINKS
@@ -203,6 +330,14 @@ void successful_test(gqlite* pHandle, char* ptr) {
   TEST_QUERY("{query: 'e', in: 'ga', where: ['v1', ->, *]};", 0);
   TEST_QUERY("{query: 'e', in: 'ga', where: {id: 'v1', ->: *, neighbor: 1}};", 0);
   TEST_QUERY("{query: 'e', in: 'ga', where: {id: 'v1', --: *, neighbor: 1}};", 1);
+  // endpoint with condition is joined with vertexes of the group that edge group declares
+  TEST_GRAMMAR("{create: 'ga', group: [{film: ['title', 'genres']}, ['viewer', 'review', 'film']]};");
+  TEST_GRAMMAR("{upset: 'film', vertex: [['f1', {title: 'Toy Story', genres: 'Comedy'}], ['f2', {title: 'Heat', genres: 'Action'}], ['f3', {title: 'Big', genres: 'Comedy'}]]};");
+  TEST_GRAMMAR("{upset: 'review', edge: [['u1', --, 'f1'], ['u2', --, 'f1'], ['u1', --, 'f2'], ['u3', --, 'f3']]};");
+  TEST_QUERY("{query: 'review', in: 'ga', where: [*, --, {genres: 'Comedy'}]};", 3);
+  TEST_QUERY("{query: 'review', in: 'ga', where: [*, --, {genres: 'Action'}]};", 1);
+  TEST_QUERY("{query: 'review', in: 'ga', where: ['u1', --, {genres: 'Comedy'}]};", 1);
+  TEST_QUERY("{query: 'review', in: 'ga', where: [*, --, {genres: 'Horror'}]};", 0);
   // TEST_GRAMMAR("{query: '*', path: ['b', 'e', ...], from: 'prefix_tree'}");
   /*
   * search item with distance
@@ -46,6 +46,82 @@ TEST_CASE("init movies") {
     gqlite_exec_callback, nullptr, &ptr);
   assert(gqlite_version(pHandle, &major, &minor, &patch) > 0);
   gqlite_free(ptr);
+  // movie is upserted by a prepared statement, so gql is parsed only once
+  gqlite_statement* upset_movie = nullptr;
+  assert(gqlite_prepare(pHandle, "{upset: 'movie', vertex: [[$1, {title: $2, genres: $3}]]};", &upset_movie) == ECode_Success);
+  readCSV("movies.csv", [&pHandle, upset_movie](char* buffer) {
+    char* movie_id = strtok(buffer, ",");
+    if (movie_id == nullptr) return;
+    int id = atoi(movie_id);
+    char* movie_title = strtok(nullptr, ",");
+    char* movie_genres = strtok(nullptr, ",");
+
+    gqlite_bind_int(pHandle, upset_movie, 1, id);
+    gqlite_bind_text(pHandle, upset_movie, 2, movie_title, -1);
+    gqlite_bind_text(pHandle, upset_movie, 3, movie_genres ? movie_genres : "", -1);
+    gqlite_execute(pHandle, upset_movie);
+    });
+  gqlite_finalize(pHandle, upset_movie);
+  int line_num = 1;
+  // tags are loaded without formatting and parsing gql
+  gqlite_bulk* bulk_tag = nullptr;
+  assert(gqlite_bulk_begin(pHandle, "tag", &bulk_tag) == ECode_Success);
+  readCSV("tags.csv", [&pHandle, bulk_tag, &line_num](char* buffer) {
+    char* user_id = strtok(buffer, ",");
+    if (user_id == nullptr) return;
+    gqlite_vertex user, movie;
+    user.type = gqlite_id_type::integer;
+    user.uid = atoi(user_id);
+    char* movie_id = strtok(nullptr, ",");
+    movie.type = gqlite_id_type::integer;
+    movie.uid = atoi(movie_id);
+    char* ctag = strtok(nullptr, ",");
+    std::string tag = replace_all(ctag);
+    gqlite_field field;
+    field.name = "tag";
+    field.type = gqlite_field_text;
+    field.text = tag.c_str();
+    field.len = tag.size();
+    gqlite_bulk_edge(pHandle, bulk_tag, &user, &movie, false, &field, 1);
+    line_num++;
+    });
+  gqlite_bulk_end(pHandle, bulk_tag);
+  gqlite_exec(pHandle,
+   "{query: 'movie', in: 'movielens_db'};",
+   gqlite_exec_callback, nullptr, &ptr);
+  gqlite_free(ptr);
+  gqlite_exec(pHandle,
+    "{query: 'tag', in: 'movielens_db'};",
+    gqlite_exec_callback, nullptr, &ptr);
+  gqlite_free(ptr);
+  // ratings are parsed in parallel and written in key order
+  std::string import_rate = "import '" _WORKING_DIR_ "/data/ml-latest-small/ratings.csv' into 'rate' ('from', 'to', 'rate', 'timestamp');";
+  assert(gqlite_exec(pHandle, import_rate.c_str(), gqlite_exec_callback, nullptr, &ptr) == ECode_Success);
+  gqlite_free(ptr);
+  gqlite_exec(pHandle, "{dump: 'movielens_db'};", gqlite_exec_callback, nullptr, &ptr);
+  gqlite_free(ptr);
+  gqlite_close(pHandle);
+}
+
+TEST_CASE("upset movies") {
+  gqlite* pHandle = 0;
+  assert(gqlite_open(&pHandle, nullptr) == ECode_Success);
+
+  char* ptr = nullptr;
+  gqlite_exec(pHandle,
+    "{drop: 'movielens_gql'};",
+    gqlite_exec_callback, nullptr, &ptr);
+  gqlite_free(ptr);
+  gqlite_exec(pHandle,
+    "{create: 'movielens_gql',"
+      "group: ["
+        "{movie: ['title', 'genres']},"
+        "{tag: ['user_id', 'tag', 'movie_id']}"
+      "]"
+    "};",
+    gqlite_exec_callback, nullptr, &ptr);
+  gqlite_free(ptr);
+  // movies and tags are written by gql which is formatted for every row
   readCSV("movies.csv", [&pHandle, &ptr](char* buffer) {
     char* movie_id = strtok(buffer, ",");
     if (movie_id == nullptr) return;
@@ -60,8 +136,7 @@ TEST_CASE("init movies") {
     gqlite_exec(pHandle, upset, gqlite_exec_callback, nullptr, &ptr);
     gqlite_free(ptr);
     });
-  int line_num = 1;
-  readCSV("tags.csv", [&pHandle, &ptr, &line_num](char* buffer) {
+  readCSV("tags.csv", [&pHandle, &ptr](char* buffer) {
     char* user_id = strtok(buffer, ",");
     if (user_id == nullptr) return;
     int uid = atoi(user_id);
@@ -73,19 +148,10 @@ TEST_CASE("init movies") {
     sprintf(upset, "{upset: 'tag', edge: [[%d, --: {tag: '%s'}, %d]]};", uid, tag.c_str(), mid);
     gqlite_exec(pHandle, upset, gqlite_exec_callback, nullptr, &ptr);
     gqlite_free(ptr);
-    line_num++;
     });
   gqlite_exec(pHandle,
-   "{query: 'movie', in: 'movielens_db'};",
-   gqlite_exec_callback, nullptr, &ptr);
-  gqlite_free(ptr);
-  gqlite_exec(pHandle,
-    "{query: 'tag', in: 'movielens_db'};",
+    "{query: 'tag', in: 'movielens_gql'};",
     gqlite_exec_callback, nullptr, &ptr);
   gqlite_free(ptr);
-  readCSV("ratings.csv", [&pHandle, &ptr, &line_num](char* buffer) {
-    });
-  gqlite_exec(pHandle, "{dump: 'movielens_db'};", gqlite_exec_callback, nullptr, &ptr);
-  gqlite_free(ptr);
   gqlite_close(pHandle);
 }
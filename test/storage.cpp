@@ -1,12 +1,28 @@
 #include "Graph/EntityEdge.h"
 #include "Graph/EntityNode.h"
 #include "StorageEngine.h"
+#include "IndexBuilder.h"
+#include "BulkLoader.h"
+#include "Snapshot.h"
+#include "Importer.h"
+#include "base/JsonView.h"
+#include "plan/query/PredicateProgram.h"
+#include "plan/query/TopK.h"
+#include "plan/query/Aggregator.h"
+#include "plan/query/Optimizer.h"
+#include "plan/query/HashJoin.h"
+#include "plan/Pipeline.h"
+#include "base/LRUCache.h"
+#include "base/Arena.h"
+#include "plan/query/ColumnBuilder.h"
+#include "Statement.h"
 #include "base/type.h"
 #include "gqlite.h"
 #include "gutil.h"
 #include <cassert>
 #include <catch.hpp>
 #include <fstream>
+#include <set>
 
 void readCSV(const std::string& name, std::function<void(char*)> cb, bool skip_head = true) {
   std::string csv = _WORKING_DIR_ "/data/ml-latest-small/" + name;
@@ -206,4 +222,838 @@ TEST_CASE("native_storage_api") {
   }
 
   
-}
\ No newline at end of file
+}
+TEST_CASE("covering index key") {
+  CHECK(GStorageEngine::encodeCovering(-2.5) < GStorageEngine::encodeCovering(-1.0));
+  CHECK(GStorageEngine::encodeCovering(-1.0) < GStorageEngine::encodeCovering(0.0));
+  CHECK(GStorageEngine::encodeCovering(0.0) < GStorageEngine::encodeCovering(3.0));
+  CHECK(GStorageEngine::encodeCovering(3.0) < GStorageEngine::encodeCovering(145377.0));
+  CHECK(gql::from_ordered_key(gql::to_ordered_key(-7.25).data()) == -7.25);
+  CHECK(GStorageEngine::encodeCovering(std::string("ab")) < GStorageEngine::encodeCovering(std::string("abc")));
+}
+
+TEST_CASE("online index build") {
+  GStorageEngine engine;
+  StoreOption opt;
+  opt.compress = 1;
+  opt.mode = ReadWriteOption::read_write;
+  CHECK(engine.open("storage.db", opt) == ECode_Success);
+  const std::string group("build_movie");
+  engine.addMap(group, KeyType::Integer);
+  for (uint64_t idx = 1; idx <= 10; ++idx) {
+    nlohmann::json row = { {"year", 2000 + idx % 2} };
+    engine.write(group, idx, row);
+  }
+  const std::string index = group + ":year";
+  engine.addIndex(index);
+  GIndexBuilder::start(&engine, index);
+  CHECK(!engine.isIndexReady(index));
+  GIndexBuilder builder(&engine, index);
+  CHECK(!builder.step(4));
+  // row written when building is recorded in side log
+  GIndexWriter writer(&engine, group);
+  nlohmann::json row = { {"year", 2001} };
+  engine.write(group, (uint64_t)2, row);
+  writer.upset((uint64_t)2, row);
+  while (!builder.step(4));
+  CHECK(engine.isIndexReady(index));
+  double year = 2001;
+  std::string posting;
+  CHECK(engine.read(index, gql::to_ordered_key(year), posting) == ECode_Success);
+  CHECK(posting.size() == 6 * sizeof(uint64_t));
+}
+
+TEST_CASE("verify index") {
+  GStorageEngine engine;
+  StoreOption opt;
+  opt.compress = 1;
+  opt.mode = ReadWriteOption::read_write;
+  CHECK(engine.open("storage.db", opt) == ECode_Success);
+  const std::string group("verify_movie");
+  const std::string index = group + ":year";
+  engine.addMap(group, KeyType::Integer);
+  engine.addIndex(index);
+  GIndexWriter writer(&engine, group);
+  for (uint64_t idx = 1; idx <= 4; ++idx) {
+    nlohmann::json row = { {"year", 2000 + idx % 2} };
+    engine.write(group, idx, row);
+    writer.upset(idx, row);
+  }
+  size_t missing = 0, stale = 0;
+  CHECK(writer.verify(index, missing, stale) == ECode_Success);
+  CHECK(missing == 0);
+  CHECK(stale == 0);
+  // posting of 2001 is lost, so its rows are missing
+  double year = 2001;
+  CHECK(engine.del(index, gql::to_ordered_key(year)) == ECode_Success);
+  CHECK(writer.verify(index, missing, stale) == ECode_Success);
+  CHECK(missing == 2);
+  CHECK(stale == 0);
+  // row is changed without index, so its old posting is stale
+  nlohmann::json row = { {"year", 1999} };
+  engine.write(group, (uint64_t)2, row);
+  CHECK(writer.verify(index, missing, stale) == ECode_Success);
+  CHECK(missing == 3);
+  CHECK(stale == 1);
+}
+
+TEST_CASE("membership filter") {
+  GBloomFilter filter(1000);
+  for (uint64_t idx = 0; idx < 1000; ++idx) {
+    filter.add(&idx, sizeof(uint64_t));
+  }
+  size_t positive = 0;
+  for (uint64_t idx = 0; idx < 2000; ++idx) {
+    bool exist = filter.mayContain(&idx, sizeof(uint64_t));
+    if (idx < 1000) CHECK(exist);
+    else if (exist) ++positive;
+  }
+  CHECK(positive < 50);
+  GBloomFilter loaded;
+  CHECK(loaded.deserialize(filter.serialize()));
+  uint64_t key = 7;
+  CHECK(loaded.mayContain(&key, sizeof(uint64_t)));
+
+  GStorageEngine engine;
+  StoreOption opt;
+  opt.compress = 1;
+  opt.mode = ReadWriteOption::read_write;
+  CHECK(engine.open("storage.db", opt) == ECode_Success);
+  const std::string group("filter_edge");
+  engine.addMap(group, KeyType::Uninitialize);
+  engine.tryInitKeyType(group, KeyType::Edge);
+  CHECK(engine.isFilterEnable(group));
+  std::string value("{}");
+  CHECK(engine.write(group, "1-2", (void*)value.data(), value.size()) == ECode_Success);
+  engine.close();
+  // filter is loaded from schema after reopen
+  CHECK(engine.open("storage.db", opt) == ECode_Success);
+  std::string result;
+  CHECK(engine.read(group, "1-2", result) == ECode_Success);
+  CHECK(engine.read(group, "2-3", result) == ECode_DATUM_Not_Exist);
+  // filter is saved only when graph is closed
+  CHECK(engine.write(group, "2-3", (void*)value.data(), value.size()) == ECode_Success);
+  CHECK(engine.commitTrans() == ECode_Success);
+  CHECK(engine.read(group, "2-3", result) == ECode_Success);
+  engine.close();
+  CHECK(engine.open("storage.db", opt) == ECode_Success);
+  CHECK(engine.read(group, "1-2", result) == ECode_Success);
+  CHECK(engine.read(group, "2-3", result) == ECode_Success);
+}
+
+TEST_CASE("bucket index") {
+  GStorageEngine engine;
+  StoreOption opt;
+  opt.compress = 1;
+  opt.mode = ReadWriteOption::read_write;
+  CHECK(engine.open("storage.db", opt) == ECode_Success);
+  const std::string group("bucket_event");
+  const std::string index = group + ":ts";
+  engine.addMap(group, KeyType::Integer);
+  engine.setBucketInterval(index, 100);
+  engine.addIndex(index);
+  GIndexWriter writer(&engine, group);
+  for (uint64_t idx = 1; idx <= 5; ++idx) {
+    nlohmann::json row = { {"ts", idx * 60} };
+    engine.write(group, idx, row);
+    writer.upset((uint64_t)idx, row);
+  }
+  uint64_t bucket = 0;
+  GStorageEngine::BucketEntry entry;
+  auto first = [&]() {
+    auto cursor = engine.getBucketCursor(index);
+    auto data = cursor.to_first(false);
+    return data && GStorageEngine::parseBucket(data.key, bucket, entry);
+  };
+  CHECK(first());
+  CHECK(bucket == 0);
+  CHECK(entry._time == 60);
+  CHECK(*(uint64_t*)entry._key.data() == 1);
+  nlohmann::json old = { {"ts", 60} };
+  nlohmann::json row = { {"ts", 360} };
+  engine.write(group, (uint64_t)1, row);
+  writer.update((uint64_t)1, old, row);
+  CHECK(first());
+  CHECK(bucket == 100);
+  CHECK(entry._time == 120);
+  size_t missing = 0, stale = 0;
+  writer.verify(index, missing, stale);
+  CHECK(missing == 0);
+  CHECK(stale == 0);
+  // entries before 240 are deleted as a range
+  std::vector<std::string> keys;
+  CHECK(engine.expireBucket(index, 240, keys) == ECode_Success);
+  CHECK(keys.size() == 2);
+  CHECK(first());
+  CHECK(entry._time == 240);
+}
+
+TEST_CASE("snapshot cursor") {
+  GStorageEngine engine;
+  StoreOption opt;
+  opt.compress = 1;
+  opt.mode = ReadWriteOption::read_write;
+  CHECK(engine.open("storage.db", opt) == ECode_Success);
+  const std::string group("snapshot_vertex");
+  engine.addMap(group, KeyType::Integer);
+  for (uint64_t idx = 1; idx <= 10; ++idx) {
+    nlohmann::json row = { {"id", idx} };
+    engine.write(group, idx, row);
+  }
+  CHECK(engine.commitTrans() == ECode_Success);
+  CHECK(!engine.isTransDirty());
+  nlohmann::json row = { {"id", 11} };
+  engine.write(group, (uint64_t)11, row);
+  CHECK(engine.isTransDirty());
+  // uncommitted row of session is not in snapshot of another thread
+  size_t count = 0;
+  std::thread worker([&]() {
+    mdbx::txn_managed txn = engine.startSnapshot();
+    GStorageEngine::cursor cursor = GStorageEngine::getSnapshotCursor(txn, group);
+    for (auto data = cursor.to_first(false); data; data = cursor.to_next(false)) {
+      ++count;
+    }
+  });
+  worker.join();
+  CHECK(count == 10);
+}
+
+TEST_CASE("json view") {
+  std::string row = R"({"title": "a \"b\", {c}", "genres": ["x", {"y": [1]}], "time": {"__type": 1, "value": 3}, "rate": 4.5})";
+  GJsonView view(row.data(), row.size());
+  CHECK(view.valid());
+  CHECK(view.size() == 4);
+  nlohmann::json value;
+  CHECK(view.get("title", value));
+  CHECK(value == "a \"b\", {c}");
+  CHECK(view.get("genres", value));
+  CHECK(value.size() == 2);
+  CHECK(view.get("rate", value));
+  CHECK(value == 4.5);
+  CHECK(!view.has("id"));
+  std::string arr("[1, 2]");
+  CHECK(!GJsonView(arr.data(), arr.size()).valid());
+}
+
+TEST_CASE("predicate program") {
+  QueryCondition where;
+  auto& andPattern = where._patterns[(long)LogicalPredicate::And];
+  attribute_t year;
+  year = 2000.0;
+  andPattern._node_predicates.push_back(static_cast<std::function<bool(const attribute_t&)>>(
+    [year](const attribute_t& input) { return input >= year; }));
+  andPattern._node_conditions.push_back({ "year", CompareOperator::GreatEqual, year });
+  auto& orPattern = where._patterns[(long)LogicalPredicate::Or];
+  for (auto& value : { std::string("a"), std::string("b") }) {
+    attribute_t attr;
+    attr = value;
+    orPattern._node_predicates.push_back(static_cast<std::function<bool(const attribute_t&)>>(
+      [attr](const attribute_t& input) { return input == attr; }));
+    orPattern._node_conditions.push_back({ "title", CompareOperator::Equal, attr });
+  }
+  GPredicateProgram program;
+  CHECK(program.compile(where));
+  std::vector<gkey_t> keys(4);
+  for (uint64_t idx = 0; idx < keys.size(); ++idx) keys[idx] = idx;
+  std::vector<nlohmann::json> rows = {
+    { {"year", 2001}, {"title", "b"} },
+    { {"year", 1999}, {"title", "a"} },
+    { {"year", 2000}, {"title", "c"} },
+    { {"year", "2005"}, {"title", "a"} },
+  };
+  CHECK(program.match(KeyType::Integer, keys[0], rows[0]));
+  CHECK(!program.match(KeyType::Integer, keys[3], rows[3]));
+  std::vector<uint32_t> selection;
+  program.select(KeyType::Integer, keys, rows, selection);
+  CHECK(selection.size() == 1);
+  CHECK(selection[0] == 0);
+}
+
+TEST_CASE("top k") {
+  GTopK heap("rating", true, 3);
+  for (int idx = 0; idx < 10; ++idx) {
+    nlohmann::json row = { {"rating", (idx * 7) % 10} };
+    heap.push(KeyType::Integer, std::to_string(idx), row);
+  }
+  nlohmann::json missing = { {"title", "a"} };
+  heap.push(KeyType::Integer, "missing", missing);
+  CHECK(heap.size() == 3);
+  GTopK worker("rating", true, 3);
+  nlohmann::json best = { {"rating", 100} };
+  worker.push(KeyType::Integer, "best", best);
+  heap.merge(worker);
+  auto rows = heap.sorted();
+  CHECK(rows.size() == 3);
+  CHECK(rows[0]._key == "best");
+  CHECK(rows[1]._value["rating"] == 9);
+  CHECK(rows[2]._value["rating"] == 8);
+}
+TEST_CASE("aggregator") {
+  std::vector<AggregateSpec> specs = { {AggregateKind::Count, ""}, {AggregateKind::Avg, "rating"}, {AggregateKind::Max, "rating"} };
+  GAggregator total(specs, "genre");
+  GAggregator worker(specs, "genre");
+  total.add({ {"genre", "Horror"}, {"rating", 2} });
+  total.add({ {"genre", "Comedy"}, {"rating", 4} });
+  worker.add({ {"genre", "Horror"}, {"rating", 4} });
+  worker.add({ {"genre", "Horror"} });
+  total.merge(worker);
+  auto rows = total.result();
+  CHECK(rows.size() == 2);
+  for (auto& row : rows) {
+    if (row["genre"] == "Horror") {
+      CHECK(row["count(*)"] == 3);
+      CHECK(row["avg(rating)"] == 3.0);
+      CHECK(row["max(rating)"] == 4.0);
+    }
+  }
+  GAggregator counter({ {AggregateKind::Count, ""} }, "");
+  counter.addCount(0, 10);
+  CHECK(counter.result()[0]["count(*)"] == 10);
+}
+
+TEST_CASE("approximate aggregates") {
+  GHyperLogLog distinct;
+  GHyperLogLog part;
+  for (int idx = 0; idx < 20000; ++idx) {
+    std::string key = std::to_string(idx % 5000);
+    if (idx % 2) distinct.add(key);
+    else part.add(key);
+  }
+  distinct.merge(part);
+  CHECK(distinct.estimate() > 4800);
+  CHECK(distinct.estimate() < 5200);
+  GQuantileSketch sketch;
+  GQuantileSketch worker;
+  for (int idx = 0; idx < 10000; ++idx) {
+    if (idx % 2) sketch.add(idx);
+    else worker.add(idx);
+  }
+  sketch.merge(worker);
+  CHECK(sketch.count() == 10000);
+  CHECK(sketch.quantile(0.5) > 4800);
+  CHECK(sketch.quantile(0.5) < 5200);
+  AggregateSpec median{ AggregateKind::ApproxQuantile, "rating", 0.5 };
+  GAggregator aggregator({ {AggregateKind::ApproxCountDistinct, "tag"}, median }, "");
+  aggregator.add({ {"tag", nlohmann::json::array({"a", "b"})}, {"rating", 1} });
+  aggregator.add({ {"tag", "a"}, {"rating", 3} });
+  aggregator.add({ {"tag", "c"}, {"rating", 5} });
+  auto row = aggregator.result()[0];
+  CHECK(row["approx_count_distinct(tag)"] == 3);
+  CHECK(row[median.name()] == 3.0);
+}
+
+TEST_CASE("partial index") {
+  GStorageEngine engine;
+  StoreOption opt;
+  opt.compress = 1;
+  opt.mode = ReadWriteOption::read_write;
+  CHECK(engine.open("storage.db", opt) == ECode_Success);
+  const std::string group("partial_movie");
+  const std::string index = group + ":tag";
+  engine.addMap(group, KeyType::Integer);
+  engine.addIndex(index);
+  GIndexWriter writer(&engine, group);
+  writer.upset((uint64_t)1, { {"tag", nlohmann::json::array({"a", "b"})} });
+  writer.upset((uint64_t)2, { {"tag", "c"} });
+  CHECK(!engine.isIndexPartial(index));
+  // numbers in array are not indexed, so count of index is not count of distinct values
+  writer.upset((uint64_t)3, { {"tag", nlohmann::json::array({"d", 1})} });
+  CHECK(engine.isIndexPartial(index));
+}
+
+TEST_CASE("optimizer") {
+  GStorageEngine engine;
+  StoreOption opt;
+  opt.compress = 1;
+  opt.mode = ReadWriteOption::read_write;
+  CHECK(engine.open("storage.db", opt) == ECode_Success);
+  const std::string group("optimize_movie");
+  engine.addMap(group, KeyType::Integer);
+  engine.addIndex(group + ":year");
+  GIndexWriter writer(&engine, group);
+  for (uint64_t idx = 1; idx <= 1000; ++idx) {
+    nlohmann::json row = { {"year", 1900 + idx % 100} };
+    engine.write(group, idx, row);
+    writer.upset(idx, row);
+  }
+  GOptimizer optimizer(&engine, group);
+  std::vector<AttributeCondition> equal = { {"year", CompareOperator::Equal, attribute_t(1950.0)} };
+  AccessPath path = optimizer.choose(equal, "", "");
+  CHECK(path._kind == AccessKind::Index);
+  CHECK(path._rows < 100);
+  std::vector<AttributeCondition> wide = { {"year", CompareOperator::GreatEqual, attribute_t(1900.0)} };
+  CHECK(optimizer.choose(wide, "", "")._kind == AccessKind::Scan);
+  std::vector<AttributeCondition> noindex = { {"title", CompareOperator::Equal, attribute_t(std::string("a"))} };
+  CHECK(optimizer.choose(noindex, "", "")._kind == AccessKind::Scan);
+}
+
+TEST_CASE("upgrade index") {
+  StoreOption opt;
+  opt.compress = 1;
+  opt.mode = ReadWriteOption::read_write;
+  const std::string group("upgrade_movie");
+  const std::string index = group + ":year";
+  {
+    GStorageEngine engine;
+    CHECK(engine.open("upgrade.db", opt) == ECode_Success);
+    engine.addMap(group, KeyType::Integer);
+    engine.addIndex(index);
+    GIndexWriter writer(&engine, group);
+    for (uint64_t idx = 1; idx <= 4; ++idx) {
+      nlohmann::json row = { {"year", 2000 + idx % 2} };
+      engine.write(group, idx, row);
+      writer.upset(idx, row);
+    }
+    // graph is written before index layout has a version
+    engine.getSchema()[SCHEMA_GLOBAL].erase(GLOBAL_INDEX_VERSION);
+    engine.close();
+  }
+  GStorageEngine engine;
+  CHECK(engine.open("upgrade.db", opt) == ECode_Success);
+  CHECK(engine.getSchema()[SCHEMA_GLOBAL][GLOBAL_INDEX_VERSION] == INDEX_FORMAT_VERSION);
+  CHECK(!engine.isIndexReady(index));
+  GIndexBuilder builder(&engine, index);
+  while (!builder.step(2));
+  size_t missing = 0, stale = 0;
+  GIndexWriter writer(&engine, group);
+  CHECK(writer.verify(index, missing, stale) == ECode_Success);
+  CHECK(missing == 0);
+  CHECK(stale == 0);
+}
+
+TEST_CASE("number index range") {
+  GStorageEngine engine;
+  StoreOption opt;
+  opt.compress = 1;
+  opt.mode = ReadWriteOption::read_write;
+  CHECK(engine.open("storage.db", opt) == ECode_Success);
+  const std::string group("range_movie");
+  const std::string index = group + ":rating";
+  engine.addMap(group, KeyType::Integer);
+  engine.addIndex(index);
+  GIndexWriter writer(&engine, group);
+  std::vector<double> ratings = { 3, 1.5, -1, 2, 1 };
+  for (uint64_t idx = 0; idx < ratings.size(); ++idx) {
+    nlohmann::json row = { {"rating", ratings[idx]} };
+    engine.write(group, idx + 1, row);
+    writer.upset(idx + 1, row);
+  }
+  auto postings = [&](double from, double to) {
+    std::vector<AttributeCondition> conditions = {
+      {"rating", CompareOperator::GreatEqual, attribute_t(from)},
+      {"rating", CompareOperator::LessEqual, attribute_t(to)}
+    };
+    std::string lower, upper;
+    std::set<uint64_t> keys;
+    if (!GOptimizer::range(IndexType::Number, "rating", conditions, lower, upper)) return keys;
+    auto cursor = engine.getIndexCursor(index);
+    auto data = cursor.move(mdbx::cursor::key_lowerbound, mdbx::slice(lower.data(), lower.size()), false);
+    while (data) {
+      std::string value((char*)data.key.byte_ptr(), data.key.size());
+      if (value > upper) break;
+      keys.insert(*(uint64_t*)data.value.byte_ptr());
+      data = cursor.to_next(false);
+    }
+    return keys;
+  };
+  CHECK(postings(1, 3) == std::set<uint64_t>({ 1, 2, 4, 5 }));
+  CHECK(postings(1.5, 2) == std::set<uint64_t>({ 2, 4 }));
+  CHECK(postings(-5, 1) == std::set<uint64_t>({ 3, 5 }));
+  CHECK(postings(2.5, 2.8).empty());
+  GOptimizer optimizer(&engine, group);
+  std::vector<AttributeCondition> narrow = {
+    {"rating", CompareOperator::GreatEqual, attribute_t(1.0)},
+    {"rating", CompareOperator::LessEqual, attribute_t(1.5)}
+  };
+  AccessPath path = optimizer.choose(narrow, "", "");
+  CHECK(path._rows > 0);
+  CHECK(path._rows <= ratings.size());
+}
+
+TEST_CASE("hash join") {
+  GHashJoin join;
+  for (uint64_t idx = 1; idx <= 100; ++idx) {
+    nlohmann::json row = { {"id", idx} };
+    join.build(std::string((char*)&idx, sizeof(uint64_t)), row);
+  }
+  join.seal();
+  CHECK(join.size() == 100);
+  uint64_t hit = 42, miss = 420;
+  const nlohmann::json* row = join.probe(std::string((char*)&hit, sizeof(uint64_t)));
+  REQUIRE(row != nullptr);
+  CHECK((*row)["id"] == 42);
+  CHECK(!join.contains(std::string((char*)&miss, sizeof(uint64_t))));
+  join.clear();
+  CHECK(!join.contains(std::string((char*)&hit, sizeof(uint64_t))));
+}
+
+TEST_CASE("pipeline") {
+  GPipeline pipeline(16);
+  pipeline.source([](const GPipeline::Emit& emit) {
+    for (uint64_t idx = 0; idx < 10000; ++idx) {
+      if (!emit({ KeyType::Integer, std::string((char*)&idx, sizeof(uint64_t)), idx, std::string(), ECode_Success })) break;
+    }
+    });
+  pipeline.then([](PipelineRow& row) {
+    // drop odd rows
+    if (row._value.get<uint64_t>() % 2) return false;
+    row._text = row._value.dump();
+    return true;
+    });
+  size_t count = 0;
+  pipeline.run([&count](PipelineRow& row) {
+    CHECK(row._text == std::to_string(count * 2));
+    ++count;
+    return true;
+    });
+  CHECK(count == 5000);
+  // sink stops pipeline, and source that is blocked by full queue returns
+  count = 0;
+  pipeline.run([&count](PipelineRow& row) {
+    return ++count < 10;
+    });
+  CHECK(count == 10);
+}
+
+TEST_CASE("statement cache") {
+  CHECK(GStatement::normalize(" {query: 'g',\n  in: 'a  b'}; ") == "{query: 'g', in: 'a  b'};");
+  GLRUCache<std::string, int> cache(2);
+  std::vector<int> evicted;
+  cache.put("a", 1, evicted);
+  cache.put("b", 2, evicted);
+  cache.put("c", 3, evicted);
+  REQUIRE(evicted.size() == 1);
+  CHECK(evicted[0] == 1);
+  int value = 0;
+  CHECK(!cache.take("a", value));
+  CHECK(cache.take("b", value));
+  CHECK(value == 2);
+  // a taken item is not in cache until it is put back
+  CHECK(!cache.take("b", value));
+  cache.put("c", 4, evicted);
+  CHECK(evicted.back() == 4);
+  CHECK(cache.size() == 1);
+  CHECK(cache.clear().size() == 1);
+}
+
+TEST_CASE("arena") {
+  GArena arena(1024);
+  uint64_t* numbers = arena.allocate<uint64_t>(16);
+  CHECK((uintptr_t)numbers % alignof(uint64_t) == 0);
+  char* text = arena.copy("vertex", 6);
+  CHECK(std::string(text) == "vertex");
+  // a large object is allocated in its own block, which is freed by reset
+  arena.allocate(4096);
+  CHECK(arena.capacity() >= 1024 + 4096);
+  arena.reset();
+  CHECK(arena.capacity() == 1024);
+  CHECK(arena.allocate<uint64_t>(16) == numbers);
+}
+
+TEST_CASE("column builder") {
+  GColumnBuilder builder;
+  builder.add(KeyType::Byte, "v1", nlohmann::json::parse(R"({"age": 18, "score": 1.5, "vec": [1, 2]})"));
+  builder.add(KeyType::Byte, "v2", nlohmann::json::parse(R"({"age": 2.5, "name": "tom", "score": "high"})"));
+  CHECK(builder.size() == 2);
+  CHECK(!builder.accept(KeyType::Edge));
+  struct ArrowSchema schema;
+  struct ArrowArray array;
+  gqlite_columns page{ &schema, &array };
+  gqlite_columns* columns = &page;
+  builder.build(columns->schema, columns->array);
+  REQUIRE(columns->array->length == 2);
+  REQUIRE(columns->schema->n_children == 5);
+  CHECK(std::string(columns->schema->format) == "+s");
+  std::map<std::string, std::pair<ArrowSchema*, ArrowArray*>> children;
+  for (int64_t idx = 0; idx < columns->schema->n_children; ++idx) {
+    children[columns->schema->children[idx]->name] = { columns->schema->children[idx], columns->array->children[idx] };
+  }
+  CHECK(std::string(children["id"].first->format) == "u");
+  // integer is promoted to double
+  auto age = children["age"];
+  CHECK(std::string(age.first->format) == "g");
+  CHECK(((const double*)age.second->buffers[1])[1] == 2.5);
+  // value that doesn't fit is changed to text
+  auto score = children["score"];
+  CHECK(std::string(score.first->format) == "u");
+  const int32_t* offsets = (const int32_t*)score.second->buffers[1];
+  CHECK(std::string((const char*)score.second->buffers[2] + offsets[1], offsets[2] - offsets[1]) == "high");
+  auto vec = children["vec"];
+  CHECK(std::string(vec.first->format) == "+w:2");
+  CHECK(vec.second->null_count == 1);
+  CHECK((((const uint8_t*)vec.second->buffers[0])[0] & 0x3) == 0x1);
+  CHECK(children["name"].second->null_count == 1);
+  // a moved child is valid after page is released
+  struct ArrowArray moved = *age.second;
+  age.second->release = nullptr;
+  columns->array->release(columns->array);
+  columns->schema->release(columns->schema);
+  CHECK(columns->array->release == nullptr);
+  CHECK(((const double*)moved.buffers[1])[1] == 2.5);
+  moved.release(&moved);
+  CHECK(moved.release == nullptr);
+  builder.clear();
+  CHECK(builder.accept(KeyType::Edge));
+}
+
+TEST_CASE("bulk loader") {
+  GStorageEngine engine;
+  StoreOption opt;
+  opt.compress = 1;
+  opt.mode = ReadWriteOption::read_write;
+  CHECK(engine.open("storage.db", opt) == ECode_Success);
+  const std::string group("bulk_movie");
+  const std::string index = group + ":year";
+  engine.addMap(group, KeyType::Integer);
+  engine.addIndex(index);
+  GIndexWriter writer(&engine, group);
+  nlohmann::json old = { {"year", 1999} };
+  engine.write(group, (uint64_t)1, old);
+  writer.upset((uint64_t)1, old);
+
+  GBulkLoader loader(&engine, group);
+  CHECK(loader.addVertex((uint64_t)1, old) == ECode_Fail);
+  CHECK(loader.begin() == ECode_Success);
+  CHECK(!engine.isIndexReady(index));
+  gqlite_field field;
+  field.name = "year";
+  field.type = gqlite_field_int;
+  for (uint64_t idx = 1; idx <= 10; ++idx) {
+    field.integer = 2000 + idx % 2;
+    CHECK(loader.addVertex(idx, GBulkLoader::toRow(&field, 1)) == ECode_Success);
+  }
+  CHECK(loader.addVertex(std::string("11"), nlohmann::json()) == ECode_GQL_Type_Not_Match);
+  CHECK(loader.addEdge((uint64_t)1, (uint64_t)2, true, nlohmann::json()) == ECode_GQL_Type_Not_Match);
+  CHECK(loader.end() == ECode_Success);
+  CHECK(engine.isIndexReady(index));
+  double year = 2001;
+  std::string posting;
+  CHECK(engine.read(index, gql::to_ordered_key(year), posting) == ECode_Success);
+  CHECK(posting.size() == 5 * sizeof(uint64_t));
+  // posting of overwritten row is removed
+  year = 1999;
+  posting.clear();
+  engine.read(index, gql::to_ordered_key(year), posting);
+  CHECK(posting.empty());
+}
+
+TEST_CASE("importer") {
+  GStorageEngine engine;
+  StoreOption opt;
+  opt.compress = 1;
+  opt.mode = ReadWriteOption::read_write;
+  CHECK(engine.open("storage.db", opt) == ECode_Success);
+  auto save = [](const std::string& path, const std::string& text) {
+    std::ofstream fs(path, std::ios::binary);
+    fs << text;
+  };
+  auto row = [&engine](const std::string& group, const gkey_t& key) {
+    std::string value;
+    int ret = key.visit(
+      [&](std::string k) { return engine.read(group, k, value); },
+      [&](uint64_t k) { return engine.read(group, k, value); });
+    return ret == ECode_Success ? nlohmann::json::parse(value) : nlohmann::json();
+  };
+  // columns are named by header, and `""` in a quoted value is a quote
+  save("import_movie.csv",
+    "id,title,genres\n"
+    "1,Toy Story,Comedy\n"
+    "2,\"Jumanji, \"\"The\"\" Game\",Fantasy\n"
+    "abc,Broken,Drama\n"
+    "\n"
+    "3,Heat,Action\r\n");
+  engine.addMap("import_movie", KeyType::Uninitialize);
+  GImporter movies(&engine, "import_movie");
+  CHECK(movies.load("import_movie.csv") == ECode_Success);
+  CHECK(movies.rows() == 3);
+  // id of an integer group must be digits
+  CHECK(movies.skipped() == 1);
+  CHECK(engine.getKeyType("import_movie") == KeyType::Integer);
+  CHECK(row("import_movie", (uint64_t)2)["title"] == "Jumanji, \"The\" Game");
+  CHECK(row("import_movie", (uint64_t)3)["genres"] == "Action");
+
+  // columns are named by mapping, and `''` skips a column
+  save("import_rating.csv", "10,ignored,4.5\n11,ignored,3\n");
+  engine.addMap("import_rating", KeyType::Uninitialize);
+  GImporter ratings(&engine, "import_rating", { "id", "", "rating" });
+  CHECK(ratings.load("import_rating.csv") == ECode_Success);
+  CHECK(ratings.rows() == 2);
+  nlohmann::json rating = row("import_rating", (uint64_t)10);
+  CHECK(rating.size() == 1);
+  CHECK(rating["rating"] == 4.5);
+  CHECK(row("import_rating", (uint64_t)11)["rating"] == 3);
+
+  // first column is id if no column is named as id
+  save("import_tag.csv", "tagId,tag\n5,funny\n");
+  engine.addMap("import_tag", KeyType::Uninitialize);
+  GImporter tags(&engine, "import_tag");
+  CHECK(tags.load("import_tag.csv") == ECode_Success);
+  nlohmann::json tag = row("import_tag", (uint64_t)5);
+  CHECK(tag["tag"] == "funny");
+  CHECK(tag.count("tagId") == 0);
+
+  // every line is a chunk, and the last row of a key is kept
+  save("import_user.csv", "1,first\n2,second\n1,last\n");
+  engine.addMap("import_user", KeyType::Uninitialize);
+  GImporter users(&engine, "import_user", { "id", "name" });
+  users.setChunkSize(1);
+  CHECK(users.load("import_user.csv") == ECode_Success);
+  CHECK(row("import_user", (uint64_t)1)["name"] == "last");
+  CHECK(row("import_user", (uint64_t)2)["name"] == "second");
+  CHECK(engine.count("import_user") == 2);
+
+  // statements of other groups are skipped
+  save("import_player.ngql",
+    "insert vertex player(name, age) values \"player100\":(\"Tim Duncan\", 42);\n"
+    "insert vertex team(name) values \"team204\":(\"Spurs\");\n"
+    "insert vertex player(name, age) values \"player101\":(\"Tony Parker\", 36);\n");
+  engine.addMap("player", KeyType::Uninitialize);
+  GImporter players(&engine, "player");
+  CHECK(players.load("import_player.ngql") == ECode_Success);
+  CHECK(players.rows() == 2);
+  CHECK(engine.getKeyType("player") == KeyType::Byte);
+  nlohmann::json player = row("player", std::string("player100"));
+  CHECK(player["name"] == "Tim Duncan");
+  CHECK(player["age"] == 42);
+
+  save("import_serve.ngql",
+    "insert edge serve(start_year, end_year) values \"player100\"->\"team204\":(1997, 2016);\n"
+    "insert edge serve(start_year, end_year) values \"player101\"->\"team204\"@0:(1999, 2018);\n");
+  engine.addMap("serve", KeyType::Uninitialize);
+  GImporter serves(&engine, "serve");
+  CHECK(serves.load("import_serve.ngql") == ECode_Success);
+  CHECK(serves.rows() == 2);
+  CHECK(engine.getKeyType("serve") == KeyType::Edge);
+  gql::edge_id eid = gql::make_edge_id(true, std::string("player101"), std::string("team204"));
+  std::string edge = gql::to_string(eid);
+  gql::release_edge_id(eid);
+  CHECK(row("serve", edge)["start_year"] == 1999);
+}
+
+TEST_CASE("binary snapshot") {
+  GStorageEngine engine;
+  StoreOption opt;
+  opt.compress = 1;
+  opt.mode = ReadWriteOption::read_write;
+  CHECK(engine.open("storage.db", opt) == ECode_Success);
+  const std::string group("snapshot_movie");
+  const std::string index = group + ":year";
+  engine.addMap(group, KeyType::Integer);
+  engine.addIndex(index);
+  GIndexWriter writer(&engine, group);
+  for (uint64_t idx = 1; idx <= 100; ++idx) {
+    nlohmann::json row = { {"year", 2000 + idx % 3} };
+    engine.write(group, idx, row);
+    writer.upset(idx, row);
+  }
+  GSnapshot snapshot(&engine);
+  CHECK(snapshot.dump("storage.snap") == ECode_Success);
+  CHECK(snapshot.rows() >= 103);
+
+  GStorageEngine restored;
+  CHECK(restored.open("restored.db", opt) == ECode_Success);
+  restored.addMap("snapshot_old", KeyType::Byte);
+  restored.write("snapshot_old", std::string("old"), nlohmann::json({ {"year", 1999} }));
+  GSnapshot loader(&restored);
+  CHECK(loader.restore("storage.snap") == ECode_Success);
+  CHECK(loader.rows() == snapshot.rows());
+  CHECK(!restored.isMapExist("snapshot_old"));
+  CHECK(restored.count(group) == 100);
+  // posting lists are restored, so index is ready without building
+  CHECK(restored.isIndexReady(index));
+  double year = 2001;
+  std::string posting;
+  CHECK(restored.read(index, gql::to_ordered_key(year), posting) == ECode_Success);
+  CHECK(posting.size() == 34 * sizeof(uint64_t));
+
+  // a broken snapshot is not restored
+  {
+    std::fstream fs("storage.snap", std::ios::in | std::ios::out | std::ios::binary);
+    fs.seekg(0, std::ios::end);
+    std::streamoff middle = fs.tellg() / 2;
+    char c = 0;
+    fs.seekg(middle);
+    fs.read(&c, 1);
+    c = ~c;
+    fs.seekp(middle);
+    fs.write(&c, 1);
+  }
+  CHECK(loader.restore("storage.snap") == ECode_DISK_Checksum_Fail);
+  CHECK(restored.count(group) == 100);
+}
+
+TEST_CASE("online backup") {
+  GStorageEngine engine;
+  StoreOption opt;
+  opt.compress = 1;
+  opt.mode = ReadWriteOption::read_write;
+  CHECK(engine.open("storage.db", opt) == ECode_Success);
+  const std::string group("backup_vertex");
+  engine.addMap(group, KeyType::Integer);
+  for (uint64_t idx = 1; idx <= 1000; ++idx) {
+    nlohmann::json row = { {"id", idx} };
+    engine.write(group, idx, row);
+  }
+  for (uint64_t idx = 1; idx <= 900; ++idx) {
+    engine.del(group, idx);
+  }
+  std::remove("backup.db");
+  CHECK(engine.backup("backup.db", true) == ECode_Success);
+  // uncommitted rows are written after copy
+  nlohmann::json row = { {"id", 1001} };
+  engine.write(group, (uint64_t)1001, row);
+  CHECK(engine.count(group) == 101);
+
+  GStorageEngine backup;
+  CHECK(backup.open("backup.db", opt) == ECode_Success);
+  CHECK(backup.count(group) == 100);
+  std::string value;
+  CHECK(backup.read(group, (uint64_t)1000, value) == ECode_Success);
+  CHECK(backup.read(group, (uint64_t)1, value) == ECode_DATUM_Not_Exist);
+  // file of backup exists, so it can't be copied again
+  CHECK(engine.backup("backup.db", false) != ECode_Success);
+  // copy without compacting holds the writer lock of session
+  std::remove("backup_full.db");
+  CHECK(engine.backup("backup_full.db", false) == ECode_Success);
+  row["id"] = 1002;
+  engine.write(group, (uint64_t)1002, row);
+  CHECK(engine.count(group) == 102);
+  GStorageEngine full;
+  CHECK(full.open("backup_full.db", opt) == ECode_Success);
+  CHECK(full.count(group) == 101);
+  CHECK(full.read(group, (uint64_t)1001, value) == ECode_Success);
+}
+
+TEST_CASE("pinned transaction") {
+  GStorageEngine engine;
+  StoreOption opt;
+  opt.compress = 1;
+  opt.mode = ReadWriteOption::read_write;
+  CHECK(engine.open("storage.db", opt) == ECode_Success);
+  const std::string group("pinned_vertex");
+  engine.addMap(group, KeyType::Integer);
+  for (uint64_t idx = 1; idx <= 10; ++idx) {
+    nlohmann::json row = { {"id", idx} };
+    engine.write(group, idx, row);
+  }
+  CHECK(engine.commitTrans() == ECode_Success);
+  // a suspended statement scans with cursor of session transaction
+  GStorageEngine::cursor cursor = engine.getMapCursor(group);
+  auto data = cursor.to_first(false);
+  engine.pinTrans();
+  nlohmann::json row = { {"id", 11} };
+  engine.write(group, (uint64_t)11, row);
+  CHECK(engine.commitTrans() == ECode_Success);
+  std::remove("pinned.db");
+  CHECK(engine.backup("pinned.db", true) == ECode_TRANSTION_Busy);
+  GSnapshot snapshot(&engine);
+  CHECK(snapshot.dump("pinned.snap") == ECode_TRANSTION_Busy);
+  size_t rows = 0;
+  for (; data; data = cursor.to_next(false)) ++rows;
+  CHECK(rows == 11);
+  engine.unpinTrans();
+  CHECK(engine.backup("pinned.db", true) == ECode_Success);
+  GStorageEngine backup;
+  CHECK(backup.open("pinned.db", opt) == ECode_Success);
+  CHECK(backup.count(group) == 11);
+}
@@ -0,0 +1,36 @@
+#include "../include/gqlite.h"
+#include <stdio.h>
+#include <string>
+
+void usage() {
+  printf("compact graph file offline, so that free pages are released. Usage:\n");
+  printf("\tgqlcompact graph [compacted_graph]\n");
+  printf("If compacted_graph is not set, graph is replaced.\n");
+}
+
+int main(int argc, char** argv) {
+  if (argc != 2 && argc != 3) {
+    usage();
+    return -1;
+  }
+  std::string graph = argv[1];
+  std::string compacted = (argc == 3) ? argv[2] : graph + ".compact";
+  gqlite* pHandle = 0;
+  gqlite_open(&pHandle, nullptr);
+  char* ptr = nullptr;
+  std::string open = "{create: '" + graph + "'};";
+  int ret = gqlite_exec(pHandle, open.c_str(), nullptr, nullptr, &ptr);
+  gqlite_free(ptr);
+  if (ret == ECode_Success) ret = gqlite_backup(pHandle, compacted.c_str(), true);
+  if (ret != ECode_Success) {
+    ptr = gqlite_error(pHandle, ret);
+    printf("compact fail: %s\n", ptr);
+    gqlite_free(ptr);
+  }
+  gqlite_close(pHandle);
+  if (ret == ECode_Success && argc == 2 && rename(compacted.c_str(), graph.c_str()) != 0) {
+    perror("compact");
+    return ECode_DISK_WRITE_FAIL;
+  }
+  return ret;
+}
@@ -1,22 +1,36 @@
 #include "../include/gqlite.h"
 #include <stdio.h>
+#include <string.h>
+#include <string>
 
 void usage() {
-  printf("dump graph to gremlin. Usage:\n");
-  printf("\tgqldump db_file\n");
+  printf("dump graph to a binary snapshot, or restore graph from it. Usage:\n");
+  printf("\tgqldump graph snapshot_file\n");
+  printf("\tgqldump -r snapshot_file graph\n");
 }
 
 int main(int argc, char** argv) {
-  // if (argc < 2) return -1;
+  bool restore = (argc == 4 && strcmp(argv[1], "-r") == 0);
+  if (argc != 3 && !restore) {
+    usage();
+    return -1;
+  }
+  const char* graph = restore ? argv[3] : argv[1];
+  const char* snapshot = argv[2];
   gqlite* pHandle = 0;
-  gqlite_open(&pHandle, "gql_db");
-  printf("not implement\n");
-  gqlite_statement* statement = 0;
-  gqlite_create(pHandle, "{dump: 'ga'}", &statement);
-  printf("33333\n");
-  gqlite_execute(pHandle, statement);
-  printf("4444444\n");
+  gqlite_open(&pHandle, nullptr);
+  char* ptr = nullptr;
+  std::string open = std::string("{create: '") + graph + "'};";
+  int ret = gqlite_exec(pHandle, open.c_str(), nullptr, nullptr, &ptr);
+  gqlite_free(ptr);
+  if (ret == ECode_Success) {
+    ret = restore ? gqlite_restore(pHandle, snapshot) : gqlite_snapshot(pHandle, snapshot);
+  }
+  if (ret != ECode_Success) {
+    ptr = gqlite_error(pHandle, ret);
+    printf("%s fail: %s\n", restore ? "restore" : "dump", ptr);
+    gqlite_free(ptr);
+  }
   gqlite_close(pHandle);
-  printf("55555s\n");
-  return 0;
+  return ret;
 }